@@ -0,0 +1,104 @@
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bvh.h"
+
+template<typename T>
+void parseNumber(const char* argument, T &value) {
+    std::from_chars(argument, argument + strlen(argument), value);
+}
+
+// SPHERES IN A CUBE THAT GROWS WITH THE SPHERE AMOUNT, SO THE DENSITY STAYS THE SAME FOR EVERY SIZE
+std::vector<Sphere> generateSpheres(uint32_t sphereAmount, float &halfExtent, std::mt19937 &engine) {
+    halfExtent = std::cbrt(float(sphereAmount));
+    std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+    std::uniform_real_distribution<float> radius(0.1f, 0.4f);
+
+    std::vector<Sphere> spheres(sphereAmount);
+    for (Sphere &sphere: spheres) {
+        sphere.geometry = glm::vec4(position(engine), position(engine), position(engine), radius(engine));
+    }
+
+    return spheres;
+}
+
+int main(int argc, const char** argv) {
+    uint32_t minSphereAmount = 1000;
+    uint32_t maxSphereAmount = 10000000;
+    uint32_t rayAmount = 1000000;
+    uint32_t threadCount = 0;
+
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--min-spheres") == 0) {
+            parseNumber(argv[++i], minSphereAmount);
+        } else if (strcmp(argv[i], "--max-spheres") == 0) {
+            parseNumber(argv[++i], maxSphereAmount);
+        } else if (strcmp(argv[i], "--rays") == 0) {
+            parseNumber(argv[++i], rayAmount);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            parseNumber(argv[++i], threadCount);
+        }
+    }
+
+    ThreadPool threadPool(threadCount);
+    std::mt19937 engine(42);
+
+    std::cout << "BVH benchmark: " << rayAmount << " rays per size, " << threadPool.getThreadCount() << " threads, "
+        << SPHERE_PACKET_WIDTH << " spheres per packet" << std::endl << std::endl;
+    std::cout << std::setw(12) << "spheres" << std::setw(14) << "build ms" << std::setw(12) << "nodes"
+        << std::setw(14) << "hit rate" << std::setw(14) << "Mrays/s" << std::endl;
+
+    for (uint64_t sphereAmount = minSphereAmount; sphereAmount <= maxSphereAmount; sphereAmount *= 10) {
+        float halfExtent;
+        const std::vector<Sphere> spheres = generateSpheres(static_cast<uint32_t>(sphereAmount), halfExtent, engine);
+
+        // BUILD
+        const auto buildBeginTime = std::chrono::steady_clock::now();
+        const Bvh bvh(spheres.data(), static_cast<uint32_t>(spheres.size()), threadPool);
+        const double buildMilliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - buildBeginTime).count();
+
+        // RAYS: INCOHERENT, FROM RANDOM POINTS INSIDE THE CUBE IN RANDOM DIRECTIONS
+        std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+        std::vector<glm::vec3> origins(rayAmount), directions(rayAmount);
+        for (uint32_t i = 0; i < rayAmount; i++) {
+            origins[i] = glm::vec3(position(engine), position(engine), position(engine));
+            directions[i] = glm::normalize(glm::vec3(direction(engine), direction(engine), direction(engine)));
+        }
+
+        const uint32_t chunkCount = threadPool.getThreadCount() * 16;
+        std::vector<uint32_t> chunkHits(chunkCount, 0);
+
+        const auto traceBeginTime = std::chrono::steady_clock::now();
+
+        threadPool.parallelFor(chunkCount, [&](uint32_t chunk) {
+            const uint32_t begin = static_cast<uint64_t>(chunk) * rayAmount / chunkCount;
+            const uint32_t end = static_cast<uint64_t>(chunk + 1) * rayAmount / chunkCount;
+
+            for (uint32_t i = begin; i < end; i++) {
+                SphereHit hit = {.t = 10000.0f, .sphereIndex = 0};
+                chunkHits[chunk] += bvh.intersect(origins[i], directions[i], 0.001f, hit) ? 1 : 0;
+            }
+        });
+
+        const double traceSeconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - traceBeginTime).count();
+
+        uint64_t hits = 0;
+        for (uint32_t chunkHit: chunkHits) {
+            hits += chunkHit;
+        }
+
+        std::cout << std::setw(12) << sphereAmount << std::setw(14) << std::fixed << std::setprecision(2)
+            << buildMilliseconds << std::setw(12) << bvh.getNodes().size() << std::setw(13)
+            << (100.0 * double(hits) / double(rayAmount)) << "%" << std::setw(14)
+            << (double(rayAmount) / traceSeconds / 1e6) << std::endl;
+    }
+}
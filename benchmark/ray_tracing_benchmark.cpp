@@ -0,0 +1,1037 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "renderer_factory.h"
+#include "profile_writer.h"
+
+template<typename T>
+void parseNumber(const char* argument, T &value) {
+    std::from_chars(argument, argument + strlen(argument), value);
+}
+
+// COMMA SEPARATED LIST, e.g. "104,488"
+std::vector<uint32_t> parseNumberList(const std::string &argument) {
+    std::vector<uint32_t> values;
+    std::stringstream stream(argument);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        uint32_t value = 0;
+        parseNumber(item.c_str(), value);
+        values.push_back(value);
+    }
+
+    return values;
+}
+
+std::vector<SamplerType> parseSamplerList(const std::string &argument) {
+    std::vector<SamplerType> samplers;
+    std::stringstream stream(argument);
+    std::string name;
+
+    while (std::getline(stream, name, ',')) {
+        const std::optional<SamplerType> sampler = parseSamplerType(name);
+        if (!sampler) {
+            throw std::runtime_error("[Error] Unknown sampler '" + name + "' (supported: random, sobol, blue-noise)!");
+        }
+
+        samplers.push_back(*sampler);
+    }
+
+    return samplers;
+}
+
+// COMMA SEPARATED LIST, e.g. "fp64,fp32,kahan,split"
+std::vector<AccumulationPrecision> parseAccumulationList(const std::string &argument) {
+    std::vector<AccumulationPrecision> accumulationPrecisions;
+    std::stringstream stream(argument);
+    std::string name;
+
+    while (std::getline(stream, name, ',')) {
+        const std::optional<AccumulationPrecision> accumulationPrecision = parseAccumulationPrecision(name);
+        if (!accumulationPrecision) {
+            throw std::runtime_error("[Error] Unknown accumulation '" + name +
+                                     "' (supported: fp64, fp32, kahan, split)!");
+        }
+
+        accumulationPrecisions.push_back(*accumulationPrecision);
+    }
+
+    return accumulationPrecisions;
+}
+
+// COMMA SEPARATED LIST, e.g. "rgba32f,rgb32f"
+std::vector<AccumulationFormat> parseAccumulationFormatList(const std::string &argument) {
+    std::vector<AccumulationFormat> accumulationFormats;
+    std::stringstream stream(argument);
+    std::string name;
+
+    while (std::getline(stream, name, ',')) {
+        const std::optional<AccumulationFormat> accumulationFormat = parseAccumulationFormat(name);
+        if (!accumulationFormat) {
+            throw std::runtime_error("[Error] Unknown accumulation format '" + name +
+                                     "' (supported: rgba32f, rgb32f)!");
+        }
+
+        accumulationFormats.push_back(*accumulationFormat);
+    }
+
+    return accumulationFormats;
+}
+
+struct Resolution {
+    uint32_t width, height;
+};
+
+// COMMA SEPARATED LIST OF <WIDTH>x<HEIGHT>, e.g. "1280x720,1920x1080"
+std::vector<Resolution> parseResolutionList(const std::string &argument) {
+    std::vector<Resolution> resolutions;
+    std::stringstream stream(argument);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        const size_t separator = item.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("[Error] Invalid resolution '" + item + "' (expected <width>x<height>)!");
+        }
+
+        Resolution resolution = {.width = 0, .height = 0};
+        parseNumber(item.substr(0, separator).c_str(), resolution.width);
+        parseNumber(item.substr(separator + 1).c_str(), resolution.height);
+        resolutions.push_back(resolution);
+    }
+
+    return resolutions;
+}
+
+uint64_t getPeakResidentMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+struct TimingStatistics {
+    double median, p90, p99, min, max, mean;
+};
+
+// NEAREST RANK PERCENTILES
+TimingStatistics calculateStatistics(std::vector<double> milliseconds) {
+    if (milliseconds.empty()) {
+        return {};
+    }
+
+    std::sort(milliseconds.begin(), milliseconds.end());
+
+    const auto percentile = [&milliseconds](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * double(milliseconds.size())));
+        return milliseconds[std::clamp(rank, size_t(1), milliseconds.size()) - 1];
+    };
+
+    double sum = 0.0;
+    for (double value: milliseconds) {
+        sum += value;
+    }
+
+    return {
+            .median = percentile(0.5),
+            .p90 = percentile(0.9),
+            .p99 = percentile(0.99),
+            .min = milliseconds.front(),
+            .max = milliseconds.back(),
+            .mean = sum / double(milliseconds.size())
+    };
+}
+
+struct BenchmarkResult {
+    RendererInfo rendererInfo;
+    uint32_t sphereAmount;
+    uint32_t samplesPerRenderCall;
+    uint32_t maxDepth;
+    uint32_t rouletteDepth;
+    SamplerType sampler;
+    AccumulationPrecision accumulationPrecision;
+    AccumulationFormat accumulationFormat;
+    uint32_t repeats;
+
+    double sceneMilliseconds;
+    double startupMilliseconds;
+
+    // WALL TIME OF render() + finish() PER RENDER CALL & THE DEVICE TIME REPORTED BY THE RENDERER
+    TimingStatistics wallMilliseconds;
+    TimingStatistics deviceMilliseconds;
+
+    // WALL TIME OF updateScene() FOR MOVED & FOR RECOLORED SPHERES, ZERO WITHOUT --update-spheres
+    uint32_t updateSphereAmount;
+    TimingStatistics updateMilliseconds;
+    TimingStatistics materialUpdateMilliseconds;
+
+    uint64_t samplesPerRenderCallTotal;
+    uint64_t raysPerRenderCall;
+    uint64_t peakResidentMemory;
+
+    // PER-PIXEL VARIANCE OF A RENDER CALL & TIMES THE MEDIAN WALL TIME, WHICH THE TIME TO REACH A GIVEN NOISE LEVEL IS
+    // PROPORTIONAL TO. ZERO WITHOUT --noise-calls
+    double noiseVariance;
+    double noiseTimeProduct;
+
+    // WALL TIME UNTIL ADAPTIVE SAMPLING HAS NO PIXEL ABOVE THE THRESHOLD LEFT, STARTING FROM A NEW RENDERER, & THE
+    // SAMPLES PER PIXEL IT SPENT ON AVERAGE. ZERO WITHOUT --adaptive-threshold
+    float adaptiveThreshold;
+    double timeToQualityMilliseconds;
+    double qualitySamplesPerPixel;
+    bool qualityConverged;
+
+    // ROOT MEAN SQUARED ERROR OF THE MEAN PIXEL COLORS AGAINST THE REFERENCE AFTER RENDERING FOR equalTimeMilliseconds,
+    // STARTING FROM A NEW RENDERER, & THE SAMPLES PER PIXEL IT TOOK. ZERO WITHOUT --equal-time-ms
+    double equalTimeMilliseconds;
+    double equalTimeSamplesPerPixel;
+    double equalTimeRMSE;
+
+    // LARGEST RELATIVE ERROR & RMSE OF THE MEAN PIXEL COLORS AFTER accumulationSamples SAMPLES PER PIXEL AGAINST THE
+    // SAME SAMPLES ACCUMULATED IN FP64, STARTING FROM NEW RENDERERS. ZERO WITHOUT --accumulation-samples
+    uint32_t accumulationSamples;
+    double accumulationMaxRelativeError;
+    double accumulationRMSE;
+    bool accumulationWithinTolerance;
+};
+
+double getPathLength(const BenchmarkResult &result) {
+    return result.samplesPerRenderCallTotal > 0
+           ? double(result.raysPerRenderCall) / double(result.samplesPerRenderCallTotal)
+           : 0.0;
+}
+
+// EVERY READBACK HOLDS THE SUMMED COLORS OF ALL RENDER CALLS SO FAR, THE DIFFERENCE OF TWO IS ONE RENDER CALL. THE
+// VARIANCE OF THESE PER-CALL ESTIMATES IS AVERAGED OVER ALL PIXELS & COLOR CHANNELS
+struct NoiseAccumulator {
+    std::vector<float> previousSummedPixelColor;
+    std::vector<double> sum, squaredSum;
+    uint32_t estimateCount = 0;
+    size_t channelCount = 0;
+
+    void add(const RenderOutput &readback) {
+        const size_t pixelCount = size_t(readback.width) * readback.height;
+        channelCount = pixelCount > 0 ? readback.summedPixelColor.size() / pixelCount : 0;
+
+        if (!previousSummedPixelColor.empty()) {
+            sum.resize(readback.summedPixelColor.size());
+            squaredSum.resize(readback.summedPixelColor.size());
+
+            for (size_t value = 0; value < readback.summedPixelColor.size(); value++) {
+                const double estimate = double(readback.summedPixelColor[value]) -
+                                        double(previousSummedPixelColor[value]);
+                sum[value] += estimate;
+                squaredSum[value] += estimate * estimate;
+            }
+
+            estimateCount++;
+        }
+
+        previousSummedPixelColor = readback.summedPixelColor;
+    }
+
+    [[nodiscard]] double getVariance() const {
+        if (estimateCount < 2 || channelCount == 0) {
+            return 0.0;
+        }
+
+        double varianceSum = 0.0;
+        size_t valueCount = 0;
+
+        // THE ALPHA CHANNEL COUNTS THE SAMPLES
+        for (size_t value = 0; value < sum.size(); value++) {
+            if (value % channelCount < 3) {
+                varianceSum += (squaredSum[value] - sum[value] * sum[value] / estimateCount) / (estimateCount - 1.0);
+                valueCount++;
+            }
+        }
+
+        return valueCount > 0 ? varianceSum / double(valueCount) : 0.0;
+    }
+};
+
+// RGB MEAN OF EVERY PIXEL, THE ALPHA CHANNEL COUNTS ITS SAMPLES
+std::vector<float> getMeanPixelColors(const RenderOutput &output) {
+    const size_t pixelCount = size_t(output.width) * output.height;
+    std::vector<float> meanPixelColors(pixelCount * 3, 0.0f);
+
+    for (size_t pixel = 0; pixel < pixelCount; pixel++) {
+        const float sampleCount = output.summedPixelColor[pixel * 4 + 3];
+
+        for (size_t channel = 0; channel < 3 && sampleCount > 0.0f; channel++) {
+            meanPixelColors[pixel * 3 + channel] = output.summedPixelColor[pixel * 4 + channel] / sampleCount;
+        }
+    }
+
+    return meanPixelColors;
+}
+
+// RGB MEAN OF EVERY PIXEL FROM THE DOUBLE TOTAL OF FP64 ACCUMULATION, NOT ROUNDED TO FLOAT AT ANY POINT
+std::vector<double> getFp64MeanPixelColors(const RenderOutput &output) {
+    const size_t pixelCount = size_t(output.width) * output.height;
+    std::vector<double> meanPixelColors(pixelCount * 3, 0.0);
+
+    for (size_t pixel = 0; pixel < pixelCount; pixel++) {
+        const double sampleCount = output.summedPixelColor[pixel * 4 + 3];
+
+        for (size_t channel = 0; channel < 3 && sampleCount > 0.0; channel++) {
+            meanPixelColors[pixel * 3 + channel] = output.summedPixelColorFp64[pixel * 3 + channel] / sampleCount;
+        }
+    }
+
+    return meanPixelColors;
+}
+
+template<typename Reference>
+double calculateRMSE(const std::vector<float> &meanPixelColors, const std::vector<Reference> &reference) {
+    double squaredErrorSum = 0.0;
+    for (size_t value = 0; value < meanPixelColors.size(); value++) {
+        const double error = double(meanPixelColors[value]) - double(reference[value]);
+        squaredErrorSum += error * error;
+    }
+
+    return meanPixelColors.empty() ? 0.0 : std::sqrt(squaredErrorSum / double(meanPixelColors.size()));
+}
+
+// RELATIVE TO THE REFERENCE VALUE, BUT AT LEAST TO THE FLOOR, SO NEARLY BLACK PIXELS DO NOT DOMINATE
+const double RELATIVE_ERROR_FLOOR = 1e-3;
+
+double calculateMaxRelativeError(const std::vector<float> &meanPixelColors, const std::vector<double> &reference) {
+    double maxRelativeError = 0.0;
+    for (size_t value = 0; value < meanPixelColors.size(); value++) {
+        const double error = std::abs(double(meanPixelColors[value]) - reference[value]);
+        maxRelativeError = std::max(maxRelativeError,
+                                    error / std::max(std::abs(reference[value]), RELATIVE_ERROR_FLOOR));
+    }
+
+    return maxRelativeError;
+}
+
+// TRAFFIC OF THE ACCUMULATION & PREVIEW IMAGES AT THE MEDIAN WALL TIME, EVERY PIXEL IS SAMPLED IN EVERY RENDER CALL
+double accumulationGBPerSecond(const BenchmarkResult &result) {
+    const double seconds = result.wallMilliseconds.median / 1000.0;
+    const double pixels = double(result.rendererInfo.imageWidth) * result.rendererInfo.imageHeight;
+
+    return seconds > 0.0 ? pixels * result.rendererInfo.accumulationBytesPerPixel / seconds / 1e9 : 0.0;
+}
+
+double sceneUploadGBPerSecond(const RendererInfo &rendererInfo) {
+    return rendererInfo.sceneUploadMilliseconds > 0.0
+           ? double(rendererInfo.sceneUploadBytes) / rendererInfo.sceneUploadMilliseconds / 1e6
+           : 0.0;
+}
+
+// THE REFERENCE OF THE EQUAL TIME RMSE IS RENDERED WITH THE RANDOM SAMPLER FROM RENDER CALL NUMBERS NO MEASURED RUN
+// REACHES, SO ITS LCG STREAMS ARE INDEPENDENT OF THEIRS & IT SHARES NO SOBOL POINTS WITH THEM
+const uint32_t REFERENCE_SAMPLES_PER_RENDER_CALL = 16;
+const uint32_t REFERENCE_FIRST_RENDER_CALL = 1u << 24;
+
+std::vector<float> renderReference(const std::string &backend, VulkanSettings settings,
+                                   CpuRendererSettings cpuSettings, const Scene &scene, uint32_t referenceSamples) {
+    settings.sampler = SAMPLER_RANDOM;
+    settings.countRays = false;
+    cpuSettings.sampler = SAMPLER_RANDOM;
+
+    std::unique_ptr<Renderer> renderer = createRenderer(backend, settings, cpuSettings, scene);
+
+    const uint32_t renderCalls = std::max(referenceSamples / REFERENCE_SAMPLES_PER_RENDER_CALL, 1u);
+    for (uint32_t i = 0; i < renderCalls; i++) {
+        renderer->render(
+                {.number = REFERENCE_FIRST_RENDER_CALL + i, .samplesPerRenderCall = REFERENCE_SAMPLES_PER_RENDER_CALL});
+    }
+
+    renderer->finish();
+    renderer->requestReadback();
+    return getMeanPixelColors(renderer->waitForReadback());
+}
+
+// A NEW RENDERER RENDERS samples SAMPLES PER PIXEL FROM RENDER CALL 1 ON, SO EQUAL SETTINGS DRAW THE SAME SAMPLES
+// WHATEVER THE ACCUMULATION PRECISION
+RenderOutput renderAccumulation(const std::string &backend, VulkanSettings settings, CpuRendererSettings cpuSettings,
+                                const Scene &scene, AccumulationPrecision accumulationPrecision, uint32_t samples,
+                                uint32_t samplesPerRenderCall) {
+    settings.countRays = false;
+    settings.accumulationPrecision = accumulationPrecision;
+    cpuSettings.accumulationPrecision = accumulationPrecision;
+
+    std::unique_ptr<Renderer> renderer = createRenderer(backend, settings, cpuSettings, scene);
+
+    const uint32_t renderCalls = std::max(samples / samplesPerRenderCall, 1u);
+    for (uint32_t number = 1; number <= renderCalls; number++) {
+        renderer->render({.number = number, .samplesPerRenderCall = samplesPerRenderCall});
+    }
+
+    renderer->finish();
+    renderer->requestReadback();
+    return renderer->waitForReadback();
+}
+
+std::string formatJSON(const BenchmarkResult &result) {
+    const auto statistics = [](const TimingStatistics &timing) {
+        std::ostringstream object;
+        object << std::fixed << std::setprecision(4)
+               << "{\"median\":" << timing.median << ",\"p90\":" << timing.p90 << ",\"p99\":" << timing.p99
+               << ",\"min\":" << timing.min << ",\"max\":" << timing.max << ",\"mean\":" << timing.mean << "}";
+        return object.str();
+    };
+
+    const double seconds = result.wallMilliseconds.median / 1000.0;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(4)
+         << "{\"backend\":\"" << ProfileWriter::escapeJSON(result.rendererInfo.backend) << "\""
+         << ",\"device\":\"" << ProfileWriter::escapeJSON(result.rendererInfo.deviceName) << "\""
+         << ",\"driver\":\"" << ProfileWriter::escapeJSON(result.rendererInfo.driverVersion) << "\""
+         << ",\"spheres\":" << result.sphereAmount
+         << ",\"width\":" << result.rendererInfo.imageWidth
+         << ",\"height\":" << result.rendererInfo.imageHeight
+         << ",\"samplesPerRenderCall\":" << result.samplesPerRenderCall
+         << ",\"maxDepth\":" << result.maxDepth
+         << ",\"rouletteDepth\":" << result.rouletteDepth
+         << ",\"sampler\":\"" << getSamplerTypeName(result.sampler) << "\""
+         << ",\"accumulation\":\"" << getAccumulationPrecisionName(result.accumulationPrecision) << "\""
+         << ",\"accumulationFormat\":\"" << getAccumulationFormatName(result.accumulationFormat) << "\""
+         << ",\"repeats\":" << result.repeats
+         << ",\"wallMilliseconds\":" << statistics(result.wallMilliseconds)
+         << ",\"deviceMilliseconds\":" << statistics(result.deviceMilliseconds)
+         << ",\"updateSpheres\":" << result.updateSphereAmount
+         << ",\"updateMilliseconds\":" << statistics(result.updateMilliseconds)
+         << ",\"materialUpdateMilliseconds\":" << statistics(result.materialUpdateMilliseconds)
+         << ",\"samplesPerSecond\":" << (seconds > 0.0 ? double(result.samplesPerRenderCallTotal) / seconds : 0.0)
+         << ",\"megaRaysPerSecond\":" << (seconds > 0.0 ? double(result.raysPerRenderCall) / seconds / 1e6 : 0.0)
+         << ",\"pathLength\":" << getPathLength(result)
+         << std::scientific << ",\"noiseVariance\":" << result.noiseVariance
+         << ",\"noiseTimeProduct\":" << result.noiseTimeProduct << std::fixed
+         << ",\"adaptiveThreshold\":" << result.adaptiveThreshold
+         << ",\"timeToQualityMilliseconds\":" << result.timeToQualityMilliseconds
+         << ",\"qualitySamplesPerPixel\":" << result.qualitySamplesPerPixel
+         << ",\"qualityConverged\":" << (result.qualityConverged ? "true" : "false")
+         << ",\"equalTimeMilliseconds\":" << result.equalTimeMilliseconds
+         << ",\"equalTimeSamplesPerPixel\":" << result.equalTimeSamplesPerPixel
+         << std::scientific << ",\"equalTimeRMSE\":" << result.equalTimeRMSE << std::fixed
+         << ",\"accumulationSamples\":" << result.accumulationSamples
+         << std::scientific << ",\"accumulationMaxRelativeError\":" << result.accumulationMaxRelativeError
+         << ",\"accumulationRMSE\":" << result.accumulationRMSE << std::fixed
+         << ",\"accumulationWithinTolerance\":" << (result.accumulationWithinTolerance ? "true" : "false")
+         << ",\"sceneMilliseconds\":" << result.sceneMilliseconds
+         << ",\"startupMilliseconds\":" << result.startupMilliseconds
+         << ",\"startupStages\":{";
+
+    for (size_t i = 0; i < result.rendererInfo.startupTimings.size(); i++) {
+        const StartupStageTiming &timing = result.rendererInfo.startupTimings[i];
+        line << (i > 0 ? "," : "") << "\"" << ProfileWriter::escapeJSON(timing.stage) << "\":" << timing.milliseconds;
+    }
+
+    line << "},\"allocatedMemory\":" << result.rendererInfo.allocatedMemory
+         << ",\"reservedMemory\":" << result.rendererInfo.reservedMemory
+         << ",\"memoryBlocks\":" << result.rendererInfo.memoryBlockCount
+         << ",\"dedicatedAllocations\":" << result.rendererInfo.dedicatedAllocationCount
+         << ",\"memoryFragmentation\":" << result.rendererInfo.memoryFragmentation
+         << ",\"deviceMemoryUsage\":" << result.rendererInfo.deviceMemoryUsage
+         << ",\"deviceMemoryBudget\":" << result.rendererInfo.deviceMemoryBudget
+         << ",\"sceneUploadBytes\":" << result.rendererInfo.sceneUploadBytes
+         << ",\"sceneUploadMilliseconds\":" << result.rendererInfo.sceneUploadMilliseconds
+         << ",\"sceneUploadGBPerSecond\":" << sceneUploadGBPerSecond(result.rendererInfo)
+         << ",\"accelerationStructureMemory\":" << result.rendererInfo.accelerationStructureMemory
+         << ",\"uncompactedAccelerationStructureMemory\":"
+         << result.rendererInfo.uncompactedAccelerationStructureMemory
+         << ",\"bottomAccelerationStructures\":" << result.rendererInfo.bottomAccelerationStructureCount
+         << ",\"instances\":" << result.rendererInfo.instanceCount
+         << ",\"hitGroups\":" << result.rendererInfo.hitGroupCount
+         << ",\"accumulationMemory\":" << result.rendererInfo.accumulationMemory
+         << ",\"accumulationBytesPerPixel\":" << result.rendererInfo.accumulationBytesPerPixel
+         << ",\"accumulationGBPerSecond\":" << accumulationGBPerSecond(result)
+         << ",\"peakResidentMemory\":" << result.peakResidentMemory
+         << "}";
+
+    return line.str();
+}
+
+const char* CSV_HEADER = "backend,device,spheres,width,height,samples_per_render_call,max_depth,roulette_depth,"
+                         "sampler,accumulation,accumulation_format,repeats,wall_median_ms,wall_p90_ms,wall_p99_ms,wall_min_ms,wall_max_ms,"
+                         "device_median_ms,device_p90_ms,device_p99_ms,samples_per_second,mrays_per_second,"
+                         "path_length,noise_variance,noise_time_product,adaptive_threshold,time_to_quality_ms,"
+                         "quality_samples_per_pixel,quality_converged,equal_time_ms,equal_time_samples_per_pixel,"
+                         "equal_time_rmse,accumulation_samples,accumulation_max_relative_error,accumulation_rmse,"
+                         "accumulation_within_tolerance,"
+                         "scene_ms,startup_ms,allocated_memory,reserved_memory,memory_blocks,dedicated_allocations,"
+                         "memory_fragmentation,device_memory_usage,device_memory_budget,scene_upload_bytes,"
+                         "scene_upload_ms,scene_upload_gb_per_second,acceleration_structure_memory,"
+                         "uncompacted_acceleration_structure_memory,bottom_acceleration_structures,instances,hit_groups,"
+                         "accumulation_memory,accumulation_bytes_per_pixel,accumulation_gb_per_second,"
+                         "update_spheres,update_median_ms,update_p90_ms,material_update_median_ms,"
+                         "material_update_p90_ms,peak_resident_memory";
+
+std::string formatCSV(const BenchmarkResult &result) {
+    const double seconds = result.wallMilliseconds.median / 1000.0;
+
+    // DEVICE NAMES MAY CONTAIN COMMAS
+    std::string deviceName = result.rendererInfo.deviceName;
+    std::replace(deviceName.begin(), deviceName.end(), ',', ' ');
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(4)
+         << result.rendererInfo.backend << "," << deviceName << "," << result.sphereAmount << ","
+         << result.rendererInfo.imageWidth << "," << result.rendererInfo.imageHeight << ","
+         << result.samplesPerRenderCall << "," << result.maxDepth << "," << result.rouletteDepth << ","
+         << getSamplerTypeName(result.sampler) << ","
+         << getAccumulationPrecisionName(result.accumulationPrecision) << ","
+         << getAccumulationFormatName(result.accumulationFormat) << "," << result.repeats << ","
+         << result.wallMilliseconds.median << "," << result.wallMilliseconds.p90 << ","
+         << result.wallMilliseconds.p99 << "," << result.wallMilliseconds.min << ","
+         << result.wallMilliseconds.max << "," << result.deviceMilliseconds.median << ","
+         << result.deviceMilliseconds.p90 << "," << result.deviceMilliseconds.p99 << ","
+         << (seconds > 0.0 ? double(result.samplesPerRenderCallTotal) / seconds : 0.0) << ","
+         << (seconds > 0.0 ? double(result.raysPerRenderCall) / seconds / 1e6 : 0.0) << ","
+         << getPathLength(result) << "," << std::scientific << result.noiseVariance << ","
+         << result.noiseTimeProduct << "," << std::fixed << result.adaptiveThreshold << ","
+         << result.timeToQualityMilliseconds << "," << result.qualitySamplesPerPixel << ","
+         << (result.qualityConverged ? 1 : 0) << "," << result.equalTimeMilliseconds << ","
+         << result.equalTimeSamplesPerPixel << "," << std::scientific << result.equalTimeRMSE << std::fixed << ","
+         << result.accumulationSamples << "," << std::scientific << result.accumulationMaxRelativeError << ","
+         << result.accumulationRMSE << std::fixed << "," << (result.accumulationWithinTolerance ? 1 : 0) << ","
+         << result.sceneMilliseconds << "," << result.startupMilliseconds << ","
+         << result.rendererInfo.allocatedMemory << "," << result.rendererInfo.reservedMemory << ","
+         << result.rendererInfo.memoryBlockCount << "," << result.rendererInfo.dedicatedAllocationCount << ","
+         << result.rendererInfo.memoryFragmentation << "," << result.rendererInfo.deviceMemoryUsage << ","
+         << result.rendererInfo.deviceMemoryBudget << "," << result.rendererInfo.sceneUploadBytes << ","
+         << result.rendererInfo.sceneUploadMilliseconds << "," << sceneUploadGBPerSecond(result.rendererInfo) << ","
+         << result.rendererInfo.accelerationStructureMemory << ","
+         << result.rendererInfo.uncompactedAccelerationStructureMemory << ","
+         << result.rendererInfo.bottomAccelerationStructureCount << "," << result.rendererInfo.instanceCount << ","
+         << result.rendererInfo.hitGroupCount << "," << result.rendererInfo.accumulationMemory << ","
+         << result.rendererInfo.accumulationBytesPerPixel << "," << accumulationGBPerSecond(result) << ","
+         << result.updateSphereAmount << "," << result.updateMilliseconds.median << ","
+         << result.updateMilliseconds.p90 << "," << result.materialUpdateMilliseconds.median << ","
+         << result.materialUpdateMilliseconds.p90 << "," << result.peakResidentMemory;
+
+    return line.str();
+}
+
+int main(int argc, const char** argv) {
+    std::string backend = "auto";
+    std::vector<uint32_t> sphereAmounts = {DEFAULT_SPHERE_AMOUNT, 10000, 100000, 1000000};
+    std::vector<Resolution> resolutions = {{.width = 1280, .height = 720}, {.width = 1920, .height = 1080}};
+    std::vector<uint32_t> samplesPerRenderCallList = {1, 10};
+    std::vector<uint32_t> maxDepths = {50};
+    std::vector<uint32_t> rouletteDepths = {0};
+    uint32_t noiseRenderCalls = 0;
+    float adaptiveThreshold = 0.0f;
+    uint32_t qualityMaxSamples = 4096;
+    std::vector<SamplerType> samplers = {SAMPLER_RANDOM};
+    double equalTimeMilliseconds = 0.0;
+    uint32_t referenceSamples = 1024;
+    std::vector<AccumulationPrecision> accumulationPrecisions = {ACCUMULATION_FP32};
+    uint32_t accumulationSamples = 0;
+    double accumulationTolerance = 1e-3;
+    std::vector<AccumulationFormat> accumulationFormats = {ACCUMULATION_FORMAT_RGBA32F};
+    uint32_t warmupRenderCalls = 2;
+    uint32_t repeats = 10;
+    bool countRays = false;
+    uint32_t threadCount = 0;
+    uint32_t seed = 0;
+    uint32_t patternSize = 0;
+    uint32_t updateSphereAmount = 0;
+    bool deviceScene = false;
+    bool materialHitGroups = true;
+    std::string pipelineCachePath;
+    std::string accelerationStructureCacheDirectory;
+    std::string jsonPath, csvPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (strcmp(argv[i], "--spheres") == 0 && i + 1 < argc) {
+            sphereAmounts = parseNumberList(argv[++i]);
+        } else if (strcmp(argv[i], "--resolutions") == 0 && i + 1 < argc) {
+            resolutions = parseResolutionList(argv[++i]);
+        } else if (strcmp(argv[i], "--spp") == 0 && i + 1 < argc) {
+            samplesPerRenderCallList = parseNumberList(argv[++i]);
+        } else if (strcmp(argv[i], "--max-depths") == 0 && i + 1 < argc) {
+            maxDepths = parseNumberList(argv[++i]);
+        } else if (strcmp(argv[i], "--roulette-depths") == 0 && i + 1 < argc) {
+            rouletteDepths = parseNumberList(argv[++i]);
+        } else if (strcmp(argv[i], "--noise-calls") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], noiseRenderCalls);
+        } else if (strcmp(argv[i], "--adaptive-threshold") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], adaptiveThreshold);
+        } else if (strcmp(argv[i], "--quality-max-samples") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], qualityMaxSamples);
+        } else if (strcmp(argv[i], "--samplers") == 0 && i + 1 < argc) {
+            samplers = parseSamplerList(argv[++i]);
+        } else if (strcmp(argv[i], "--equal-time-ms") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], equalTimeMilliseconds);
+        } else if (strcmp(argv[i], "--reference-samples") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], referenceSamples);
+        } else if (strcmp(argv[i], "--accumulations") == 0 && i + 1 < argc) {
+            accumulationPrecisions = parseAccumulationList(argv[++i]);
+        } else if (strcmp(argv[i], "--accumulation-samples") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], accumulationSamples);
+        } else if (strcmp(argv[i], "--accumulation-tolerance") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], accumulationTolerance);
+        } else if (strcmp(argv[i], "--accumulation-formats") == 0 && i + 1 < argc) {
+            accumulationFormats = parseAccumulationFormatList(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], warmupRenderCalls);
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], repeats);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], seed);
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], patternSize);
+        } else if (strcmp(argv[i], "--update-spheres") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], updateSphereAmount);
+        } else if (strcmp(argv[i], "--device-scene") == 0) {
+            deviceScene = true;
+        } else if (strcmp(argv[i], "--branching-hit-group") == 0) {
+            materialHitGroups = false;
+        } else if (strcmp(argv[i], "--pipeline-cache") == 0 && i + 1 < argc) {
+            pipelineCachePath = argv[++i];
+        } else if (strcmp(argv[i], "--acceleration-structure-cache") == 0 && i + 1 < argc) {
+            accelerationStructureCacheDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--count-rays") == 0) {
+            countRays = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], threadCount);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else {
+            std::cerr << "Unknown argument '" << argv[i] << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!isSupportedBackend(backend)) {
+        std::cerr << "Unknown backend '" << backend << "' (supported: auto, gpu, cpu)" << std::endl;
+        return 1;
+    }
+
+    // THE UPDATES ARE TAKEN FROM THE HOST COPY OF THE SCENE
+    if (updateSphereAmount > 0 && deviceScene) {
+        std::cerr << "--update-spheres needs a host scene, it cannot be combined with --device-scene" << std::endl;
+        return 1;
+    }
+
+    repeats = std::max(repeats, 1u);
+
+    // EVERY MAX DEPTH WITH EVERY ROULETTE DEPTH, EVERY SAMPLER, EVERY ACCUMULATION PRECISION & EVERY FORMAT
+    std::vector<std::tuple<uint32_t, uint32_t, SamplerType, AccumulationPrecision, AccumulationFormat>>
+            pathConfigurations;
+    for (uint32_t maxDepth: maxDepths) {
+        for (uint32_t rouletteDepth: rouletteDepths) {
+            for (SamplerType sampler: samplers) {
+                for (AccumulationPrecision accumulationPrecision: accumulationPrecisions) {
+                    for (AccumulationFormat accumulationFormat: accumulationFormats) {
+                        pathConfigurations.emplace_back(maxDepth, rouletteDepth, sampler, accumulationPrecision,
+                                                        accumulationFormat);
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream jsonFile, csvFile;
+    if (!jsonPath.empty()) {
+        jsonFile.open(jsonPath, std::ios::out | std::ios::trunc);
+        if (!jsonFile.is_open()) {
+            throw std::runtime_error("[Error] Failed to open JSON file at '" + jsonPath + "'!");
+        }
+    }
+
+    if (!csvPath.empty()) {
+        csvFile.open(csvPath, std::ios::out | std::ios::trunc);
+        if (!csvFile.is_open()) {
+            throw std::runtime_error("[Error] Failed to open CSV file at '" + csvPath + "'!");
+        }
+
+        csvFile << CSV_HEADER << std::endl;
+    }
+
+    std::cout << std::setw(8) << "spheres" << std::setw(12) << "resolution" << std::setw(6) << "spp"
+        << std::setw(7) << "depth" << std::setw(12) << "sampler" << std::setw(7) << "accum"
+        << std::setw(9) << "format"
+        << std::setw(12) << "startup ms" << std::setw(12) << "median ms"
+        << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(12) << "device ms"
+        << std::setw(14) << "Msamples/s" << std::setw(10) << "Mrays/s" << std::endl;
+
+    for (uint32_t sphereAmount: sphereAmounts) {
+        // SCENE
+        const auto sceneBeginTime = std::chrono::steady_clock::now();
+        std::unique_ptr<Scene> scene;
+
+        try {
+            // THE SAME SEED GENERATES THE SAME SCENE ON EVERY RUN. ON THE DEVICE, THE GENERATION IS PART OF THE STARTUP
+            const SceneGenerationSettings generationSettings = {
+                .sphereAmount = sphereAmount,
+                .seed = seed,
+                .patternSize = patternSize,
+                .threadCount = threadCount
+            };
+
+            if (deviceScene) {
+                // THROWS FOR INVALID SETTINGS BEFORE ANY RENDERER IS CREATED
+                static_cast<void>(getSceneGridSize(generationSettings));
+                scene = std::make_unique<Scene>(Scene{.generation = generationSettings});
+            } else {
+                scene = std::make_unique<Scene>(generateRandomScene(generationSettings));
+            }
+        } catch (const std::exception &exception) {
+            std::cerr << "Skipping " << sphereAmount << " spheres: " << exception.what() << std::endl;
+            continue;
+        }
+
+        const double sceneMilliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - sceneBeginTime).count();
+
+        for (const Resolution &resolution: resolutions) {
+            // EQUAL TIME REFERENCES PER MAX DEPTH & ROULETTE DEPTH, SHARED BY ALL SAMPLERS
+            std::map<std::pair<uint32_t, uint32_t>, std::vector<float>> references;
+
+            // FP64 ACCUMULATIONS PER MAX DEPTH, ROULETTE DEPTH, SAMPLER & SAMPLES PER RENDER CALL, SHARED BY ALL
+            // ACCUMULATION PRECISIONS
+            std::map<std::tuple<uint32_t, uint32_t, SamplerType, uint32_t>, RenderOutput> fp64Accumulations;
+
+            for (const auto [maxDepth, rouletteDepth, sampler, accumulationPrecision, accumulationFormat]:
+                    pathConfigurations) {
+                // STARTUP: A NEW RENDERER FOR EVERY CONFIGURATION THAT CHANGES THE SCENE, IMAGES OR PIPELINE
+                VulkanSettings settings = {
+                    .windowWidth = resolution.width,
+                    .windowHeight = resolution.height,
+                    .headless = true,
+                    .countRays = countRays,
+                    .maxDepth = std::max(maxDepth, 1u),
+                    .rouletteDepth = rouletteDepth,
+                    .sampler = sampler,
+                    .accumulationPrecision = accumulationPrecision,
+                    .accumulationFormat = accumulationFormat,
+                    .pipelineCachePath = pipelineCachePath,
+                    .accelerationStructureCacheDirectory = accelerationStructureCacheDirectory,
+                    .dynamicScene = updateSphereAmount > 0,
+                    .materialHitGroups = materialHitGroups
+                };
+
+                CpuRendererSettings cpuSettings = {
+                    .imageWidth = resolution.width,
+                    .imageHeight = resolution.height,
+                    .threadCount = threadCount,
+                    .maxDepth = settings.maxDepth,
+                    .rouletteDepth = settings.rouletteDepth,
+                    .sampler = sampler,
+                    .accumulationPrecision = accumulationPrecision,
+                    .accumulationFormat = accumulationFormat
+                };
+
+                const auto startupBeginTime = std::chrono::steady_clock::now();
+                std::unique_ptr<Renderer> renderer = createRenderer(backend, settings, cpuSettings, *scene);
+                const double startupMilliseconds = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - startupBeginTime).count();
+
+                // SCENE UPDATES: EVERY REPEAT CHANGES updateSphereAmount CONSECUTIVE SPHERES, THEN RESTORES THEM. MOVED
+                // SPHERES REFIT THE ACCELERATION STRUCTURES, RECOLORED ONES ONLY REWRITE THE SPHERE BUFFER
+                const auto measureUpdates = [&](const std::function<void(Sphere &)> &change) {
+                    const auto sceneSphereAmount = static_cast<uint32_t>(scene->spheres.size());
+                    const uint32_t amount = std::min(updateSphereAmount, sceneSphereAmount);
+
+                    std::vector<double> milliseconds;
+                    for (uint32_t i = 0; i < repeats; i++) {
+                        const auto firstSphere = static_cast<uint32_t>(
+                                uint64_t(i) * amount % (sceneSphereAmount - amount + 1));
+                        const std::span<const Sphere> original = scene->spheres.subspan(firstSphere, amount);
+
+                        std::vector<Sphere> changed(original.begin(), original.end());
+                        std::for_each(changed.begin(), changed.end(), change);
+
+                        for (const std::span<const Sphere> spheres: {std::span<const Sphere>(changed), original}) {
+                            const SceneUpdate update = {.firstSphere = firstSphere, .spheres = spheres};
+
+                            const auto beginTime = std::chrono::steady_clock::now();
+                            renderer->updateScene({&update, 1});
+                            milliseconds.push_back(std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - beginTime).count());
+                        }
+                    }
+
+                    return calculateStatistics(milliseconds);
+                };
+
+                TimingStatistics updateMilliseconds = {}, materialUpdateMilliseconds = {};
+                if (updateSphereAmount > 0 && !scene->spheres.empty()) {
+                    // WARM UP: THE CPU BACKEND COPIES ITS SCENE ON THE FIRST UPDATE
+                    const SceneUpdate warmupUpdate = {.firstSphere = 0, .spheres = scene->spheres.first(1)};
+                    renderer->updateScene({&warmupUpdate, 1});
+
+                    updateMilliseconds = measureUpdates([](Sphere &sphere) { sphere.geometry.y += 0.05f; });
+                    materialUpdateMilliseconds = measureUpdates([](Sphere &sphere) {
+                        sphere.colors[0] = glm::vec4(glm::vec3(1.0f) - glm::vec3(sphere.colors[0]),
+                                                                sphere.colors[0].w);
+                    });
+
+                    std::cout << "Updating " << std::min<size_t>(updateSphereAmount, scene->spheres.size())
+                        << " spheres: " << std::fixed << std::setprecision(2) << updateMilliseconds.median
+                        << " ms moved, " << materialUpdateMilliseconds.median << " ms recolored, "
+                        << startupMilliseconds << " ms for a new renderer" << std::endl;
+                }
+
+                std::vector<RenderCallProfile> profiles;
+                renderer->setRenderCallProfiledCallback([&profiles](const RenderCallProfile &profile) {
+                    profiles.push_back(profile);
+                });
+
+                uint32_t renderCallNumber = 0;
+
+                for (uint32_t samplesPerRenderCall: samplesPerRenderCallList) {
+                    samplesPerRenderCall = std::max(samplesPerRenderCall, 1u);
+
+                    const auto renderCall = [&]() {
+                        const RenderCallInfo renderCallInfo = {
+                            .number = ++renderCallNumber,
+                            .samplesPerRenderCall = samplesPerRenderCall
+                        };
+
+                        const auto beginTime = std::chrono::steady_clock::now();
+                        renderer->render(renderCallInfo);
+                        renderer->finish();
+                        return std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - beginTime).count();
+                    };
+
+                    // WARM UP: ALSO LETS THE TILE SCHEDULER SETTLE ON A TILE SIZE
+                    for (uint32_t i = 0; i < warmupRenderCalls; i++) {
+                        renderCall();
+                    }
+
+                    profiles.clear();
+
+                    std::vector<double> wallMilliseconds;
+                    for (uint32_t i = 0; i < repeats; i++) {
+                        wallMilliseconds.push_back(renderCall());
+                    }
+
+                    std::vector<double> deviceMilliseconds;
+                    uint64_t rays = 0;
+                    for (const RenderCallProfile &profile: profiles) {
+                        deviceMilliseconds.push_back(profile.milliseconds);
+                        rays += profile.rays;
+                    }
+
+                    BenchmarkResult result = {
+                            .rendererInfo = renderer->getRendererInfo(),
+                            .sphereAmount = sphereAmount,
+                            .samplesPerRenderCall = samplesPerRenderCall,
+                            .maxDepth = settings.maxDepth,
+                            .rouletteDepth = settings.rouletteDepth,
+                            .sampler = sampler,
+                            .accumulationPrecision = accumulationPrecision,
+                            .accumulationFormat = accumulationFormat,
+                            .repeats = repeats,
+                            .sceneMilliseconds = sceneMilliseconds,
+                            .startupMilliseconds = startupMilliseconds,
+                            .wallMilliseconds = calculateStatistics(wallMilliseconds),
+                            .deviceMilliseconds = calculateStatistics(deviceMilliseconds),
+                            .updateSphereAmount = updateSphereAmount,
+                            .updateMilliseconds = updateMilliseconds,
+                            .materialUpdateMilliseconds = materialUpdateMilliseconds,
+                            .samplesPerRenderCallTotal = static_cast<uint64_t>(resolution.width) * resolution.height *
+                                                         samplesPerRenderCall,
+                            .raysPerRenderCall = profiles.empty() ? 0 : rays / profiles.size(),
+                            .peakResidentMemory = getPeakResidentMemory()
+                    };
+
+                    // NOISE: EVERY RENDER CALL IS READ BACK, SO THEY ARE NOT PART OF THE TIMING ABOVE
+                    NoiseAccumulator noiseAccumulator;
+                    for (uint32_t i = 0; noiseRenderCalls > 0 && i <= noiseRenderCalls; i++) {
+                        if (i > 0) {
+                            renderCall();
+                        }
+
+                        renderer->requestReadback();
+                        noiseAccumulator.add(renderer->waitForReadback());
+                    }
+
+                    result.noiseVariance = noiseAccumulator.getVariance();
+                    result.noiseTimeProduct = result.noiseVariance * result.wallMilliseconds.median;
+
+                    // TIME TO QUALITY: THE ACCUMULATION STARTS OVER, SO A NEW RENDERER SAMPLES ADAPTIVELY UNTIL EVERY
+                    // PIXEL HAS CONVERGED OR qualityMaxSamples ARE REACHED. ITS STARTUP IS NOT PART OF THE TIME. THE
+                    // RGB32F FORMAT HAS NO SAMPLE COUNT PER PIXEL TO SAMPLE ADAPTIVELY WITH
+                    if (adaptiveThreshold > 0.0f && accumulationFormat == ACCUMULATION_FORMAT_RGBA32F) {
+                        VulkanSettings qualitySettings = settings;
+                        qualitySettings.adaptiveThreshold = adaptiveThreshold;
+
+                        CpuRendererSettings qualityCpuSettings = cpuSettings;
+                        qualityCpuSettings.adaptiveThreshold = adaptiveThreshold;
+
+                        std::unique_ptr<Renderer> qualityRenderer = createRenderer(backend, qualitySettings,
+                                                                                   qualityCpuSettings, *scene);
+
+                        uint64_t qualitySamples = 0, activePixels = UINT64_MAX;
+                        qualityRenderer->setRenderCallProfiledCallback([&](const RenderCallProfile &profile) {
+                            qualitySamples += profile.samples;
+                            activePixels = profile.activePixels;
+                        });
+
+                        const uint32_t maxRenderCalls = std::max(
+                                std::min(qualityMaxSamples, MAX_ADAPTIVE_SAMPLES) / samplesPerRenderCall, 1u);
+
+                        const auto beginTime = std::chrono::steady_clock::now();
+                        for (uint32_t number = 1; number <= maxRenderCalls && activePixels > 0; number++) {
+                            qualityRenderer->render({.number = number, .samplesPerRenderCall = samplesPerRenderCall});
+                            qualityRenderer->finish();
+                        }
+
+                        result.adaptiveThreshold = adaptiveThreshold;
+                        result.timeToQualityMilliseconds = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - beginTime).count();
+                        result.qualitySamplesPerPixel = double(qualitySamples) /
+                                                        (double(resolution.width) * resolution.height);
+                        result.qualityConverged = activePixels == 0;
+
+                        std::cout << "Time to quality " << adaptiveThreshold << ": " << std::fixed
+                            << std::setprecision(2) << result.timeToQualityMilliseconds << " ms, "
+                            << result.qualitySamplesPerPixel << " samples per pixel"
+                            << (result.qualityConverged ? "" : " (not converged)") << std::endl;
+                    }
+
+                    // EQUAL TIME: A NEW RENDERER RENDERS UNTIL equalTimeMilliseconds HAVE PASSED, THEN ITS MEAN COLORS
+                    // ARE COMPARED TO THE REFERENCE. ITS STARTUP & THE READBACK ARE NOT PART OF THE TIME
+                    if (equalTimeMilliseconds > 0.0) {
+                        std::vector<float> &reference = references[{settings.maxDepth, settings.rouletteDepth}];
+                        if (reference.empty()) {
+                            const auto referenceBeginTime = std::chrono::steady_clock::now();
+                            reference = renderReference(backend, settings, cpuSettings, *scene, referenceSamples);
+
+                            std::cout << "Reference: " << std::max(referenceSamples, REFERENCE_SAMPLES_PER_RENDER_CALL)
+                                << " samples per pixel in " << std::fixed << std::setprecision(2)
+                                << std::chrono::duration<double, std::milli>(
+                                        std::chrono::steady_clock::now() - referenceBeginTime).count()
+                                << " ms" << std::endl;
+                        }
+
+                        std::unique_ptr<Renderer> equalTimeRenderer = createRenderer(backend, settings, cpuSettings,
+                                                                                     *scene);
+
+                        uint32_t number = 0;
+                        double milliseconds = 0.0;
+
+                        const auto beginTime = std::chrono::steady_clock::now();
+                        while (milliseconds < equalTimeMilliseconds) {
+                            equalTimeRenderer->render({.number = ++number, .samplesPerRenderCall = samplesPerRenderCall});
+                            equalTimeRenderer->finish();
+
+                            milliseconds = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - beginTime).count();
+                        }
+
+                        equalTimeRenderer->requestReadback();
+
+                        result.equalTimeMilliseconds = milliseconds;
+                        result.equalTimeSamplesPerPixel = double(number) * samplesPerRenderCall;
+                        result.equalTimeRMSE = calculateRMSE(getMeanPixelColors(equalTimeRenderer->waitForReadback()),
+                                                             reference);
+
+                        std::cout << "Sampler " << getSamplerTypeName(sampler) << " after " << std::fixed
+                            << std::setprecision(2) << result.equalTimeMilliseconds << " ms: RMSE "
+                            << std::scientific << result.equalTimeRMSE << std::fixed << ", "
+                            << result.equalTimeSamplesPerPixel << " samples per pixel" << std::endl;
+                    }
+
+                    // ACCUMULATION ERROR: accumulationSamples SAMPLES PER PIXEL WITH THIS PRECISION AGAINST THE DOUBLE
+                    // TOTAL OF THE SAME SAMPLES ACCUMULATED IN FP64. FP64 ITSELF IS MEASURED BY ITS FLOAT READBACK
+                    if (accumulationSamples > 0) {
+                        RenderOutput &fp64Accumulation = fp64Accumulations[
+                                {settings.maxDepth, settings.rouletteDepth, sampler, samplesPerRenderCall}];
+                        if (fp64Accumulation.summedPixelColor.empty()) {
+                            VulkanSettings fp64Settings = settings;
+                            fp64Settings.accumulationFormat = ACCUMULATION_FORMAT_RGBA32F;
+
+                            CpuRendererSettings fp64CpuSettings = cpuSettings;
+                            fp64CpuSettings.accumulationFormat = ACCUMULATION_FORMAT_RGBA32F;
+
+                            fp64Accumulation = renderAccumulation(backend, fp64Settings, fp64CpuSettings, *scene,
+                                                                  ACCUMULATION_FP64, accumulationSamples,
+                                                                  samplesPerRenderCall);
+                        }
+
+                        const std::vector<double> reference = getFp64MeanPixelColors(fp64Accumulation);
+
+                        const std::vector<float> accumulation = getMeanPixelColors(
+                                accumulationPrecision == ACCUMULATION_FP64 &&
+                                accumulationFormat == ACCUMULATION_FORMAT_RGBA32F
+                                ? fp64Accumulation
+                                : renderAccumulation(backend, settings, cpuSettings, *scene, accumulationPrecision,
+                                                     accumulationSamples, samplesPerRenderCall));
+
+                        result.accumulationSamples = std::max(accumulationSamples / samplesPerRenderCall, 1u) *
+                                                     samplesPerRenderCall;
+                        result.accumulationMaxRelativeError = calculateMaxRelativeError(accumulation, reference);
+                        result.accumulationRMSE = calculateRMSE(accumulation, reference);
+                        result.accumulationWithinTolerance = result.accumulationMaxRelativeError <= accumulationTolerance;
+
+                        std::cout << "Accumulation " << getAccumulationPrecisionName(accumulationPrecision) << " after "
+                            << result.accumulationSamples << " samples per pixel: max relative error "
+                            << std::scientific << result.accumulationMaxRelativeError << ", RMSE "
+                            << result.accumulationRMSE << std::fixed
+                            << (result.accumulationWithinTolerance ? "" : " (above tolerance)") << std::endl;
+                    }
+
+                    const double seconds = result.wallMilliseconds.median / 1000.0;
+
+                    std::cout << std::setw(8) << sphereAmount << std::setw(12)
+                        << (std::to_string(resolution.width) + "x" + std::to_string(resolution.height))
+                        << std::setw(6) << samplesPerRenderCall << std::setw(7) << settings.maxDepth
+                        << std::setw(12) << getSamplerTypeName(sampler)
+                        << std::setw(7) << getAccumulationPrecisionName(accumulationPrecision)
+                        << std::setw(9) << getAccumulationFormatName(accumulationFormat)
+                        << std::fixed << std::setprecision(2) << std::setw(12) << startupMilliseconds
+                        << std::setw(12) << result.wallMilliseconds.median << std::setw(10)
+                        << result.wallMilliseconds.p90 << std::setw(10) << result.wallMilliseconds.p99
+                        << std::setw(12) << result.deviceMilliseconds.median << std::setw(14)
+                        << double(result.samplesPerRenderCallTotal) / seconds / 1e6 << std::setw(10)
+                        << double(result.raysPerRenderCall) / seconds / 1e6 << std::endl;
+
+                    if (jsonFile.is_open()) {
+                        jsonFile << formatJSON(result) << std::endl;
+                    }
+
+                    if (csvFile.is_open()) {
+                        csvFile << formatCSV(result) << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
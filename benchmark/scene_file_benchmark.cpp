@@ -0,0 +1,136 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "scene_file.h"
+
+template<typename T>
+void parseNumber(const char* argument, T &value) {
+    std::from_chars(argument, argument + strlen(argument), value);
+}
+
+// RANDOM SPHERES WITH ALL MATERIALS & TEXTURES, generateRandomScene() NEVER CREATES CHECKERED SMALL SPHERES
+Scene generateSpheres(uint32_t sphereAmount, std::mt19937 &engine) {
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> material(0, 2), texture(0, 1);
+
+    auto storage = std::make_shared<std::vector<Sphere>>(sphereAmount);
+    for (Sphere &sphere: *storage) {
+        sphere = {
+                .geometry = glm::vec4(position(engine), position(engine), position(engine), 0.1f + unit(engine)),
+                .materialType = material(engine),
+                .textureType = texture(engine),
+                .colors = {glm::vec4(unit(engine), unit(engine), unit(engine), 1.0f),
+                           glm::vec4(unit(engine), unit(engine), unit(engine), 1.0f)},
+                .materialSpecificAttribute = 1.0f + unit(engine)
+        };
+    }
+
+    return {
+            .spheres = *storage,
+            .storage = storage
+    };
+}
+
+bool isSameScene(const Scene &a, const Scene &b) {
+    if (a.spheres.size() != b.spheres.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.spheres.size(); i++) {
+        const Sphere &sphereA = a.spheres[i], &sphereB = b.spheres[i];
+        const int colorCount = sphereA.textureType == TextureType::CHECKERED ? 2 : 1;
+
+        if (memcmp(&sphereA.geometry, &sphereB.geometry, sizeof(glm::vec4)) != 0 ||
+            sphereA.materialType != sphereB.materialType || sphereA.textureType != sphereB.textureType ||
+            sphereA.materialSpecificAttribute != sphereB.materialSpecificAttribute ||
+            memcmp(sphereA.colors, sphereB.colors, sizeof(glm::vec4) * colorCount) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+double getMilliseconds(std::chrono::steady_clock::time_point beginTime) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count();
+}
+
+int main(int argc, const char** argv) {
+    uint32_t sphereAmount = 10000000;
+    uint32_t textSphereAmount = 1000000;
+    std::string directory = std::filesystem::temp_directory_path().string();
+
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--spheres") == 0) {
+            parseNumber(argv[++i], sphereAmount);
+        } else if (strcmp(argv[i], "--text-spheres") == 0) {
+            parseNumber(argv[++i], textSphereAmount);
+        } else if (strcmp(argv[i], "--directory") == 0) {
+            directory = argv[++i];
+        }
+    }
+
+    const std::string binaryPath = (std::filesystem::path(directory) / "scene_file_benchmark.rtscene").string();
+    const std::string textPath = (std::filesystem::path(directory) / "scene_file_benchmark.txt").string();
+
+    std::mt19937 engine(42);
+    std::cout << std::fixed << std::setprecision(2);
+
+    // BINARY: THE FILE IS STILL IN THE PAGE CACHE AFTER WRITING IT, SO THIS MEASURES A WARM LOAD
+    {
+        const Scene scene = generateSpheres(sphereAmount, engine);
+        const double megabytes = double(scene.spheres.size_bytes()) / 1e6;
+
+        auto beginTime = std::chrono::steady_clock::now();
+        writeBinaryScene(binaryPath, scene);
+        const double writeMilliseconds = getMilliseconds(beginTime);
+
+        beginTime = std::chrono::steady_clock::now();
+        const Scene loadedScene = loadBinaryScene(binaryPath);
+        const double mapMilliseconds = getMilliseconds(beginTime);
+
+        // THE UPLOAD: ONE memcpy FROM THE MAPPING INTO (HOST VISIBLE) BUFFER MEMORY
+        std::vector<Sphere> uploadBuffer(loadedScene.spheres.size());
+
+        beginTime = std::chrono::steady_clock::now();
+        memcpy(uploadBuffer.data(), loadedScene.spheres.data(), loadedScene.spheres.size_bytes());
+        const double uploadMilliseconds = getMilliseconds(beginTime);
+
+        std::cout << "Binary scene: " << sphereAmount << " spheres (" << megabytes << " MB)" << std::endl
+            << "  write:          " << std::setw(10) << writeMilliseconds << " ms" << std::endl
+            << "  map & validate: " << std::setw(10) << mapMilliseconds << " ms" << std::endl
+            << "  copy to upload: " << std::setw(10) << uploadMilliseconds << " ms ("
+            << (megabytes / uploadMilliseconds) << " GB/s)" << std::endl
+            << "  round trip:     " << (isSameScene(scene, loadedScene) ? "identical" : "MISMATCH") << std::endl;
+    }
+
+    // TEXT
+    {
+        const Scene scene = generateSpheres(textSphereAmount, engine);
+
+        auto beginTime = std::chrono::steady_clock::now();
+        writeTextScene(textPath, scene);
+        const double writeMilliseconds = getMilliseconds(beginTime);
+
+        beginTime = std::chrono::steady_clock::now();
+        const Scene loadedScene = loadTextScene(textPath);
+        const double loadMilliseconds = getMilliseconds(beginTime);
+
+        std::cout << std::endl << "Text scene: " << textSphereAmount << " spheres ("
+            << double(std::filesystem::file_size(textPath)) / 1e6 << " MB)" << std::endl
+            << "  write:          " << std::setw(10) << writeMilliseconds << " ms" << std::endl
+            << "  parse:          " << std::setw(10) << loadMilliseconds << " ms ("
+            << (double(textSphereAmount) / loadMilliseconds / 1e3) << " M spheres/s)" << std::endl
+            << "  round trip:     " << (isSameScene(scene, loadedScene) ? "identical" : "MISMATCH") << std::endl;
+    }
+
+    std::filesystem::remove(binaryPath);
+    std::filesystem::remove(textPath);
+}
@@ -1,3 +1,43 @@
+// SAMPLERS, SELECTED WHEN THE PIPELINE IS BUILT. shader.rgen & shader.rchit DRAW EVERY RANDOM NUMBER THROUGH THE
+// Sampler OF THE PAYLOAD (structs.glsl)
+const uint SAMPLER_RANDOM = 0;     // TEA SEEDED LCG, ONE STREAM PER PIXEL & RENDER CALL
+const uint SAMPLER_SOBOL = 1;      // OWEN SCRAMBLED SOBOL, SHUFFLED & SCRAMBLED PER PIXEL
+const uint SAMPLER_BLUE_NOISE = 2; // ONE OWEN SCRAMBLED SOBOL SEQUENCE, ROTATED PER PIXEL BY A SCREEN SPACE NOISE MASK
+
+layout(constant_id = 4) const uint SAMPLER = SAMPLER_RANDOM;
+
+// DIMENSIONS OF A PATH: THE CAMERA (PIXEL JITTER & LENS), THEN EVERY BOUNCE (3 TO SCATTER & THE ROULETTE). FIXED
+// OFFSETS KEEP EVERY DIMENSION FOR THE SAME DECISION, HOWEVER MANY NUMBERS THE MATERIALS BEFORE DREW
+const uint CAMERA_DIMENSIONS = 4;
+const uint BOUNCE_DIMENSIONS = 4;
+const uint ROULETTE_DIMENSION = 3;
+
+// THE SOBOL POINTS ARE PADDED FROM 4D SETS, EVERY SET OF DIMENSIONS IS SHUFFLED & SCRAMBLED WITH ITS OWN SEED
+const uint SOBOL_DIMENSIONS = 4;
+
+// DIRECTION NUMBERS OF THE SOBOL DIMENSIONS 1 - 3 (JOE & KUO), DIMENSION 0 IS THE VAN DER CORPUT SEQUENCE
+const uint SOBOL_DIRECTIONS[96] = uint[](
+        0x80000000u, 0xc0000000u, 0xa0000000u, 0xf0000000u, 0x88000000u, 0xcc000000u, 0xaa000000u, 0xff000000u,
+        0x80800000u, 0xc0c00000u, 0xa0a00000u, 0xf0f00000u, 0x88880000u, 0xcccc0000u, 0xaaaa0000u, 0xffff0000u,
+        0x80008000u, 0xc000c000u, 0xa000a000u, 0xf000f000u, 0x88008800u, 0xcc00cc00u, 0xaa00aa00u, 0xff00ff00u,
+        0x80808080u, 0xc0c0c0c0u, 0xa0a0a0a0u, 0xf0f0f0f0u, 0x88888888u, 0xccccccccu, 0xaaaaaaaau, 0xffffffffu,
+
+        0x80000000u, 0xc0000000u, 0x60000000u, 0x90000000u, 0xe8000000u, 0x5c000000u, 0x8e000000u, 0xc5000000u,
+        0x68800000u, 0x9cc00000u, 0xee600000u, 0x55900000u, 0x80680000u, 0xc09c0000u, 0x60ee0000u, 0x90550000u,
+        0xe8808000u, 0x5cc0c000u, 0x8e606000u, 0xc5909000u, 0x6868e800u, 0x9c9c5c00u, 0xeeee8e00u, 0x5555c500u,
+        0x8000e880u, 0xc0005cc0u, 0x60008e60u, 0x9000c590u, 0xe8006868u, 0x5c009c9cu, 0x8e00eeeeu, 0xc5005555u,
+
+        0x80000000u, 0xc0000000u, 0x20000000u, 0x50000000u, 0xf8000000u, 0x74000000u, 0xa2000000u, 0x93000000u,
+        0xd8800000u, 0x25400000u, 0x59e00000u, 0xe6d00000u, 0x78080000u, 0xb40c0000u, 0x82020000u, 0xc3050000u,
+        0x208f8000u, 0x51474000u, 0xfbea2000u, 0x75d93000u, 0xa0858800u, 0x914e5400u, 0xdbe79e00u, 0x25db6d00u,
+        0x58800080u, 0xe54000c0u, 0x79e00020u, 0xb6d00050u, 0x800800f8u, 0xc00c0074u, 0x200200a2u, 0x50050093u
+);
+
+// ALL PIXELS SHARE THE SOBOL SEQUENCE OF THE BLUE NOISE SAMPLER, ONLY THEIR ROTATION DIFFERS
+const uint BLUE_NOISE_SEED = 0x2545f491u;
+
+
+// HASHING
 uint getRandomSeed(const uint val0, const uint val1) {
     uint v0 = val0;
     uint v1 = val1;
@@ -12,6 +52,21 @@ uint getRandomSeed(const uint val0, const uint val1) {
     return v0;
 }
 
+uint hashInt(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+uint hashCombine(const uint seed, const uint value) {
+    return seed ^ (hashInt(value) + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+
+// LCG
 uint randomInt(inout uint seed) {
     seed = 1664525 * seed + 1013904223;
     return seed;
@@ -21,14 +76,104 @@ float randomFloat(inout uint seed) {
     return float(randomInt(seed) & 0x00FFFFFFu) / float(0x01000000u);
 }
 
-float randomInInterval(inout uint seed, const float min, const float max) {
-    return randomFloat(seed) * (max - min) + min;
+
+// OWEN SCRAMBLED SOBOL (BURLEY 2020)
+uint getSobol(uint index, const uint dimension) {
+    if (dimension == 0) {
+        return bitfieldReverse(index);
+    }
+
+    // ONE XOR PER SET BIT OF THE INDEX
+    uint value = 0;
+    for (; index != 0; index &= index - 1) {
+        value ^= SOBOL_DIRECTIONS[(dimension - 1) * 32 + uint(findLSB(index))];
+    }
+
+    return value;
+}
+
+// HASH BASED OWEN SCRAMBLING: A RANDOM PERMUTATION OF EVERY LEVEL OF THE BINARY TREE OF THE VALUE, SO THE POINTS STAY
+// STRATIFIED LIKE THE UNSCRAMBLED ONES
+uint nestedUniformScramble(uint x, const uint seed) {
+    x = bitfieldReverse(x);
+
+    // LAINE-KARRAS PERMUTATION
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+
+    return bitfieldReverse(x);
+}
+
+float getOwenScrambledSobol(const uint sampleIndex, const uint dimension, const uint seed) {
+    const uint setSeed = hashCombine(seed, dimension / SOBOL_DIMENSIONS);
+    const uint sobolDimension = dimension % SOBOL_DIMENSIONS;
+
+    // SHUFFLING THE INDEX DECORRELATES THE 4D SETS, A POWER OF TWO PREFIX STILL COVERS THE SAME STRATA
+    const uint shuffledIndex = nestedUniformScramble(sampleIndex, setSeed);
+    const uint value = nestedUniformScramble(getSobol(shuffledIndex, sobolDimension), hashCombine(setSeed, sobolDimension));
+
+    return float(value >> 8) / float(0x01000000u);
+}
+
+// INTERLEAVED GRADIENT NOISE, SHIFTED PER DIMENSION. NEIGHBOURING PIXELS GET DISTANT ROTATIONS, SO THE ERROR IS PUSHED
+// TO HIGH SCREEN SPACE FREQUENCIES LIKE WITH A BLUE NOISE MASK
+float getScreenSpaceNoise(const uint pixel, const uint dimension) {
+    const vec2 position = vec2(pixel & 0xFFFFu, pixel >> 16) + 5.588238f * float(dimension);
+    return fract(52.9829189f * fract(dot(position, vec2(0.06711056f, 0.00583715f))));
+}
+
+
+// SAMPLER
+Sampler createSampler(const uvec2 pixel, const uint renderCallNumber) {
+    Sampler sampler = Sampler(0u, (pixel.y << 16) | pixel.x, 0u, 0u);
+
+    if (SAMPLER == SAMPLER_RANDOM) {
+        sampler.seed = getRandomSeed(getRandomSeed(pixel.x, pixel.y), renderCallNumber);
+    } else if (SAMPLER == SAMPLER_SOBOL) {
+        sampler.seed = hashCombine(hashInt(pixel.x), pixel.y);
+    } else {
+        sampler.seed = BLUE_NOISE_SEED;
+    }
+
+    return sampler;
+}
+
+// THE LCG STREAM RUNS ON OVER THE SAMPLES OF A RENDER CALL, THE OTHER SAMPLERS ONLY DEPEND ON THE GLOBAL SAMPLE INDEX
+void startSample(inout Sampler sampler, const uint sampleIndex) {
+    sampler.sampleIndex = sampleIndex;
+    sampler.dimension = 0;
+}
+
+void setDimension(inout Sampler sampler, const uint dimension) {
+    sampler.dimension = dimension;
+}
+
+float randomFloat(inout Sampler sampler) {
+    if (SAMPLER == SAMPLER_RANDOM) {
+        return randomFloat(sampler.seed);
+    }
+
+    const uint dimension = sampler.dimension++;
+    const float value = getOwenScrambledSobol(sampler.sampleIndex, dimension, sampler.seed);
+
+    if (SAMPLER == SAMPLER_SOBOL) {
+        return value;
+    }
+
+    return fract(value + getScreenSpaceNoise(sampler.pixel, dimension));
+}
+
+float randomInInterval(inout Sampler sampler, const float min, const float max) {
+    return randomFloat(sampler) * (max - min) + min;
 }
 
-vec3 randomVector(inout uint seed, const float min, const float max) {
-    return vec3(randomInInterval(seed, min, max), randomInInterval(seed, min, max), randomInInterval(seed, min, max));
+vec3 randomVector(inout Sampler sampler, const float min, const float max) {
+    return vec3(randomInInterval(sampler, min, max), randomInInterval(sampler, min, max), randomInInterval(sampler, min, max));
 }
 
-vec3 randomUnitVector(inout uint seed) {
-    return normalize(randomVector(seed, -1.0f, 1.0f));
+vec3 randomUnitVector(inout Sampler sampler) {
+    return normalize(randomVector(sampler, -1.0f, 1.0f));
 }
@@ -2,6 +2,10 @@
 #include <string>
 
 inline std::string rgen_shader_path = "${rgen_shader_path}";
+inline std::string rgen_fp64_shader_path = "${rgen_fp64_shader_path}";
 inline std::string rint_shader_path = "${rint_shader_path}";
 inline std::string rchit_shader_path = "${rchit_shader_path}";
 inline std::string rmiss_shader_path = "${rmiss_shader_path}";
+inline std::string generate_scene_shader_path = "${generate_scene_shader_path}";
+inline std::string select_active_pixels_shader_path = "${select_active_pixels_shader_path}";
+inline std::string resolve_shader_path = "${resolve_shader_path}";
@@ -1,5 +1,13 @@
+// STATE OF THE SAMPLER OF random.glsl
+struct Sampler {
+    uint seed;        // LCG STATE OR SCRAMBLING SEED
+    uint pixel;       // (Y << 16) | X
+    uint sampleIndex; // INDEX OF THE SAMPLE OVER ALL RENDER CALLS OF THE PIXEL
+    uint dimension;
+};
+
 struct Payload {
-    uint seed;
+    Sampler sampler;
 
     bool doesScatter;
     vec3 attenuation;
@@ -0,0 +1,21 @@
+#include "accumulation_format.h"
+
+std::optional<AccumulationFormat> parseAccumulationFormat(const std::string &name) {
+    if (name == "rgba32f") {
+        return ACCUMULATION_FORMAT_RGBA32F;
+    }
+
+    if (name == "rgb32f") {
+        return ACCUMULATION_FORMAT_RGB32F;
+    }
+
+    return std::nullopt;
+}
+
+std::string getAccumulationFormatName(AccumulationFormat accumulationFormat) {
+    if (accumulationFormat == ACCUMULATION_FORMAT_RGB32F) {
+        return "rgb32f";
+    }
+
+    return "rgba32f";
+}
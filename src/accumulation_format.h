@@ -0,0 +1,15 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// LAYOUT OF THE SUMMED PIXEL COLORS, THE VALUES OF THE COMPACT_ACCUMULATION SPECIALIZATION CONSTANT OF shader.rgen
+enum AccumulationFormat {
+    ACCUMULATION_FORMAT_RGBA32F = 0, // ONE RGBA32F IMAGE, ALPHA COUNTS THE SAMPLES OF EVERY PIXEL
+    ACCUMULATION_FORMAT_RGB32F = 1   // ONE R32F IMAGE LAYER PER CHANNEL, ALL PIXELS SHARE THE SAMPLE COUNT
+};
+
+// COMMAND LINE NAMES: rgba32f, rgb32f
+std::optional<AccumulationFormat> parseAccumulationFormat(const std::string &name);
+
+std::string getAccumulationFormatName(AccumulationFormat accumulationFormat);
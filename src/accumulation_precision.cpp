@@ -0,0 +1,37 @@
+#include "accumulation_precision.h"
+
+std::optional<AccumulationPrecision> parseAccumulationPrecision(const std::string &name) {
+    if (name == "fp64") {
+        return ACCUMULATION_FP64;
+    }
+
+    if (name == "fp32") {
+        return ACCUMULATION_FP32;
+    }
+
+    if (name == "kahan") {
+        return ACCUMULATION_KAHAN;
+    }
+
+    if (name == "split") {
+        return ACCUMULATION_SPLIT;
+    }
+
+    return std::nullopt;
+}
+
+std::string getAccumulationPrecisionName(AccumulationPrecision accumulationPrecision) {
+    if (accumulationPrecision == ACCUMULATION_FP64) {
+        return "fp64";
+    }
+
+    if (accumulationPrecision == ACCUMULATION_KAHAN) {
+        return "kahan";
+    }
+
+    if (accumulationPrecision == ACCUMULATION_SPLIT) {
+        return "split";
+    }
+
+    return "fp32";
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// HOW shader.rgen ADDS THE SAMPLES OF A RENDER CALL TO THE SUMMED PIXEL COLORS, THE VALUES OF ITS ACCUMULATION
+// SPECIALIZATION CONSTANT
+enum AccumulationPrecision {
+    ACCUMULATION_FP64 = 0,  // FP64 SUM OVER THE RENDER CALL, NEEDS shaderFloat64 & ITS OWN SHADER MODULE
+    ACCUMULATION_FP32 = 1,  // FP32 PARTIAL SUM OVER THE RENDER CALL, ADDED ONCE
+    ACCUMULATION_KAHAN = 2, // AS FP32, THE ROUNDING ERROR OF THE ADD IS COMPENSATED IN THE NEXT RENDER CALL
+    ACCUMULATION_SPLIT = 3  // AS FP32, THE SUM IS KEPT AS A HI & A LO FLOAT, SO NO ROUNDING ERROR IS LOST
+};
+
+// COMMAND LINE NAMES: fp64, fp32, kahan, split
+std::optional<AccumulationPrecision> parseAccumulationPrecision(const std::string &name);
+
+std::string getAccumulationPrecisionName(AccumulationPrecision accumulationPrecision);
@@ -0,0 +1,511 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cmath>
+
+Bvh::Bvh(const Sphere* spheres, uint32_t sphereAmount, ThreadPool &threadPool, BvhBuildSettings buildSettings) :
+        spheres(spheres), buildSettings(buildSettings) {
+
+    if (sphereAmount > 0) {
+        build(sphereAmount, threadPool);
+    }
+}
+
+const std::vector<BvhNode> &Bvh::getNodes() const {
+    return nodes;
+}
+
+const SpherePackets &Bvh::getSpherePackets() const {
+    return spherePackets;
+}
+
+
+// BOUNDS
+void Bvh::Bounds::grow(const glm::vec3 &point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void Bvh::Bounds::grow(const Bounds &bounds) {
+    min = glm::min(min, bounds.min);
+    max = glm::max(max, bounds.max);
+}
+
+Bvh::Bounds Bvh::SphereReference::getBounds() const {
+    return {.min = center - glm::vec3(radius), .max = center + glm::vec3(radius)};
+}
+
+float Bvh::Bounds::surfaceArea() const {
+    const glm::vec3 extent = max - min;
+    return extent.x < 0.0f ? 0.0f : 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+
+// BUILD
+float Bvh::getPacketCount(uint32_t sphereCount) {
+    return float((sphereCount + SPHERE_PACKET_WIDTH - 1) / SPHERE_PACKET_WIDTH);
+}
+
+void Bvh::build(uint32_t sphereAmount, ThreadPool &threadPool) {
+    sphereReferences.resize(sphereAmount);
+
+    const uint32_t chunkCount = threadPool.getThreadCount() * 4;
+    std::vector<Bounds> chunkBounds(chunkCount);
+
+    threadPool.parallelFor(chunkCount, [&](uint32_t chunk) {
+        const uint32_t begin = static_cast<uint64_t>(chunk) * sphereAmount / chunkCount;
+        const uint32_t end = static_cast<uint64_t>(chunk + 1) * sphereAmount / chunkCount;
+
+        for (uint32_t i = begin; i < end; i++) {
+            sphereReferences[i] = {
+                    .center = glm::vec3(spheres[i].geometry),
+                    .radius = std::abs(spheres[i].geometry.w),
+                    .sphereIndex = i
+            };
+            chunkBounds[chunk].grow(sphereReferences[i].getBounds());
+        }
+    });
+
+    Bounds rootBounds;
+    for (const Bounds &bounds: chunkBounds) {
+        rootBounds.grow(bounds);
+    }
+
+    buildNodes.push_back({.bounds = rootBounds, .left = 0, .right = 0, .begin = 0, .count = sphereAmount});
+
+    // TOP LEVELS: SPLIT THE LARGEST RANGE WITH PARALLEL BINNING UNTIL THERE ARE ENOUGH INDEPENDENT SUBTREES
+    std::vector<BuildTask> tasks = {{.nodeIndex = 0, .begin = 0, .end = sphereAmount, .depth = 0}};
+
+    while (true) {
+        const auto largestTask = std::max_element(tasks.begin(), tasks.end(), [](const auto &a, const auto &b) {
+            return a.end - a.begin < b.end - b.begin;
+        });
+
+        if (largestTask == tasks.end() || (largestTask->end - largestTask->begin < buildSettings.parallelBinningThreshold &&
+                                           tasks.size() >= chunkCount)) {
+            break;
+        }
+
+        const BuildTask task = *largestTask;
+        tasks.erase(largestTask);
+
+        uint32_t middle;
+        if (splitNode(buildNodes, task.nodeIndex, task.begin, task.end, task.depth, &threadPool, middle)) {
+            const BuildNode &node = buildNodes[task.nodeIndex];
+            tasks.push_back({.nodeIndex = node.left, .begin = task.begin, .end = middle, .depth = task.depth + 1});
+            tasks.push_back({.nodeIndex = node.right, .begin = middle, .end = task.end, .depth = task.depth + 1});
+        }
+
+        if (tasks.empty()) {
+            break;
+        }
+    }
+
+    // SUBTREES: BUILT INTO SEPARATE NODE ARRAYS IN PARALLEL, THEN SPLICED INTO THE TREE
+    std::vector<std::vector<BuildNode>> subtreeNodes(tasks.size());
+
+    threadPool.parallelFor(static_cast<uint32_t>(tasks.size()), [&](uint32_t taskIndex) {
+        const BuildTask &task = tasks[taskIndex];
+        subtreeNodes[taskIndex].push_back(buildNodes[task.nodeIndex]);
+        buildSubtree(subtreeNodes[taskIndex], 0, task.begin, task.end, task.depth);
+    });
+
+    for (uint32_t taskIndex = 0; taskIndex < tasks.size(); taskIndex++) {
+        const std::vector<BuildNode> &localNodes = subtreeNodes[taskIndex];
+        const auto base = static_cast<uint32_t>(buildNodes.size());
+        const uint32_t rootIndex = tasks[taskIndex].nodeIndex;
+
+        // LOCAL NODE 0 REPLACES THE PLACEHOLDER, ALL OTHERS ARE APPENDED
+        const auto mapIndex = [&](uint32_t localIndex) {
+            return localIndex == 0 ? rootIndex : base + localIndex - 1;
+        };
+
+        for (uint32_t localIndex = 0; localIndex < localNodes.size(); localIndex++) {
+            BuildNode node = localNodes[localIndex];
+
+            if (node.count == 0) {
+                node.left = mapIndex(node.left);
+                node.right = mapIndex(node.right);
+            }
+
+            if (localIndex == 0) {
+                buildNodes[rootIndex] = node;
+            } else {
+                buildNodes.push_back(node);
+            }
+        }
+    }
+
+    // COLLAPSE THE BINARY TREE INTO 4-WIDE NODES, LEAVES BECOME PACKET ALIGNED RANGES OF spherePackets
+    nodes.reserve(buildNodes.size() / 2 + 1);
+
+    if (buildNodes[0].count > 0) {
+        // THE ROOT IS A SINGLE LEAF, WRAP IT INTO A NODE WITH ONE OCCUPIED SLOT
+        buildNodes.push_back(buildNodes[0]);
+        buildNodes[0] = {.bounds = buildNodes[0].bounds, .left = 1, .right = 1, .begin = 0, .count = 0};
+    }
+
+    collapse(0);
+
+    sphereReferences = {};
+    buildNodes = {};
+}
+
+Bvh::Bounds Bvh::calculateCentroidBounds(uint32_t begin, uint32_t end, ThreadPool* threadPool) const {
+    if (threadPool == nullptr || end - begin < buildSettings.parallelBinningThreshold) {
+        Bounds bounds;
+        for (uint32_t i = begin; i < end; i++) {
+            bounds.grow(sphereReferences[i].center);
+        }
+
+        return bounds;
+    }
+
+    const uint32_t chunkCount = threadPool->getThreadCount() * 4;
+    std::vector<Bounds> chunkBounds(chunkCount);
+
+    threadPool->parallelFor(chunkCount, [&](uint32_t chunk) {
+        chunkBounds[chunk] = calculateCentroidBounds(begin + static_cast<uint64_t>(chunk) * (end - begin) / chunkCount,
+                                                     begin + static_cast<uint64_t>(chunk + 1) * (end - begin) / chunkCount,
+                                                     nullptr);
+    });
+
+    Bounds bounds;
+    for (const Bounds &chunk: chunkBounds) {
+        bounds.grow(chunk);
+    }
+
+    return bounds;
+}
+
+uint32_t Bvh::getBinIndex(float centroid, float binOffset, float binScale) const {
+    return std::min(static_cast<uint32_t>((centroid - binOffset) * binScale), buildSettings.binCount - 1);
+}
+
+void Bvh::binSpheres(uint32_t begin, uint32_t end, const Bounds &centroidBounds, std::vector<Bin> &bins) const {
+    const glm::vec3 binScale = float(buildSettings.binCount) / (centroidBounds.max - centroidBounds.min);
+
+    for (uint32_t i = begin; i < end; i++) {
+        const SphereReference &reference = sphereReferences[i];
+        const Bounds bounds = reference.getBounds();
+
+        for (uint32_t axis = 0; axis < 3; axis++) {
+            if (centroidBounds.max[axis] <= centroidBounds.min[axis]) {
+                continue;
+            }
+
+            Bin &bin = bins[axis * buildSettings.binCount +
+                            getBinIndex(reference.center[axis], centroidBounds.min[axis], binScale[axis])];
+            bin.bounds.grow(bounds);
+            bin.count++;
+        }
+    }
+}
+
+Bvh::Split Bvh::findSplit(uint32_t begin, uint32_t end, const Bounds &centroidBounds, ThreadPool* threadPool) const {
+    const uint32_t binCount = buildSettings.binCount;
+    std::vector<Bin> bins(3 * binCount);
+
+    if (threadPool == nullptr || end - begin < buildSettings.parallelBinningThreshold) {
+        binSpheres(begin, end, centroidBounds, bins);
+
+    } else {
+        const uint32_t chunkCount = threadPool->getThreadCount() * 4;
+        std::vector<std::vector<Bin>> chunkBins(chunkCount, std::vector<Bin>(3 * binCount));
+
+        threadPool->parallelFor(chunkCount, [&](uint32_t chunk) {
+            binSpheres(begin + static_cast<uint64_t>(chunk) * (end - begin) / chunkCount,
+                       begin + static_cast<uint64_t>(chunk + 1) * (end - begin) / chunkCount,
+                       centroidBounds, chunkBins[chunk]);
+        });
+
+        for (const std::vector<Bin> &chunk: chunkBins) {
+            for (uint32_t i = 0; i < bins.size(); i++) {
+                bins[i].bounds.grow(chunk[i].bounds);
+                bins[i].count += chunk[i].count;
+            }
+        }
+    }
+
+    // SWEEP FROM BOTH SIDES, THE SPLIT AFTER BIN i SEPARATES [0, i] FROM [i + 1, binCount)
+    Split bestSplit = {.axis = 0, .bin = 0, .cost = std::numeric_limits<float>::infinity()};
+    std::vector<Bounds> rightBounds(binCount);
+    std::vector<uint32_t> rightCounts(binCount);
+
+    for (uint32_t axis = 0; axis < 3; axis++) {
+        if (centroidBounds.max[axis] <= centroidBounds.min[axis]) {
+            continue;
+        }
+
+        const Bin* axisBins = &bins[axis * binCount];
+
+        Bounds bounds;
+        uint32_t count = 0;
+        for (uint32_t i = binCount - 1; i > 0; i--) {
+            bounds.grow(axisBins[i].bounds);
+            count += axisBins[i].count;
+            rightBounds[i - 1] = bounds;
+            rightCounts[i - 1] = count;
+        }
+
+        bounds = {};
+        count = 0;
+        for (uint32_t i = 0; i < binCount - 1; i++) {
+            bounds.grow(axisBins[i].bounds);
+            count += axisBins[i].count;
+
+            if (count == 0 || rightCounts[i] == 0) {
+                continue;
+            }
+
+            const float cost = bounds.surfaceArea() * getPacketCount(count) +
+                               rightBounds[i].surfaceArea() * getPacketCount(rightCounts[i]);
+            if (cost < bestSplit.cost) {
+                bestSplit = {.axis = axis, .bin = i, .cost = cost, .leftBounds = bounds, .rightBounds = rightBounds[i]};
+            }
+        }
+    }
+
+    return bestSplit;
+}
+
+bool Bvh::splitNode(std::vector<BuildNode> &targetNodes, uint32_t nodeIndex, uint32_t begin, uint32_t end,
+                    uint32_t depth, ThreadPool* threadPool, uint32_t &middle) {
+    const uint32_t count = end - begin;
+    const Bounds nodeBounds = targetNodes[nodeIndex].bounds;
+
+    const auto makeLeaf = [&]() {
+        targetNodes[nodeIndex] = {.bounds = nodeBounds, .left = 0, .right = 0, .begin = begin, .count = count};
+        return false;
+    };
+
+    if (count <= 1) {
+        return makeLeaf();
+    }
+
+    const Bounds centroidBounds = calculateCentroidBounds(begin, end, threadPool);
+    const glm::vec3 centroidExtent = centroidBounds.max - centroidBounds.min;
+
+    Split split = {.axis = 0, .bin = 0, .cost = std::numeric_limits<float>::infinity()};
+    if (depth < buildSettings.maxDepth) {
+        split = findSplit(begin, end, centroidBounds, threadPool);
+    }
+
+    // SAH IN UNITS OF PACKET INTERSECTIONS, A 4-WIDE BOX TEST COSTS ABOUT AS MUCH AS ONE PACKET
+    const float leafCost = getPacketCount(count);
+    const float splitCost = 1.0f + split.cost / nodeBounds.surfaceArea();
+
+    if (count <= buildSettings.maxLeafSize && (std::isinf(split.cost) || leafCost <= splitCost)) {
+        return makeLeaf();
+    }
+
+    Bounds leftBounds, rightBounds;
+
+    if (!std::isinf(split.cost)) {
+        const float binOffset = centroidBounds.min[split.axis];
+        const float binScale = float(buildSettings.binCount) / centroidExtent[split.axis];
+
+        middle = static_cast<uint32_t>(std::partition(
+                sphereReferences.begin() + begin, sphereReferences.begin() + end, [&](const SphereReference &reference) {
+                    return getBinIndex(reference.center[split.axis], binOffset, binScale) <= split.bin;
+                }) - sphereReferences.begin());
+        leftBounds = split.leftBounds;
+        rightBounds = split.rightBounds;
+
+    } else {
+        // NO USABLE SAH SPLIT (COINCIDENT CENTROIDS OR MAXIMUM DEPTH): OBJECT MEDIAN ON THE WIDEST AXIS
+        const uint32_t axis = centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 :
+                              centroidExtent.y >= centroidExtent.z ? 1 : 2;
+        middle = begin + count / 2;
+        std::nth_element(sphereReferences.begin() + begin, sphereReferences.begin() + middle,
+                         sphereReferences.begin() + end, [&](const SphereReference &a, const SphereReference &b) {
+                    return a.center[axis] < b.center[axis];
+                });
+
+        for (uint32_t i = begin; i < middle; i++) {
+            leftBounds.grow(sphereReferences[i].getBounds());
+        }
+
+        for (uint32_t i = middle; i < end; i++) {
+            rightBounds.grow(sphereReferences[i].getBounds());
+        }
+    }
+
+    const auto left = static_cast<uint32_t>(targetNodes.size());
+    targetNodes.push_back({.bounds = leftBounds, .left = 0, .right = 0, .begin = begin, .count = 0});
+    targetNodes.push_back({.bounds = rightBounds, .left = 0, .right = 0, .begin = middle, .count = 0});
+    targetNodes[nodeIndex] = {.bounds = nodeBounds, .left = left, .right = left + 1, .begin = begin, .count = 0};
+
+    return true;
+}
+
+void Bvh::buildSubtree(std::vector<BuildNode> &targetNodes, uint32_t nodeIndex, uint32_t begin, uint32_t end,
+                       uint32_t depth) {
+    uint32_t middle;
+    if (!splitNode(targetNodes, nodeIndex, begin, end, depth, nullptr, middle)) {
+        return;
+    }
+
+    const uint32_t left = targetNodes[nodeIndex].left;
+    const uint32_t right = targetNodes[nodeIndex].right;
+
+    buildSubtree(targetNodes, left, begin, middle, depth + 1);
+    buildSubtree(targetNodes, right, middle, end, depth + 1);
+}
+
+uint32_t Bvh::collapse(uint32_t buildNodeIndex) {
+    // OPEN THE CHILD WITH THE LARGEST SURFACE AREA UNTIL ALL FOUR SLOTS ARE USED
+    uint32_t slots[4] = {buildNodes[buildNodeIndex].left, buildNodes[buildNodeIndex].right};
+    uint32_t slotCount = buildNodes[buildNodeIndex].left == buildNodes[buildNodeIndex].right ? 1 : 2;
+
+    while (slotCount < 4) {
+        int largestSlot = -1;
+        float largestSurfaceArea = -1.0f;
+
+        for (uint32_t slot = 0; slot < slotCount; slot++) {
+            const BuildNode &child = buildNodes[slots[slot]];
+            if (child.count == 0 && child.bounds.surfaceArea() > largestSurfaceArea) {
+                largestSlot = static_cast<int>(slot);
+                largestSurfaceArea = child.bounds.surfaceArea();
+            }
+        }
+
+        if (largestSlot < 0) {
+            break;
+        }
+
+        const BuildNode &opened = buildNodes[slots[largestSlot]];
+        slots[largestSlot] = opened.left;
+        slots[slotCount++] = opened.right;
+    }
+
+    const auto nodeIndex = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    for (uint32_t slot = 0; slot < 4; slot++) {
+        BvhNode &node = nodes[nodeIndex];
+
+        if (slot >= slotCount) {
+            // INVERTED BOUNDS ARE NEVER HIT BY THE SLAB TEST
+            node.minX[slot] = node.minY[slot] = node.minZ[slot] = std::numeric_limits<float>::infinity();
+            node.maxX[slot] = node.maxY[slot] = node.maxZ[slot] = -std::numeric_limits<float>::infinity();
+            node.children[slot] = EMPTY_CHILD;
+            node.counts[slot] = 0;
+            continue;
+        }
+
+        const BuildNode child = buildNodes[slots[slot]];
+        node.minX[slot] = child.bounds.min.x;
+        node.minY[slot] = child.bounds.min.y;
+        node.minZ[slot] = child.bounds.min.z;
+        node.maxX[slot] = child.bounds.max.x;
+        node.maxY[slot] = child.bounds.max.y;
+        node.maxZ[slot] = child.bounds.max.z;
+
+        if (child.count > 0) {
+            std::vector<uint32_t> leafSphereIndices(child.count);
+            for (uint32_t i = 0; i < child.count; i++) {
+                leafSphereIndices[i] = sphereReferences[child.begin + i].sphereIndex;
+            }
+
+            const auto firstLane = static_cast<uint32_t>(spherePackets.sphereIndices.size());
+            appendSpherePacket(spherePackets, spheres, leafSphereIndices.data(), child.count);
+
+            node.children[slot] = firstLane;
+            node.counts[slot] = static_cast<uint32_t>(spherePackets.sphereIndices.size()) - firstLane;
+
+        } else {
+            // THE RECURSION CAN REALLOCATE nodes, SO THE REFERENCE IS NOT REUSED
+            const uint32_t childIndex = collapse(slots[slot]);
+            nodes[nodeIndex].children[slot] = childIndex;
+            nodes[nodeIndex].counts[slot] = 0;
+        }
+    }
+
+    return nodeIndex;
+}
+
+
+// TRAVERSAL
+bool Bvh::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMin, SphereHit &hit) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    glm::vec3 inverseDirection;
+    for (int axis = 0; axis < 3; axis++) {
+        const float d = direction[axis];
+        inverseDirection[axis] = 1.0f / (std::abs(d) > 1e-20f ? d : std::copysign(1e-20f, d));
+    }
+
+    const bool negativeX = inverseDirection.x < 0.0f;
+    const bool negativeY = inverseDirection.y < 0.0f;
+    const bool negativeZ = inverseDirection.z < 0.0f;
+
+    struct StackEntry {
+        uint32_t nodeIndex;
+        float tNear;
+    };
+
+    StackEntry stack[MAX_TRAVERSAL_STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {.nodeIndex = 0, .tNear = tMin};
+
+    bool hasHit = false;
+
+    while (stackSize > 0) {
+        const StackEntry entry = stack[--stackSize];
+        if (entry.tNear > hit.t) {
+            continue;
+        }
+
+        const BvhNode &node = nodes[entry.nodeIndex];
+        const float* nearX = negativeX ? node.maxX : node.minX;
+        const float* farX = negativeX ? node.minX : node.maxX;
+        const float* nearY = negativeY ? node.maxY : node.minY;
+        const float* farY = negativeY ? node.minY : node.maxY;
+        const float* nearZ = negativeZ ? node.maxZ : node.minZ;
+        const float* farZ = negativeZ ? node.minZ : node.maxZ;
+
+        // FOUR INDEPENDENT SLAB TESTS THE COMPILER CAN VECTORIZE, THE EXIT IS ROUNDED UP TO STAY CONSERVATIVE
+        float tNear[4];
+        bool slotHit[4];
+        for (uint32_t slot = 0; slot < 4; slot++) {
+            const float tEnter = std::max(std::max((nearX[slot] - origin.x) * inverseDirection.x,
+                                                   (nearY[slot] - origin.y) * inverseDirection.y),
+                                          std::max((nearZ[slot] - origin.z) * inverseDirection.z, tMin));
+            const float tExit = std::min(std::min((farX[slot] - origin.x) * inverseDirection.x,
+                                                  (farY[slot] - origin.y) * inverseDirection.y),
+                                         std::min((farZ[slot] - origin.z) * inverseDirection.z, hit.t));
+
+            tNear[slot] = tEnter;
+            slotHit[slot] = tEnter <= tExit * 1.00000024f;
+        }
+
+        // LEAVES ARE INTERSECTED RIGHT AWAY TO SHRINK hit.t, INNER NODES ARE PUSHED FAR TO NEAR
+        uint32_t innerSlots[4];
+        uint32_t innerSlotCount = 0;
+
+        for (uint32_t slot = 0; slot < 4; slot++) {
+            if (!slotHit[slot] || node.children[slot] == EMPTY_CHILD) {
+                continue;
+            }
+
+            if (node.counts[slot] > 0) {
+                hasHit |= intersectSpherePackets(spherePackets, node.children[slot],
+                                                 node.children[slot] + node.counts[slot], origin, direction, tMin, hit);
+            } else {
+                uint32_t i = innerSlotCount++;
+                for (; i > 0 && tNear[innerSlots[i - 1]] < tNear[slot]; i--) {
+                    innerSlots[i] = innerSlots[i - 1];
+                }
+                innerSlots[i] = slot;
+            }
+        }
+
+        for (uint32_t i = 0; i < innerSlotCount; i++) {
+            stack[stackSize++] = {.nodeIndex = node.children[innerSlots[i]], .tNear = tNear[innerSlots[i]]};
+        }
+    }
+
+    return hasHit;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "scene.h"
+#include "sphere_intersection.h"
+#include "thread_pool.h"
+
+// FOUR CHILDREN AS STRUCTURE OF ARRAYS, SO A WHOLE NODE IS TWO CACHE LINES AND ITS BOXES ARE TESTED TOGETHER
+struct alignas(64) BvhNode {
+    float minX[4], minY[4], minZ[4];
+    float maxX[4], maxY[4], maxZ[4];
+    uint32_t children[4]; // NODE INDEX, OR THE FIRST SPHERE PACKET LANE OF A LEAF
+    uint32_t counts[4]; // 0 FOR INNER NODES, THE NUMBER OF SPHERE PACKET LANES OF A LEAF
+};
+
+static_assert(sizeof(BvhNode) == 128);
+
+struct BvhBuildSettings {
+    uint32_t binCount = 16;
+    uint32_t maxLeafSize = 2 * SPHERE_PACKET_WIDTH;
+    uint32_t maxDepth = 48;
+    uint32_t parallelBinningThreshold = 1 << 16;
+};
+
+class Bvh {
+public:
+    Bvh(const Sphere* spheres, uint32_t sphereAmount, ThreadPool &threadPool, BvhBuildSettings buildSettings = {});
+
+    // SAME SEMANTICS AS intersectSpherePackets() OVER ALL SPHERES
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMin, SphereHit &hit) const;
+
+    [[nodiscard]] const std::vector<BvhNode> &getNodes() const;
+
+    [[nodiscard]] const SpherePackets &getSpherePackets() const;
+
+private:
+    static const uint32_t EMPTY_CHILD = 0xFFFFFFFF;
+    static const uint32_t MAX_TRAVERSAL_STACK_SIZE = 256;
+
+    struct Bounds {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::infinity());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::infinity());
+
+        void grow(const glm::vec3 &point);
+
+        void grow(const Bounds &bounds);
+
+        [[nodiscard]] float surfaceArea() const;
+    };
+
+    // BINARY NODE OF THE BUILD, COLLAPSED INTO BvhNodes AFTERWARDS
+    struct BuildNode {
+        Bounds bounds;
+        uint32_t left, right;
+        uint32_t begin, count; // count > 0 FOR LEAVES
+    };
+
+    struct BuildTask {
+        uint32_t nodeIndex;
+        uint32_t begin, end;
+        uint32_t depth;
+    };
+
+    struct Split {
+        uint32_t axis;
+        uint32_t bin;
+        float cost;
+        Bounds leftBounds, rightBounds;
+    };
+
+    // COPIED OUT OF THE SCENE AND PARTITIONED IN PLACE, SO THE BUILD ONLY TOUCHES CONTIGUOUS MEMORY
+    struct SphereReference {
+        glm::vec3 center;
+        float radius;
+        uint32_t sphereIndex;
+
+        [[nodiscard]] Bounds getBounds() const;
+    };
+
+    struct Bin {
+        Bounds bounds;
+        uint32_t count = 0;
+    };
+
+    const Sphere* spheres;
+    BvhBuildSettings buildSettings;
+
+    std::vector<SphereReference> sphereReferences;
+    std::vector<BuildNode> buildNodes;
+
+    std::vector<BvhNode> nodes;
+    SpherePackets spherePackets;
+
+    [[nodiscard]] static float getPacketCount(uint32_t sphereCount);
+
+    void build(uint32_t sphereAmount, ThreadPool &threadPool);
+
+    [[nodiscard]] Bounds calculateCentroidBounds(uint32_t begin, uint32_t end, ThreadPool* threadPool) const;
+
+    [[nodiscard]] Split findSplit(uint32_t begin, uint32_t end, const Bounds &centroidBounds,
+                                  ThreadPool* threadPool) const;
+
+    void binSpheres(uint32_t begin, uint32_t end, const Bounds &centroidBounds, std::vector<Bin> &bins) const;
+
+    [[nodiscard]] uint32_t getBinIndex(float centroid, float binOffset, float binScale) const;
+
+    bool splitNode(std::vector<BuildNode> &targetNodes, uint32_t nodeIndex, uint32_t begin, uint32_t end,
+                   uint32_t depth, ThreadPool* threadPool, uint32_t &middle);
+
+    void buildSubtree(std::vector<BuildNode> &targetNodes, uint32_t nodeIndex, uint32_t begin, uint32_t end,
+                      uint32_t depth);
+
+    uint32_t collapse(uint32_t buildNodeIndex);
+};
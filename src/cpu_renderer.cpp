@@ -0,0 +1,825 @@
+#include "cpu_renderer.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+
+// RANDOM (random.glsl)
+static const uint32_t SOBOL_DIMENSIONS = 4;
+
+static const uint32_t SOBOL_DIRECTIONS[96] = {
+        0x80000000u, 0xc0000000u, 0xa0000000u, 0xf0000000u, 0x88000000u, 0xcc000000u, 0xaa000000u, 0xff000000u,
+        0x80800000u, 0xc0c00000u, 0xa0a00000u, 0xf0f00000u, 0x88880000u, 0xcccc0000u, 0xaaaa0000u, 0xffff0000u,
+        0x80008000u, 0xc000c000u, 0xa000a000u, 0xf000f000u, 0x88008800u, 0xcc00cc00u, 0xaa00aa00u, 0xff00ff00u,
+        0x80808080u, 0xc0c0c0c0u, 0xa0a0a0a0u, 0xf0f0f0f0u, 0x88888888u, 0xccccccccu, 0xaaaaaaaau, 0xffffffffu,
+
+        0x80000000u, 0xc0000000u, 0x60000000u, 0x90000000u, 0xe8000000u, 0x5c000000u, 0x8e000000u, 0xc5000000u,
+        0x68800000u, 0x9cc00000u, 0xee600000u, 0x55900000u, 0x80680000u, 0xc09c0000u, 0x60ee0000u, 0x90550000u,
+        0xe8808000u, 0x5cc0c000u, 0x8e606000u, 0xc5909000u, 0x6868e800u, 0x9c9c5c00u, 0xeeee8e00u, 0x5555c500u,
+        0x8000e880u, 0xc0005cc0u, 0x60008e60u, 0x9000c590u, 0xe8006868u, 0x5c009c9cu, 0x8e00eeeeu, 0xc5005555u,
+
+        0x80000000u, 0xc0000000u, 0x20000000u, 0x50000000u, 0xf8000000u, 0x74000000u, 0xa2000000u, 0x93000000u,
+        0xd8800000u, 0x25400000u, 0x59e00000u, 0xe6d00000u, 0x78080000u, 0xb40c0000u, 0x82020000u, 0xc3050000u,
+        0x208f8000u, 0x51474000u, 0xfbea2000u, 0x75d93000u, 0xa0858800u, 0x914e5400u, 0xdbe79e00u, 0x25db6d00u,
+        0x58800080u, 0xe54000c0u, 0x79e00020u, 0xb6d00050u, 0x800800f8u, 0xc00c0074u, 0x200200a2u, 0x50050093u
+};
+
+static const uint32_t BLUE_NOISE_SEED = 0x2545f491u;
+
+static uint32_t getRandomSeed(const uint32_t val0, const uint32_t val1) {
+    uint32_t v0 = val0;
+    uint32_t v1 = val1;
+    uint32_t s0 = 0;
+
+    for (uint32_t n = 0; n < 16; n++) {
+        s0 += 0x9e3779b9;
+        v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+        v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+    }
+
+    return v0;
+}
+
+static uint32_t hashInt(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint32_t hashCombine(const uint32_t seed, const uint32_t value) {
+    return seed ^ (hashInt(value) + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+static uint32_t randomInt(uint32_t &seed) {
+    seed = 1664525 * seed + 1013904223;
+    return seed;
+}
+
+static float randomFloat(uint32_t &seed) {
+    return float(randomInt(seed) & 0x00FFFFFFu) / float(0x01000000u);
+}
+
+// GLSL bitfieldReverse
+static uint32_t reverseBits(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+static uint32_t getSobol(uint32_t index, const uint32_t dimension) {
+    if (dimension == 0) {
+        return reverseBits(index);
+    }
+
+    // ONE XOR PER SET BIT OF THE INDEX
+    uint32_t value = 0;
+    for (; index != 0; index &= index - 1) {
+        value ^= SOBOL_DIRECTIONS[(dimension - 1) * 32 + std::countr_zero(index)];
+    }
+
+    return value;
+}
+
+static uint32_t nestedUniformScramble(uint32_t x, const uint32_t seed) {
+    x = reverseBits(x);
+
+    // LAINE-KARRAS PERMUTATION
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+
+    return reverseBits(x);
+}
+
+static float getOwenScrambledSobol(const uint32_t sampleIndex, const uint32_t dimension, const uint32_t seed) {
+    const uint32_t setSeed = hashCombine(seed, dimension / SOBOL_DIMENSIONS);
+    const uint32_t sobolDimension = dimension % SOBOL_DIMENSIONS;
+
+    const uint32_t shuffledIndex = nestedUniformScramble(sampleIndex, setSeed);
+    const uint32_t value = nestedUniformScramble(getSobol(shuffledIndex, sobolDimension),
+                                                 hashCombine(setSeed, sobolDimension));
+
+    return float(value >> 8) / float(0x01000000u);
+}
+
+static float fract(const float value) {
+    return value - std::floor(value);
+}
+
+static float getScreenSpaceNoise(const uint32_t pixel, const uint32_t dimension) {
+    const glm::vec2 position = glm::vec2(float(pixel & 0xFFFFu), float(pixel >> 16)) + 5.588238f * float(dimension);
+    return fract(52.9829189f * fract(glm::dot(position, glm::vec2(0.06711056f, 0.00583715f))));
+}
+
+static CpuSampler createSampler(const SamplerType type, const uint32_t x, const uint32_t y,
+                                const uint32_t renderCallNumber) {
+    CpuSampler sampler = {.type = type, .seed = 0, .pixel = (y << 16) | x, .sampleIndex = 0, .dimension = 0};
+
+    if (type == SAMPLER_RANDOM) {
+        sampler.seed = getRandomSeed(getRandomSeed(x, y), renderCallNumber);
+    } else if (type == SAMPLER_SOBOL) {
+        sampler.seed = hashCombine(hashInt(x), y);
+    } else {
+        sampler.seed = BLUE_NOISE_SEED;
+    }
+
+    return sampler;
+}
+
+static void startSample(CpuSampler &sampler, const uint32_t sampleIndex) {
+    sampler.sampleIndex = sampleIndex;
+    sampler.dimension = 0;
+}
+
+static void setDimension(CpuSampler &sampler, const uint32_t dimension) {
+    sampler.dimension = dimension;
+}
+
+static float randomFloat(CpuSampler &sampler) {
+    if (sampler.type == SAMPLER_RANDOM) {
+        return randomFloat(sampler.seed);
+    }
+
+    const uint32_t dimension = sampler.dimension++;
+    const float value = getOwenScrambledSobol(sampler.sampleIndex, dimension, sampler.seed);
+
+    if (sampler.type == SAMPLER_SOBOL) {
+        return value;
+    }
+
+    return fract(value + getScreenSpaceNoise(sampler.pixel, dimension));
+}
+
+static float randomInInterval(CpuSampler &sampler, const float min, const float max) {
+    return randomFloat(sampler) * (max - min) + min;
+}
+
+static glm::vec3 randomVector(CpuSampler &sampler, const float min, const float max) {
+    // EXPLICIT ORDER: THE DRAWS HAVE TO HAPPEN IN THE SAME ORDER AS IN GLSL
+    const float x = randomInInterval(sampler, min, max);
+    const float y = randomInInterval(sampler, min, max);
+    const float z = randomInInterval(sampler, min, max);
+    return {x, y, z};
+}
+
+static glm::vec3 randomUnitVector(CpuSampler &sampler) {
+    return glm::normalize(randomVector(sampler, -1.0f, 1.0f));
+}
+
+
+// MATERIAL (shader.rchit)
+static glm::vec4 getTextureColor(const Sphere &sphere, const glm::vec3 &pointOnSphere) {
+    if (sphere.textureType == TextureType::SOLID) {
+        return sphere.colors[0];
+
+    } else if (sphere.textureType == TextureType::CHECKERED) {
+        const float size = 6.0f;
+        const float sines = std::sin(size * pointOnSphere.x) * std::sin(size * pointOnSphere.y) *
+                            std::sin(size * pointOnSphere.z);
+        return sphere.colors[sines > 0.0f ? 0 : 1];
+    }
+
+    return sphere.colors[0];
+}
+
+static bool isVectorNearZero(const glm::vec3 &vector) {
+    const float s = 1e-8f;
+    return std::abs(vector.x) < s && std::abs(vector.y) < s && std::abs(vector.z) < s;
+}
+
+static bool canRefract(const glm::vec3 &vector, const glm::vec3 &normal, const float eta) {
+    const float cosTheta = glm::dot(-vector, normal);
+    return eta * std::sqrt(1.0f - cosTheta * cosTheta) <= 1.0f;
+}
+
+static float reflectanceFactor(const glm::vec3 &vector, const glm::vec3 &normal, const float eta) {
+    const float r = std::pow((1.0f - eta) / (1.0f + eta), 2.0f);
+    return r + (1.0f - r) * std::pow(1.0f - glm::dot(-vector, normal), 5.0f);
+}
+
+static glm::vec3 getDiffuseScatterDirection(const glm::vec3 &normal, CpuSampler &sampler) {
+    glm::vec3 scatterDirection = normal + randomUnitVector(sampler);
+
+    if (isVectorNearZero(scatterDirection)) {
+        scatterDirection = normal;
+    }
+
+    return scatterDirection;
+}
+
+static glm::vec3 getMetalScatterDirection(const Sphere &sphere, const glm::vec3 &rayDirection,
+                                          const glm::vec3 &normal, CpuSampler &sampler) {
+    const glm::vec3 reflectedDirection = glm::reflect(rayDirection, normal);
+    const glm::vec3 fuzzDirection = sphere.materialSpecificAttribute * randomUnitVector(sampler);
+    const glm::vec3 scatterDirection = glm::normalize(reflectedDirection + fuzzDirection);
+
+    const bool doesScatter = glm::dot(scatterDirection, normal) > 0.0f;
+    if (!doesScatter) {
+        return glm::vec3(0.0f);
+    }
+
+    return scatterDirection;
+}
+
+static glm::vec3 getRefractiveScatterDirection(const Sphere &sphere, const glm::vec3 &rayDirection,
+                                               const glm::vec3 &normal, const bool frontFace, CpuSampler &sampler) {
+    const float eta = frontFace ? (1.0f / sphere.materialSpecificAttribute) : sphere.materialSpecificAttribute;
+
+    // SHORT CIRCUIT: THE RANDOM NUMBER IS ONLY DRAWN IF THE RAY CAN REFRACT
+    const bool doesRefract = canRefract(rayDirection, normal, eta) &&
+                             reflectanceFactor(rayDirection, normal, eta) < randomFloat(sampler);
+
+    if (doesRefract) {
+        return glm::refract(rayDirection, normal, eta);
+    }
+
+    return glm::reflect(rayDirection, normal);
+}
+
+static glm::vec3 getScatterDirection(const Sphere &sphere, const glm::vec3 &rayDirection, const glm::vec3 &normal,
+                                     const bool frontFace, CpuSampler &sampler) {
+    if (sphere.materialType == MaterialType::DIFFUSE) {
+        return getDiffuseScatterDirection(normal, sampler);
+    }
+
+    if (sphere.materialType == MaterialType::METAL) {
+        return getMetalScatterDirection(sphere, rayDirection, normal, sampler);
+    }
+
+    if (sphere.materialType == MaterialType::REFRACTIVE) {
+        return getRefractiveScatterDirection(sphere, rayDirection, normal, frontFace, sampler);
+    }
+
+    return glm::vec3(0.0f);
+}
+
+
+// RENDERER
+CpuRenderer::CpuRenderer(CpuRendererSettings settings, const Scene &scene) :
+        settings(settings), scene(scene.generation ? generateRandomScene(*scene.generation) : scene),
+        threadPool(settings.threadCount),
+        viewport(calculateViewport(float(settings.imageWidth) / float(settings.imageHeight))) {
+
+    const auto bvhBeginTime = std::chrono::steady_clock::now();
+    bvh = std::make_unique<Bvh>(this->scene.spheres.data(), static_cast<uint32_t>(this->scene.spheres.size()),
+                                threadPool);
+
+    startupTimings.push_back(
+            {
+                    .stage = "bvh",
+                    .milliseconds = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - bvhBeginTime).count()
+            });
+
+    const auto imagesBeginTime = std::chrono::steady_clock::now();
+    const size_t pixelCount = static_cast<size_t>(settings.imageWidth) * settings.imageHeight;
+    if (settings.imageWidth > MAX_IMAGE_EXTENT || settings.imageHeight > MAX_IMAGE_EXTENT) {
+        throw std::runtime_error("[Error] The image can be at most " + std::to_string(MAX_IMAGE_EXTENT) + " pixels wide "
+                                 "and high!");
+    }
+
+    if (settings.accumulationFormat == ACCUMULATION_FORMAT_RGB32F && isAdaptiveSampling()) {
+        throw std::runtime_error("[Error] The rgb32f accumulation format has no sample count per pixel, use rgba32f for "
+                                 "adaptive sampling!");
+    }
+
+    summedPixelColor.resize(pixelCount * getChannelCount(), 0.0f);
+
+    if (isAdaptiveSampling()) {
+        summedSquaredLuminance.resize(pixelCount, 0.0f);
+        activePixels.reserve(pixelCount);
+    }
+
+    if (hasAccumulationErrorImage()) {
+        summedPixelColorError.resize(pixelCount * 3, 0.0f);
+    }
+
+    if (settings.accumulationPrecision == ACCUMULATION_FP64) {
+        summedPixelColorFp64.resize(pixelCount * 3, 0.0);
+    }
+
+    startupTimings.push_back(
+            {
+                    .stage = "images",
+                    .milliseconds = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - imagesBeginTime).count()
+            });
+}
+
+void CpuRenderer::update() {
+}
+
+// THE BVH IS REBUILT IF ANY SPHERE MOVED OR WAS RESIZED, MATERIALS & COLORS ARE ONLY READ DURING SHADING
+void CpuRenderer::updateScene(std::span<const SceneUpdate> updates) {
+    for (const SceneUpdate &update: updates) {
+        if (update.firstSphere > scene.spheres.size() ||
+            update.spheres.size() > scene.spheres.size() - update.firstSphere) {
+            throw std::runtime_error("[Error] Scene update of spheres " + std::to_string(update.firstSphere) + " to " +
+                                     std::to_string(update.firstSphere + update.spheres.size()) +
+                                     " is out of the scene's " + std::to_string(scene.spheres.size()) + " spheres!");
+        }
+    }
+
+    // THE SPHERES MAY BE A READ ONLY FILE MAPPING OR BELONG TO THE CALLER, THE BVH THEN POINTS TO THE COPY
+    bool rebuildBvh = false;
+    if (!updatedSpheres) {
+        updatedSpheres = std::make_shared<std::vector<Sphere>>(scene.spheres.begin(), scene.spheres.end());
+        scene.spheres = *updatedSpheres;
+        scene.storage = updatedSpheres;
+        rebuildBvh = true;
+    }
+
+    for (const SceneUpdate &update: updates) {
+        for (uint32_t i = 0; i < update.spheres.size(); i++) {
+            Sphere &sphere = (*updatedSpheres)[update.firstSphere + i];
+            rebuildBvh |= sphere.geometry != update.spheres[i].geometry;
+            sphere = update.spheres[i];
+        }
+    }
+
+    if (rebuildBvh) {
+        bvh = std::make_unique<Bvh>(updatedSpheres->data(), static_cast<uint32_t>(updatedSpheres->size()),
+                                    threadPool);
+    }
+}
+
+void CpuRenderer::render(const RenderCallInfo &renderCallInfo) {
+    std::vector<Tile> tiles;
+    uint64_t sampledPixels = static_cast<uint64_t>(settings.imageWidth) * settings.imageHeight;
+
+    if (isAdaptiveSampling()) {
+        // A TILE IS A SLICE OF THE ACTIVE PIXEL LIST: offsetX IS ITS FIRST ENTRY, width ITS LENGTH
+        selectActivePixels();
+        sampledPixels = activePixels.size();
+
+        const auto activePixelCount = static_cast<uint32_t>(activePixels.size());
+        const uint32_t sliceSize = settings.tileSize * settings.tileSize;
+
+        for (uint32_t first = 0; first < activePixelCount; first += sliceSize) {
+            tiles.push_back(
+                    {
+                            .offsetX = first,
+                            .offsetY = 0,
+                            .width = std::min(sliceSize, activePixelCount - first),
+                            .height = 1
+                    });
+        }
+    } else {
+        for (uint32_t offsetY = 0; offsetY < settings.imageHeight; offsetY += settings.tileSize) {
+            for (uint32_t offsetX = 0; offsetX < settings.imageWidth; offsetX += settings.tileSize) {
+                tiles.push_back(
+                        {
+                                .offsetX = offsetX,
+                                .offsetY = offsetY,
+                                .width = std::min(settings.tileSize, settings.imageWidth - offsetX),
+                                .height = std::min(settings.tileSize, settings.imageHeight - offsetY)
+                        });
+            }
+        }
+    }
+
+    const auto tileCount = static_cast<uint32_t>(tiles.size());
+    std::vector<uint64_t> tileRays(tileCount, 0);
+
+    const auto renderCallBeginTime = std::chrono::steady_clock::now();
+
+    threadPool.parallelFor(tileCount, [&](uint32_t tileIndex) {
+        const auto tileBeginTime = std::chrono::steady_clock::now();
+        tileRays[tileIndex] = renderTile(renderCallInfo, tiles[tileIndex]);
+
+        std::lock_guard<std::mutex> lock(tileCompletedMutex);
+        if (tileCompletedCallback) {
+            tileCompletedCallback(
+                    {
+                            .renderCallNumber = renderCallInfo.number,
+                            .tileIndex = tileIndex,
+                            .tileCount = tileCount,
+                            .tile = tiles[tileIndex],
+                            .milliseconds = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - tileBeginTime).count()
+                    });
+        }
+    });
+
+    lastRenderCallInfo = renderCallInfo;
+    accumulatedSamples += renderCallInfo.samplesPerRenderCall;
+
+    if (renderCallProfiledCallback) {
+        const double milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - renderCallBeginTime).count();
+
+        RenderCallProfile profile = {
+                .renderCallNumber = renderCallInfo.number,
+                .tileCount = tileCount,
+                .samplesPerRenderCall = renderCallInfo.samplesPerRenderCall,
+                .samples = sampledPixels * renderCallInfo.samplesPerRenderCall,
+                .rays = 0,
+                .activePixels = sampledPixels,
+                .milliseconds = milliseconds,
+                .barrierMilliseconds = 0.0,
+                .traceRaysMilliseconds = milliseconds,
+                .copyMilliseconds = 0.0
+        };
+
+        for (uint64_t rays: tileRays) {
+            profile.rays += rays;
+        }
+
+        renderCallProfiledCallback(profile);
+    }
+}
+
+void CpuRenderer::finish() {
+}
+
+bool CpuRenderer::shouldExit() const {
+    return true;
+}
+
+void CpuRenderer::requestReadback() {
+    if (pendingReadback) {
+        throw std::runtime_error("A readback is already pending!");
+    }
+
+    // RENDER CALLS ARE SYNCHRONOUS, SO THE SUMS ARE COMPLETE
+    std::vector<float> summedPixelColorRGBA = summedPixelColor;
+
+    // RGB -> RGBA, ALL PIXELS HAVE THE SAMPLES OF THE RENDER CALLS SO FAR
+    if (getChannelCount() == 3) {
+        const size_t pixelCount = summedPixelColor.size() / 3;
+        summedPixelColorRGBA.assign(pixelCount * 4, float(accumulatedSamples));
+
+        for (size_t pixel = 0; pixel < pixelCount; pixel++) {
+            for (size_t channel = 0; channel < 3; channel++) {
+                summedPixelColorRGBA[pixel * 4 + channel] = summedPixelColor[pixel * 3 + channel];
+            }
+        }
+    }
+
+    pendingReadback = RenderOutput{
+            .width = settings.imageWidth,
+            .height = settings.imageHeight,
+            .sampleCount = lastRenderCallInfo.number * lastRenderCallInfo.samplesPerRenderCall,
+            .renderTarget = resolveRenderTarget(summedPixelColorRGBA, settings.toneMapOperator),
+            .summedPixelColor = std::move(summedPixelColorRGBA),
+            .summedPixelColorFp64 = summedPixelColorFp64
+    };
+}
+
+bool CpuRenderer::isReadbackPending() const {
+    return pendingReadback.has_value();
+}
+
+std::optional<RenderOutput> CpuRenderer::pollReadback() {
+    std::optional<RenderOutput> output = std::move(pendingReadback);
+    pendingReadback.reset();
+    return output;
+}
+
+RenderOutput CpuRenderer::waitForReadback() {
+    if (!pendingReadback) {
+        throw std::runtime_error("No readback has been requested!");
+    }
+
+    return *pollReadback();
+}
+
+void CpuRenderer::setTileCompletedCallback(std::function<void(const TileProgress &)> callback) {
+    std::lock_guard<std::mutex> lock(tileCompletedMutex);
+    tileCompletedCallback = std::move(callback);
+}
+
+uint32_t CpuRenderer::getTileSize() const {
+    return settings.tileSize;
+}
+
+void CpuRenderer::setRenderCallProfiledCallback(std::function<void(const RenderCallProfile &)> callback) {
+    renderCallProfiledCallback = std::move(callback);
+}
+
+RendererInfo CpuRenderer::getRendererInfo() const {
+    // THE BVH IS BUILT AT ITS FINAL SIZE, THERE IS NOTHING TO COMPACT
+    const uint64_t bvhMemory = bvh->getNodes().size() * sizeof(BvhNode) +
+                               bvh->getSpherePackets().sphereIndices.size() * 5 * sizeof(float);
+
+    const uint64_t accumulationMemory = (summedPixelColor.size() + summedSquaredLuminance.size() +
+                                         summedPixelColorError.size()) * sizeof(float) +
+                                        summedPixelColorFp64.size() * sizeof(double);
+
+    const uint64_t allocatedMemory = accumulationMemory +
+                                     activePixels.capacity() * sizeof(uint32_t) + bvhMemory;
+
+    return {
+            .backend = "cpu",
+            .deviceName = std::to_string(threadPool.getThreadCount()) + " threads",
+            .driverVersion = "packet width " + std::to_string(SPHERE_PACKET_WIDTH),
+            .imageWidth = settings.imageWidth,
+            .imageHeight = settings.imageHeight,
+            .startupTimings = startupTimings,
+            .allocatedMemory = allocatedMemory,
+            .reservedMemory = allocatedMemory,
+            .memoryBlockCount = 0,
+            .dedicatedAllocationCount = 0,
+            .memoryFragmentation = 0.0,
+            .deviceMemoryUsage = 0,
+            .deviceMemoryBudget = 0,
+            .sceneUploadBytes = 0,
+            .sceneUploadMilliseconds = 0.0,
+            .accelerationStructureMemory = bvhMemory,
+            .uncompactedAccelerationStructureMemory = bvhMemory,
+            .bottomAccelerationStructureCount = 1,
+            .instanceCount = 1,
+            .hitGroupCount = 0,
+            .accumulationMemory = accumulationMemory,
+            .accumulationBytesPerPixel = getAccumulationBytesPerPixel()
+    };
+}
+
+bool CpuRenderer::isAdaptiveSampling() const {
+    return settings.adaptiveThreshold > 0.0f;
+}
+
+size_t CpuRenderer::getChannelCount() const {
+    return settings.accumulationFormat == ACCUMULATION_FORMAT_RGB32F ? 3 : 4;
+}
+
+// LOADS & STORES OF renderPixel() PER SAMPLED PIXEL & RENDER CALL, AS Vulkan::getAccumulationBytesPerPixel()
+uint32_t CpuRenderer::getAccumulationBytesPerPixel() const {
+    auto bytes = static_cast<uint32_t>(2 * getChannelCount() * sizeof(float));
+
+    if (hasAccumulationErrorImage()) {
+        bytes += 2 * 3 * sizeof(float);
+    }
+
+    if (settings.accumulationPrecision == ACCUMULATION_FP64) {
+        bytes += 2 * 3 * sizeof(double);
+    }
+
+    if (isAdaptiveSampling()) {
+        bytes += 2 * sizeof(float);
+    }
+
+    return bytes;
+}
+
+bool CpuRenderer::hasAccumulationErrorImage() const {
+    return settings.accumulationPrecision == ACCUMULATION_KAHAN || settings.accumulationPrecision == ACCUMULATION_SPLIT;
+}
+
+void CpuRenderer::selectActivePixels() {
+    activePixels.clear();
+
+    for (uint32_t y = 0; y < settings.imageHeight; y++) {
+        for (uint32_t x = 0; x < settings.imageWidth; x++) {
+            if (isPixelActive(static_cast<size_t>(y) * settings.imageWidth + x)) {
+                activePixels.push_back((y << 16) | x);
+            }
+        }
+    }
+}
+
+bool CpuRenderer::isPixelActive(size_t pixel) const {
+    const float sampleCount = summedPixelColor[pixel * 4 + 3];
+
+    if (sampleCount < float(std::max(settings.adaptiveMinSamples, 2u))) {
+        return true;
+    }
+
+    const glm::vec3 summedColor = glm::vec3(summedPixelColor[pixel * 4 + 0], summedPixelColor[pixel * 4 + 1],
+                                            summedPixelColor[pixel * 4 + 2]);
+
+    const float mean = glm::dot(summedColor, LUMINANCE_WEIGHTS) / sampleCount;
+    const float squaredMean = summedSquaredLuminance[pixel] / sampleCount;
+    const float variance = std::max(squaredMean - mean * mean, 0.0f) * sampleCount / (sampleCount - 1.0f);
+    const float standardError = std::sqrt(variance / sampleCount);
+
+    return standardError > settings.adaptiveThreshold * (mean + LUMINANCE_OFFSET);
+}
+
+// shader.rgen
+uint64_t CpuRenderer::renderTile(const RenderCallInfo &renderCallInfo, const Tile &tile) {
+    uint64_t tracedRays = 0;
+
+    if (isAdaptiveSampling()) {
+        for (uint32_t entry = tile.offsetX; entry < tile.offsetX + tile.width; entry++) {
+            renderPixel(renderCallInfo, activePixels[entry] & 0xFFFFu, activePixels[entry] >> 16, tracedRays);
+        }
+
+        return tracedRays;
+    }
+
+    for (uint32_t y = tile.offsetY; y < tile.offsetY + tile.height; y++) {
+        for (uint32_t x = tile.offsetX; x < tile.offsetX + tile.width; x++) {
+            renderPixel(renderCallInfo, x, y, tracedRays);
+        }
+    }
+
+    return tracedRays;
+}
+
+void CpuRenderer::renderPixel(const RenderCallInfo &renderCallInfo, uint32_t x, uint32_t y, uint64_t &tracedRays) {
+    const glm::vec2 size = glm::vec2(float(settings.imageWidth), float(settings.imageHeight));
+    const size_t pixel = static_cast<size_t>(y) * settings.imageWidth + x;
+    const size_t channelCount = getChannelCount();
+    const size_t pixelIndex = pixel * channelCount;
+
+    // THE SAMPLES BEFORE THIS RENDER CALL
+    const float previousSampleCount = channelCount == 4 ? summedPixelColor[pixelIndex + 3] : float(accumulatedSamples);
+
+    CpuSampler sampler = createSampler(settings.sampler, x, y, renderCallInfo.number);
+    const auto firstSample = static_cast<uint32_t>(previousSampleCount);
+
+    const glm::vec3 sum = glm::vec3(summedPixelColor[pixelIndex + 0], summedPixelColor[pixelIndex + 1],
+                                    summedPixelColor[pixelIndex + 2]);
+
+    // THE SAMPLES OF THIS RENDER CALL ARE SUMMED FROM ZERO, SO THEY ARE NOT ROUNDED TO THE MAGNITUDE OF THE WHOLE SUM
+    const bool fp64 = settings.accumulationPrecision == ACCUMULATION_FP64;
+    glm::dvec3 partialSumFp64 = glm::dvec3(0.0);
+    glm::vec3 partialSum = glm::vec3(0.0f);
+    float squaredLuminanceSum = 0.0f;
+
+    for (uint32_t i = 0; i < renderCallInfo.samplesPerRenderCall; i++) {
+        startSample(sampler, firstSample + i);
+
+        const float u = float(x) + randomFloat(sampler);
+        const float v = float(y) + randomFloat(sampler);
+        const CpuRay ray = getCameraRay(glm::vec2(u, v) / size, sampler);
+        const glm::vec3 color = calculateRayColor(ray, sampler, tracedRays);
+        if (fp64) {
+            partialSumFp64 += glm::dvec3(color);
+        } else {
+            partialSum += color;
+        }
+
+        const float luminance = glm::dot(color, LUMINANCE_WEIGHTS);
+        squaredLuminanceSum += luminance * luminance;
+    }
+
+    glm::vec3 summedColor;
+    if (fp64) {
+        // THE TOTAL STAYS IN DOUBLE, summedPixelColor ONLY GETS IT ROUNDED TO FLOAT
+        double* total = &summedPixelColorFp64[pixel * 3];
+        total[0] += partialSumFp64.x;
+        total[1] += partialSumFp64.y;
+        total[2] += partialSumFp64.z;
+
+        summedColor = glm::vec3(float(total[0]), float(total[1]), float(total[2]));
+    } else {
+        summedColor = accumulate(pixel, sum, partialSum);
+    }
+
+    summedPixelColor[pixelIndex + 0] = summedColor.x;
+    summedPixelColor[pixelIndex + 1] = summedColor.y;
+    summedPixelColor[pixelIndex + 2] = summedColor.z;
+
+    if (channelCount == 4) {
+        summedPixelColor[pixelIndex + 3] = previousSampleCount + float(renderCallInfo.samplesPerRenderCall);
+    }
+
+    if (isAdaptiveSampling()) {
+        summedSquaredLuminance[pixel] += squaredLuminanceSum;
+    }
+}
+
+// THE ERROR IMAGE HOLDS THE KAHAN COMPENSATION OR THE lo PART OF THE SPLIT SUM, SEE shader.rgen
+glm::vec3 CpuRenderer::accumulate(size_t pixel, const glm::vec3 &sum, const glm::vec3 &partialSum) {
+    if (!hasAccumulationErrorImage()) {
+        return sum + partialSum;
+    }
+
+    float* error = &summedPixelColorError[pixel * 3];
+    const glm::vec3 previousError = glm::vec3(error[0], error[1], error[2]);
+    glm::vec3 newSum, newError;
+
+    if (settings.accumulationPrecision == ACCUMULATION_KAHAN) {
+        const glm::vec3 compensatedPartialSum = partialSum - previousError;
+        newSum = sum + compensatedPartialSum;
+        newError = (newSum - sum) - compensatedPartialSum;
+    } else {
+        // TWO-SUM & RENORMALIZATION, hi STAYS THE ROUNDED SUM
+        const glm::vec3 roundedSum = sum + partialSum;
+        const glm::vec3 partialSumPart = roundedSum - sum;
+        const glm::vec3 roundingError = (sum - (roundedSum - partialSumPart)) + (partialSum - partialSumPart);
+        const glm::vec3 lo = previousError + roundingError;
+        newSum = roundedSum + lo;
+        newError = lo - (newSum - roundedSum);
+    }
+
+    error[0] = newError.x;
+    error[1] = newError.y;
+    error[2] = newError.z;
+
+    return newSum;
+}
+
+glm::vec3 CpuRenderer::calculateRayColor(CpuRay ray, CpuSampler &sampler, uint64_t &tracedRays) const {
+    glm::vec3 reflectedColor = glm::vec3(1.0f);
+    glm::vec3 lightSourceColor = glm::vec3(0.0f);
+
+    CpuPayload payload = {};
+
+    for (uint32_t depth = 0; depth < settings.maxDepth; depth++) {
+        const uint32_t bounceDimension = CAMERA_DIMENSIONS + depth * BOUNCE_DIMENSIONS;
+
+        setDimension(sampler, bounceDimension);
+        traceRay(ray, payload, sampler);
+        tracedRays++;
+
+        if (payload.doesScatter) {
+            reflectedColor *= payload.attenuation;
+            ray = {payload.pointOnSphere, glm::normalize(payload.scatterDirection)};
+
+            // RUSSIAN ROULETTE, AS IN shader.rgen
+            if (settings.rouletteDepth > 0 && depth + 1 >= settings.rouletteDepth) {
+                const float survivalProbability = std::min(
+                        std::max(reflectedColor.x, std::max(reflectedColor.y, reflectedColor.z)),
+                        MAX_SURVIVAL_PROBABILITY);
+
+                setDimension(sampler, bounceDimension + ROULETTE_DIMENSION);
+                if (randomFloat(sampler) >= survivalProbability) {
+                    break;
+                }
+
+                reflectedColor /= survivalProbability;
+            }
+
+        } else {
+            // BACKGROUND
+            lightSourceColor = payload.attenuation;
+            break;
+        }
+    }
+
+    return reflectedColor * lightSourceColor;
+}
+
+// shader.rint, shader.rchit & shader.rmiss
+void CpuRenderer::traceRay(const CpuRay &ray, CpuPayload &payload, CpuSampler &sampler) const {
+    SphereHit hit = {.t = MAX_RAY_COLLISION_DISTANCE, .sphereIndex = 0};
+
+    if (!bvh->intersect(ray.origin, ray.direction, 0.001f, hit)) {
+        payload.doesScatter = false;
+        payload.attenuation = glm::vec3(0.7f, 0.8f, 1.0f);
+        payload.scatterDirection = glm::vec3(0.0f);
+        payload.pointOnSphere = glm::vec3(0.0f);
+        return;
+    }
+
+    const Sphere &sphere = scene.spheres[hit.sphereIndex];
+    const glm::vec3 pointOnSphere = ray.origin + hit.t * ray.direction;
+
+    const glm::vec3 outwardNormal = glm::normalize(pointOnSphere - glm::vec3(sphere.geometry));
+    const bool frontFace = glm::dot(ray.direction, outwardNormal) < 0.0f;
+    const glm::vec3 normal = frontFace ? outwardNormal : -outwardNormal;
+
+    payload.attenuation = glm::vec3(getTextureColor(sphere, pointOnSphere));
+    payload.scatterDirection = getScatterDirection(sphere, ray.direction, normal, frontFace, sampler);
+    payload.pointOnSphere = pointOnSphere;
+    payload.doesScatter = payload.scatterDirection != glm::vec3(0.0f);
+}
+
+CpuViewport CpuRenderer::calculateViewport(const float aspectRatio) {
+    const float fov = 25.0f;
+    const float focusDistance = 10.0f;
+    const glm::vec3 lookFrom = glm::vec3(13.0f, 2.0f, -3.0f);
+    const glm::vec3 lookAt = glm::vec3(0.0f);
+    const glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    const float viewportHeight = std::tan(glm::radians(fov) / 2.0f) * 2.0f;
+    const float viewportWidth = aspectRatio * viewportHeight;
+
+    const glm::vec3 cameraForward = glm::normalize(lookAt - lookFrom);
+    const glm::vec3 cameraRight = glm::normalize(glm::cross(up, cameraForward));
+    const glm::vec3 cameraUp = glm::normalize(glm::cross(cameraForward, cameraRight));
+
+    const glm::vec3 horizontal = viewportWidth * cameraRight * focusDistance;
+    const glm::vec3 vertical = viewportHeight * cameraUp * focusDistance;
+    const glm::vec3 upperLeftCorner = lookFrom - horizontal / 2.0f + vertical / 2.0f + cameraForward * focusDistance;
+
+    return {horizontal, vertical, upperLeftCorner, cameraUp, cameraRight};
+}
+
+CpuRay CpuRenderer::getCameraRay(const glm::vec2 &uv, CpuSampler &sampler) const {
+    const float aperture = 0.0f;
+    const glm::vec3 lookFrom = glm::vec3(13.0f, 2.0f, -3.0f);
+
+    const float randomX = randomInInterval(sampler, -1.0f, 1.0f);
+    const float randomY = randomInInterval(sampler, -1.0f, 1.0f);
+    const glm::vec2 random = (aperture / 2.0f) * glm::normalize(glm::vec2(randomX, randomY));
+    const glm::vec3 offset = viewport.cameraRight * random.x + viewport.cameraUp * random.y;
+
+    const glm::vec3 from = lookFrom + offset;
+    const glm::vec3 to = viewport.upperLeftCorner + viewport.horizontal * uv.x - viewport.vertical * uv.y;
+
+    return {from, glm::normalize(to - from)};
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include "renderer.h"
+#include "accumulation_format.h"
+#include "accumulation_precision.h"
+#include "sampler_type.h"
+#include "tone_map_operator.h"
+#include "scene.h"
+#include "bvh.h"
+#include "thread_pool.h"
+
+struct CpuRendererSettings {
+    uint32_t imageWidth, imageHeight;
+    uint32_t tileSize = 32;
+    uint32_t threadCount = 0;
+    uint32_t maxDepth = 50;
+    uint32_t rouletteDepth = 0; // SAME AS VulkanSettings::rouletteDepth
+    float adaptiveThreshold = 0.0f; // SAME AS VulkanSettings::adaptiveThreshold
+    uint32_t adaptiveMinSamples = 16;
+    SamplerType sampler = SAMPLER_RANDOM; // SAME AS VulkanSettings::sampler
+    AccumulationPrecision accumulationPrecision = ACCUMULATION_FP32;
+    AccumulationFormat accumulationFormat = ACCUMULATION_FORMAT_RGBA32F; // SAME AS VulkanSettings::accumulationFormat
+    ToneMapOperator toneMapOperator = TONE_MAP_CLAMP; // OF THE RENDER TARGET OF READBACKS
+};
+
+struct CpuRay {
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// Sampler OF structs.glsl, THE TYPE STANDS IN FOR THE SPECIALIZATION CONSTANT
+struct CpuSampler {
+    SamplerType type;
+    uint32_t seed;
+    uint32_t pixel;
+    uint32_t sampleIndex;
+    uint32_t dimension;
+};
+
+struct CpuPayload {
+    bool doesScatter;
+    glm::vec3 attenuation;
+    glm::vec3 scatterDirection;
+    glm::vec3 pointOnSphere;
+};
+
+struct CpuViewport {
+    glm::vec3 horizontal;
+    glm::vec3 vertical;
+    glm::vec3 upperLeftCorner;
+    glm::vec3 cameraUp;
+    glm::vec3 cameraRight;
+};
+
+// MULTITHREADED CPU PATH TRACER WITH THE SAME SEMANTICS AS THE RAY TRACING SHADERS
+class CpuRenderer : public Renderer {
+public:
+    CpuRenderer(CpuRendererSettings settings, const Scene &scene);
+
+    void update() override;
+
+    void render(const RenderCallInfo &renderCallInfo) override;
+
+    void finish() override;
+
+    void updateScene(std::span<const SceneUpdate> updates) override;
+
+    [[nodiscard]] bool shouldExit() const override;
+
+    void requestReadback() override;
+
+    [[nodiscard]] bool isReadbackPending() const override;
+
+    [[nodiscard]] std::optional<RenderOutput> pollReadback() override;
+
+    [[nodiscard]] RenderOutput waitForReadback() override;
+
+    void setTileCompletedCallback(std::function<void(const TileProgress &)> callback) override;
+
+    [[nodiscard]] uint32_t getTileSize() const override;
+
+    void setRenderCallProfiledCallback(std::function<void(const RenderCallProfile &)> callback) override;
+
+    [[nodiscard]] RendererInfo getRendererInfo() const override;
+
+private:
+    const float MAX_RAY_COLLISION_DISTANCE = 10000.0f;
+    const float MAX_SURVIVAL_PROBABILITY = 0.95f;
+    const uint32_t CAMERA_DIMENSIONS = 4;
+    const uint32_t BOUNCE_DIMENSIONS = 4;
+    const uint32_t ROULETTE_DIMENSION = 3;
+    const glm::vec3 LUMINANCE_WEIGHTS = glm::vec3(0.2126f, 0.7152f, 0.0722f);
+    const float LUMINANCE_OFFSET = 0.01f;
+
+    CpuRendererSettings settings;
+    Scene scene;
+    std::shared_ptr<std::vector<Sphere>> updatedSpheres; // OWNED COPY OF THE SPHERES, TAKEN ON THE FIRST UPDATE
+    ThreadPool threadPool;
+    std::unique_ptr<Bvh> bvh;
+    CpuViewport viewport;
+
+    // RGBA (ALPHA: SAMPLES OF THE PIXEL) OR RGB WITH THE RGB32F FORMAT. THERE IS NO WINDOW, READBACKS RESOLVE THE PREVIEW
+    std::vector<float> summedPixelColor;
+
+    // SAMPLES OF EVERY PIXEL SO FAR, THE SAMPLE COUNT OF THE RGB32F FORMAT
+    uint32_t accumulatedSamples = 0;
+
+    // KAHAN & SPLIT ACCUMULATION: THE COMPENSATION OR lo PART OF THE SUM, RGB PER PIXEL, EMPTY OTHERWISE
+    std::vector<float> summedPixelColorError;
+
+    // FP64 ACCUMULATION: THE DOUBLE TOTAL, RGB PER PIXEL, EMPTY OTHERWISE. summedPixelColor GETS IT ROUNDED TO FLOAT
+    std::vector<double> summedPixelColorFp64;
+
+    // ADAPTIVE SAMPLING: SECOND MOMENT OF THE LUMINANCE PER PIXEL & THE PIXELS OF THE CURRENT RENDER CALL AS
+    // (Y << 16) | X, BOTH EMPTY WITHOUT IT
+    std::vector<float> summedSquaredLuminance;
+    std::vector<uint32_t> activePixels;
+
+    RenderCallInfo lastRenderCallInfo = {};
+    std::optional<RenderOutput> pendingReadback;
+
+    std::mutex tileCompletedMutex;
+    std::function<void(const TileProgress &)> tileCompletedCallback;
+    std::function<void(const RenderCallProfile &)> renderCallProfiledCallback;
+
+    std::vector<StartupStageTiming> startupTimings;
+
+    [[nodiscard]] bool isAdaptiveSampling() const;
+
+    [[nodiscard]] size_t getChannelCount() const;
+
+    [[nodiscard]] uint32_t getAccumulationBytesPerPixel() const;
+
+    // select_active_pixels.comp
+    void selectActivePixels();
+
+    [[nodiscard]] bool isPixelActive(size_t pixel) const;
+
+    [[nodiscard]] uint64_t renderTile(const RenderCallInfo &renderCallInfo, const Tile &tile);
+
+    void renderPixel(const RenderCallInfo &renderCallInfo, uint32_t x, uint32_t y, uint64_t &tracedRays);
+
+    [[nodiscard]] bool hasAccumulationErrorImage() const;
+
+    [[nodiscard]] glm::vec3 accumulate(size_t pixel, const glm::vec3 &sum, const glm::vec3 &partialSum);
+
+    [[nodiscard]] glm::vec3 calculateRayColor(CpuRay ray, CpuSampler &sampler, uint64_t &tracedRays) const;
+
+    void traceRay(const CpuRay &ray, CpuPayload &payload, CpuSampler &sampler) const;
+
+    [[nodiscard]] CpuRay getCameraRay(const glm::vec2 &uv, CpuSampler &sampler) const;
+
+    [[nodiscard]] static CpuViewport calculateViewport(float aspectRatio);
+};
@@ -0,0 +1,118 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+
+#include "image_writer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <stb_image_write.h>
+
+std::string getLowerCaseExtension(const std::string &path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    return extension;
+}
+
+ImageWriter::~ImageWriter() {
+    try {
+        wait();
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[Error] Failed to write an image!" << std::endl;
+    }
+}
+
+void ImageWriter::write(const std::string &path, std::shared_ptr<const RenderOutput> output) {
+    // DROP WRITES THAT ALREADY FINISHED, THEIR ERRORS ARE KEPT FOR wait()
+    std::erase_if(pendingWrites, [this](std::future<void> &pendingWrite) {
+        if (pendingWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        collect(pendingWrite);
+        return true;
+    });
+
+    pendingWrites.push_back(std::async(std::launch::async, [path, output]() {
+        writeImage(path, *output);
+    }));
+}
+
+void ImageWriter::wait() {
+    for (std::future<void> &pendingWrite: pendingWrites) {
+        collect(pendingWrite);
+    }
+
+    pendingWrites.clear();
+
+    if (firstError) {
+        std::rethrow_exception(std::exchange(firstError, nullptr));
+    }
+}
+
+void ImageWriter::collect(std::future<void> &pendingWrite) {
+    try {
+        pendingWrite.get();
+    } catch (...) {
+        if (!firstError) {
+            firstError = std::current_exception();
+        }
+    }
+}
+
+bool ImageWriter::isSupportedPath(const std::string &path) {
+    const std::string extension = getLowerCaseExtension(path);
+    return extension == ".png" || extension == ".hdr";
+}
+
+std::string ImageWriter::getIntermediatePath(const std::string &path, uint32_t sampleCount) {
+    std::filesystem::path intermediatePath(path);
+    intermediatePath.replace_filename(intermediatePath.stem().string() + "_" + std::to_string(sampleCount) +
+                                      intermediatePath.extension().string());
+    return intermediatePath.string();
+}
+
+void ImageWriter::writeImage(const std::string &path, const RenderOutput &output) {
+    const std::string extension = getLowerCaseExtension(path);
+
+    if (extension == ".png") {
+        writePNG(path, output);
+    } else if (extension == ".hdr") {
+        writeHDR(path, output);
+    } else {
+        throw std::runtime_error("[Error] Unsupported image format of '" + path + "'!");
+    }
+}
+
+void ImageWriter::writePNG(const std::string &path, const RenderOutput &output) {
+    const int stride = static_cast<int>(output.width) * 4;
+
+    if (!stbi_write_png(path.c_str(), static_cast<int>(output.width), static_cast<int>(output.height), 4,
+                        output.renderTarget.data(), stride)) {
+        throw std::runtime_error("[Error] Failed to write image to '" + path + "'!");
+    }
+}
+
+void ImageWriter::writeHDR(const std::string &path, const RenderOutput &output) {
+    // LINEAR RADIANCE: AVERAGE OF ALL ACCUMULATED SAMPLES WITHOUT GAMMA CORRECTION. ADAPTIVE SAMPLING GIVES EVERY PIXEL
+    // ITS OWN SAMPLE COUNT
+    const size_t pixelCount = static_cast<size_t>(output.width) * output.height;
+
+    std::vector<float> linearColor(pixelCount * 3);
+    for (size_t i = 0; i < pixelCount; i++) {
+        const float sampleCount = std::max(output.summedPixelColor[i * 4 + 3], 1.0f);
+
+        linearColor[i * 3 + 0] = output.summedPixelColor[i * 4 + 0] / sampleCount;
+        linearColor[i * 3 + 1] = output.summedPixelColor[i * 4 + 1] / sampleCount;
+        linearColor[i * 3 + 2] = output.summedPixelColor[i * 4 + 2] / sampleCount;
+    }
+
+    if (!stbi_write_hdr(path.c_str(), static_cast<int>(output.width), static_cast<int>(output.height), 3,
+                        linearColor.data())) {
+        throw std::runtime_error("[Error] Failed to write image to '" + path + "'!");
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "render_output.h"
+
+class ImageWriter {
+public:
+    // WAITS FOR THE PENDING WRITES, BUT ONLY REPORTS A FAILED ONE. CALL wait() TO HANDLE IT
+    ~ImageWriter();
+
+    void write(const std::string &path, std::shared_ptr<const RenderOutput> output);
+
+    // WAITS FOR EVERY PENDING WRITE, THEN RETHROWS THE FIRST ERROR OF A WRITE SINCE THE LAST CALL
+    void wait();
+
+    [[nodiscard]] static bool isSupportedPath(const std::string &path);
+
+    [[nodiscard]] static std::string getIntermediatePath(const std::string &path, uint32_t sampleCount);
+
+private:
+    std::vector<std::future<void>> pendingWrites;
+    std::exception_ptr firstError;
+
+    void collect(std::future<void> &pendingWrite);
+
+    static void writeImage(const std::string &path, const RenderOutput &output);
+
+    static void writePNG(const std::string &path, const RenderOutput &output);
+
+    static void writeHDR(const std::string &path, const RenderOutput &output);
+};
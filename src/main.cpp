@@ -1,21 +1,182 @@
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
-#include "vulkan.h"
+#include "renderer_factory.h"
+#include "image_writer.h"
+#include "profile_writer.h"
+#include "scene_file.h"
+
+template<typename T>
+void parseNumber(const char* argument, T &value) {
+    std::from_chars(argument, argument + strlen(argument), value);
+}
+
+void writeOutputs(ImageWriter &imageWriter, const std::vector<std::string> &outputPaths, RenderOutput output,
+                  bool intermediate) {
+    auto sharedOutput = std::make_shared<const RenderOutput>(std::move(output));
+
+    for (const std::string &outputPath: outputPaths) {
+        imageWriter.write(
+                intermediate ? ImageWriter::getIntermediatePath(outputPath, sharedOutput->sampleCount) : outputPath,
+                sharedOutput);
+    }
+}
 
 int main(int argc, const char** argv) {
     // COMMAND LINE ARGUMENTS
     uint32_t samples = 10000;
     uint32_t samplesPerRenderCall = 200;
+    bool headless = false;
+    std::vector<std::string> outputPaths;
+    uint32_t outputInterval = 0;
+    uint32_t framesInFlight = 2;
+    uint32_t tileSize = 512;
+    float targetSubmitMilliseconds = 100.0f;
+    bool tileProgress = false;
+    std::string backend = "auto";
+    uint32_t threadCount = 0;
+    std::string profilePath;
+    uint32_t maxDepth = 50;
+    uint32_t rouletteDepth = 0;
+    float adaptiveThreshold = 0.0f;
+    uint32_t adaptiveMinSamples = 16;
+    std::string samplerName = "random";
+    std::string accumulationName = "fp32";
+    std::string accumulationFormatName = "rgba32f";
+    std::string toneMapName = "clamp";
+    uint32_t presentInterval = 1;
+    float presentRate = 0.0f;
+    bool countRays = false;
+    std::string scenePath;
+    SceneGenerationSettings generationSettings = {};
+    bool deviceScene = false;
+    std::string pipelineCachePath = "pipeline_cache.bin";
+    std::string accelerationStructureCacheDirectory;
+
+    std::vector<const char*> positionalArguments;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPaths.emplace_back(argv[++i]);
+        } else if (strcmp(argv[i], "--output-interval") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], outputInterval);
+        } else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], framesInFlight);
+        } else if (strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], tileSize);
+        } else if (strcmp(argv[i], "--target-submit-ms") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], targetSubmitMilliseconds);
+        } else if (strcmp(argv[i], "--tile-progress") == 0) {
+            tileProgress = true;
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], threadCount);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (strcmp(argv[i], "--max-depth") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], maxDepth);
+        } else if (strcmp(argv[i], "--roulette-depth") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], rouletteDepth);
+        } else if (strcmp(argv[i], "--adaptive-threshold") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], adaptiveThreshold);
+        } else if (strcmp(argv[i], "--adaptive-min-samples") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], adaptiveMinSamples);
+        } else if (strcmp(argv[i], "--sampler") == 0 && i + 1 < argc) {
+            samplerName = argv[++i];
+        } else if (strcmp(argv[i], "--accumulation") == 0 && i + 1 < argc) {
+            accumulationName = argv[++i];
+        } else if (strcmp(argv[i], "--accumulation-format") == 0 && i + 1 < argc) {
+            accumulationFormatName = argv[++i];
+        } else if (strcmp(argv[i], "--tone-map") == 0 && i + 1 < argc) {
+            toneMapName = argv[++i];
+        } else if (strcmp(argv[i], "--present-interval") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], presentInterval);
+        } else if (strcmp(argv[i], "--present-rate") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], presentRate);
+        } else if (strcmp(argv[i], "--count-rays") == 0) {
+            countRays = true;
+        } else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scenePath = argv[++i];
+        } else if (strcmp(argv[i], "--spheres") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], generationSettings.sphereAmount);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], generationSettings.seed);
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            parseNumber(argv[++i], generationSettings.patternSize);
+        } else if (strcmp(argv[i], "--device-scene") == 0) {
+            deviceScene = true;
+        } else if (strcmp(argv[i], "--pipeline-cache") == 0 && i + 1 < argc) {
+            pipelineCachePath = argv[++i];
+        } else if (strcmp(argv[i], "--no-pipeline-cache") == 0) {
+            pipelineCachePath.clear();
+        } else if (strcmp(argv[i], "--acceleration-structure-cache") == 0 && i + 1 < argc) {
+            accelerationStructureCacheDirectory = argv[++i];
+        } else {
+            positionalArguments.push_back(argv[i]);
+        }
+    }
+
+    if (positionalArguments.size() >= 1) {
+        parseNumber(positionalArguments[0], samples);
+    }
+
+    if (positionalArguments.size() >= 2) {
+        parseNumber(positionalArguments[1], samplesPerRenderCall);
+    }
+
+    for (const std::string &outputPath: outputPaths) {
+        if (!ImageWriter::isSupportedPath(outputPath)) {
+            std::cerr << "Unsupported output format of '" << outputPath << "' (supported: .png, .hdr)" << std::endl;
+            exit(1);
+        }
+    }
+
+    if (!isSupportedBackend(backend)) {
+        std::cerr << "Unknown backend '" << backend << "' (supported: auto, gpu, cpu)" << std::endl;
+        exit(1);
+    }
 
-    if (argc >= 2) {
-        std::from_chars(argv[1], argv[1] + strlen(argv[1]), samples);
+    const std::optional<SamplerType> sampler = parseSamplerType(samplerName);
+    if (!sampler) {
+        std::cerr << "Unknown sampler '" << samplerName << "' (supported: random, sobol, blue-noise)" << std::endl;
+        exit(1);
     }
 
-    if (argc >= 3) {
-        std::from_chars(argv[2], argv[2] + strlen(argv[2]), samplesPerRenderCall);
+    const std::optional<AccumulationPrecision> accumulationPrecision = parseAccumulationPrecision(accumulationName);
+    if (!accumulationPrecision) {
+        std::cerr << "Unknown accumulation '" << accumulationName << "' (supported: fp64, fp32, kahan, split)"
+            << std::endl;
+        exit(1);
+    }
+
+    const std::optional<AccumulationFormat> accumulationFormat = parseAccumulationFormat(accumulationFormatName);
+    if (!accumulationFormat) {
+        std::cerr << "Unknown accumulation format '" << accumulationFormatName << "' (supported: rgba32f, rgb32f)"
+            << std::endl;
+        exit(1);
+    }
+
+    if (*accumulationFormat == ACCUMULATION_FORMAT_RGB32F && adaptiveThreshold > 0.0f) {
+        std::cerr << "--accumulation-format rgb32f has no sample count per pixel, it cannot be combined with "
+            << "--adaptive-threshold" << std::endl;
+        exit(1);
+    }
+
+    const std::optional<ToneMapOperator> toneMapOperator = parseToneMapOperator(toneMapName);
+    if (!toneMapOperator) {
+        std::cerr << "Unknown tone mapping operator '" << toneMapName << "' (supported: clamp, reinhard, aces)"
+            << std::endl;
+        exit(1);
     }
 
     if (samples % samplesPerRenderCall != 0) {
@@ -24,50 +185,214 @@ int main(int argc, const char** argv) {
         exit(1);
     }
 
+    if (adaptiveThreshold > 0.0f && samples > MAX_ADAPTIVE_SAMPLES) {
+        samples = std::max(MAX_ADAPTIVE_SAMPLES / samplesPerRenderCall, 1u) * samplesPerRenderCall;
+        std::cout << "Adaptive sampling counts samples in a float, 'samples' is capped to " << samples << std::endl;
+    }
+
     // SETUP
-    VulkanSettings settings = { 
-        .windowWidth = 1920, 
-        .windowHeight = 1080 
+    VulkanSettings settings = {
+        .windowWidth = 1920,
+        .windowHeight = 1080,
+        .headless = headless,
+        .framesInFlight = std::max(framesInFlight, 1u),
+        .tileSize = tileSize,
+        .targetSubmitMilliseconds = targetSubmitMilliseconds,
+        .countRays = countRays || !profilePath.empty(),
+        .maxDepth = std::max(maxDepth, 1u),
+        .rouletteDepth = rouletteDepth,
+        .adaptiveThreshold = adaptiveThreshold,
+        .adaptiveMinSamples = adaptiveMinSamples,
+        .sampler = *sampler,
+        .accumulationPrecision = *accumulationPrecision,
+        .accumulationFormat = *accumulationFormat,
+        .toneMapOperator = *toneMapOperator,
+        .presentInterval = std::max(presentInterval, 1u),
+        .presentRate = presentRate,
+        .pipelineCachePath = pipelineCachePath,
+        .accelerationStructureCacheDirectory = accelerationStructureCacheDirectory
     };
 
-    Vulkan vulkan(settings, generateRandomScene());
+    CpuRendererSettings cpuSettings = {
+        .imageWidth = settings.windowWidth,
+        .imageHeight = settings.windowHeight,
+        .threadCount = threadCount,
+        .maxDepth = settings.maxDepth,
+        .rouletteDepth = settings.rouletteDepth,
+        .adaptiveThreshold = settings.adaptiveThreshold,
+        .adaptiveMinSamples = settings.adaptiveMinSamples,
+        .sampler = settings.sampler,
+        .accumulationPrecision = settings.accumulationPrecision,
+        .accumulationFormat = settings.accumulationFormat,
+        .toneMapOperator = settings.toneMapOperator
+    };
+
+    generationSettings.threadCount = threadCount;
+
+    Scene scene;
+    if (!scenePath.empty()) {
+        scene = loadScene(scenePath);
+    } else if (deviceScene) {
+        scene.generation = generationSettings;
+    } else {
+        scene = generateRandomScene(generationSettings);
+    }
+
+    std::unique_ptr<Renderer> renderer = createRenderer(backend, settings, cpuSettings, scene);
+
+    const RendererInfo rendererInfo = renderer->getRendererInfo();
+
+    double startupMilliseconds = 0.0;
+    std::string startupStages;
+    for (const StartupStageTiming &timing: rendererInfo.startupTimings) {
+        startupMilliseconds += timing.milliseconds;
+        startupStages += (startupStages.empty() ? "" : ", ") + timing.stage + " " +
+                         std::to_string(static_cast<int>(timing.milliseconds)) + " ms";
+    }
+
+    std::cout << "Renderer started in " << static_cast<int>(startupMilliseconds) << " ms (" << startupStages << ")"
+        << std::endl;
+    std::cout << "Acceleration structures: " << double(rendererInfo.accelerationStructureMemory) / 1e6 << " MB ("
+        << double(rendererInfo.uncompactedAccelerationStructureMemory) / 1e6 << " MB before compaction), "
+        << rendererInfo.bottomAccelerationStructureCount << " BLASes, " << rendererInfo.instanceCount << " instances"
+        << std::endl;
+    std::cout << "Memory: " << double(rendererInfo.allocatedMemory) / 1e6 << " MB allocated in "
+        << double(rendererInfo.reservedMemory) / 1e6 << " MB (" << rendererInfo.memoryBlockCount << " blocks, "
+        << rendererInfo.dedicatedAllocationCount << " dedicated allocations)";
+    if (rendererInfo.deviceMemoryBudget > 0) {
+        std::cout << ", device usage " << double(rendererInfo.deviceMemoryUsage) / 1e6 << " of "
+            << double(rendererInfo.deviceMemoryBudget) / 1e6 << " MB budget";
+    }
+    std::cout << std::endl;
+    std::cout << "Accumulation " << getAccumulationFormatName(settings.accumulationFormat) << ": "
+        << double(rendererInfo.accumulationMemory) / 1e6 << " MB, " << rendererInfo.accumulationBytesPerPixel
+        << " bytes per sampled pixel & render call" << std::endl;
+    ImageWriter imageWriter;
+
+    std::unique_ptr<ProfileWriter> profileWriter;
+    if (!profilePath.empty()) {
+        profileWriter = std::make_unique<ProfileWriter>(profilePath, renderer->getRendererInfo());
+    }
+
+    auto renderBeginTime = std::chrono::steady_clock::now();
+
+    // TRACED RAYS PER PIXEL SAMPLE ARE THE AVERAGE PATH LENGTH, WHICH RUSSIAN ROULETTE SHORTENS. WITH ADAPTIVE
+    // SAMPLING, THE FIRST RENDER CALL WITHOUT ACTIVE PIXELS MARKS THE TIME TO QUALITY
+    uint64_t profiledSamples = 0, profiledRays = 0;
+    std::optional<uint32_t> convergedRenderCall;
+    int64_t convergedMilliseconds = 0;
+    renderer->setRenderCallProfiledCallback([&](const RenderCallProfile &profile) {
+        profiledSamples += profile.samples;
+        profiledRays += profile.rays;
+
+        if (adaptiveThreshold > 0.0f && profile.activePixels == 0 && !convergedRenderCall) {
+            convergedRenderCall = profile.renderCallNumber;
+            convergedMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - renderBeginTime).count();
+        }
+
+        if (profileWriter) {
+            profileWriter->write(profile);
+        }
+    });
+
+    if (tileProgress) {
+        renderer->setTileCompletedCallback([](const TileProgress &progress) {
+            std::cout << "  Tile " << (progress.tileIndex + 1) << " / " << progress.tileCount
+                << " of render call " << progress.renderCallNumber << " (" << progress.tile.width << " x "
+                << progress.tile.height << ") - Completed after " << progress.milliseconds << " ms" << std::endl;
+        });
+    }
 
     // RENDERING
     std::cout << "Rendering started: " << samples << " samples with "
         << samplesPerRenderCall << " samples per render call" << std::endl;
 
-    auto renderBeginTime = std::chrono::steady_clock::now();
+    renderBeginTime = std::chrono::steady_clock::now();
     int requiredRenderCalls = samples / samplesPerRenderCall;
 
-    for (uint32_t number = 1; number <= requiredRenderCalls; number++) {
+    // WITH ADAPTIVE SAMPLING, samples IS THE LIMIT PER PIXEL. RENDERING STOPS ONCE EVERY PIXEL HAS CONVERGED
+    for (uint32_t number = 1; number <= requiredRenderCalls && !convergedRenderCall; number++) {
         RenderCallInfo renderCallInfo = {
             .number = number,
             .samplesPerRenderCall = samplesPerRenderCall,
         };
 
-        std::cout << "Render call " << number << " / " << requiredRenderCalls
-            << " (" << (number * samplesPerRenderCall) << " / " << samples
-            << " samples)";
-
+        // ONLY BLOCKS ONCE ALL FRAMES ARE IN FLIGHT, SO THIS MEASURES THE GPU THROUGHPUT IN THE STEADY STATE
         auto renderCallBeginTime = std::chrono::steady_clock::now();
 
-        vulkan.render(renderCallInfo);
+        renderer->render(renderCallInfo);
 
         auto renderCallTime = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now() - renderCallBeginTime).count();
-        std::cout << " - Completed in " << renderCallTime << " ms" << std::endl;
+        std::cout << "Render call " << number << " / " << requiredRenderCalls
+            << " (" << (number * samplesPerRenderCall) << " / " << samples
+            << " samples) - Submitted in " << renderCallTime << " ms (tile size " << renderer->getTileSize() << ")"
+            << std::endl;
+
+        // INTERMEDIATE OUTPUTS: THE READBACK IS COLLECTED ONCE IT HAS FINISHED ON THE GPU
+        if (std::optional<RenderOutput> output = renderer->pollReadback()) {
+            writeOutputs(imageWriter, outputPaths, std::move(*output), true);
+        }
 
-        vulkan.update();
+        if (!outputPaths.empty() && outputInterval > 0 && number % outputInterval == 0 &&
+            number != requiredRenderCalls && !renderer->isReadbackPending()) {
+            renderer->requestReadback();
+        }
+
+        renderer->update();
     }
 
+    renderer->finish();
+
     auto renderTime = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - renderBeginTime).count();
     std::cout << "Rendering completed: " << samples << " samples rendered in "
-        << renderTime << " ms" << std::endl << std::endl;
+        << renderTime << " ms" << std::endl;
+    if (adaptiveThreshold > 0.0f) {
+        const double fullSamples = double(settings.windowWidth) * settings.windowHeight * samples;
+
+        if (convergedRenderCall) {
+            std::cout << "Converged to a relative error of " << adaptiveThreshold << " after " << convergedMilliseconds
+                << " ms (render call " << *convergedRenderCall << ")";
+        } else {
+            std::cout << "Not converged to a relative error of " << adaptiveThreshold << " within " << samples
+                << " samples";
+        }
+
+        std::cout << ", " << double(profiledSamples) / fullSamples * 100.0 << " % of the samples of a full render"
+            << std::endl;
+    }
+    if (profiledRays > 0) {
+        std::cout << "Average path length: " << double(profiledRays) / double(profiledSamples)
+            << " rays per sample (max depth " << settings.maxDepth << ", roulette "
+            << (settings.rouletteDepth > 0 ? "after depth " + std::to_string(settings.rouletteDepth) : "off") << ")"
+            << std::endl;
+    }
+    std::cout << std::endl;
+
+    // OUTPUT
+    if (!outputPaths.empty()) {
+        if (renderer->isReadbackPending()) {
+            writeOutputs(imageWriter, outputPaths, renderer->waitForReadback(), true);
+        }
+
+        renderer->requestReadback();
+        writeOutputs(imageWriter, outputPaths, renderer->waitForReadback(), false);
+        imageWriter.wait();
+
+        for (const std::string &outputPath: outputPaths) {
+            std::cout << "Written " << outputPath << std::endl;
+        }
+    }
+
+    if (headless) {
+        return 0;
+    }
 
     // WINDOW
-    while (!vulkan.shouldExit()) {
-        vulkan.update();
+    while (!renderer->shouldExit()) {
+        renderer->update();
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
 }
@@ -0,0 +1,96 @@
+#include "mapped_file.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path) {
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("[Error] Failed to open '" + path + "'!");
+    }
+
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(fileHandle, &fileSize);
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    if (size == 0) {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("[Error] '" + path + "' is empty!");
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("[Error] Failed to map '" + path + "'!");
+    }
+
+    data = static_cast<const std::byte*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw std::runtime_error("[Error] Failed to map '" + path + "'!");
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+    const int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("[Error] Failed to open '" + path + "'!");
+    }
+
+    struct stat fileStatus = {};
+    fstat(fileDescriptor, &fileStatus);
+    size = static_cast<size_t>(fileStatus.st_size);
+
+    if (size == 0) {
+        close(fileDescriptor);
+        throw std::runtime_error("[Error] '" + path + "' is empty!");
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+    // THE MAPPING KEEPS ITS OWN REFERENCE TO THE FILE
+    close(fileDescriptor);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("[Error] Failed to map '" + path + "'!");
+    }
+
+    // THE FILE IS READ FRONT TO BACK BY THE UPLOAD, SO LET THE KERNEL READ AHEAD AGGRESSIVELY
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    data = static_cast<const std::byte*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<std::byte*>(data), size);
+}
+
+#endif
+
+const std::byte* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
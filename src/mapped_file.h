@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// READ-ONLY MEMORY MAPPING OF A WHOLE FILE, PAGES ARE ONLY READ FROM DISK WHEN THEY ARE FIRST TOUCHED
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] const std::byte* getData() const;
+
+    [[nodiscard]] size_t getSize() const;
+
+private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,62 @@
+#include "profile_writer.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+ProfileWriter::ProfileWriter(const std::string &path, RendererInfo rendererInfo) :
+        rendererInfo(std::move(rendererInfo)), stream(&std::cout) {
+
+    if (path != "-") {
+        file.open(path, std::ios::out | std::ios::trunc);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("[Error] Failed to open profile file at '" + path + "'!");
+        }
+
+        stream = &file;
+    }
+}
+
+void ProfileWriter::write(const RenderCallProfile &profile) {
+    const double seconds = profile.milliseconds / 1000.0;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(4)
+         << "{\"backend\":\"" << escapeJSON(rendererInfo.backend) << "\""
+         << ",\"device\":\"" << escapeJSON(rendererInfo.deviceName) << "\""
+         << ",\"driver\":\"" << escapeJSON(rendererInfo.driverVersion) << "\""
+         << ",\"width\":" << rendererInfo.imageWidth
+         << ",\"height\":" << rendererInfo.imageHeight
+         << ",\"renderCall\":" << profile.renderCallNumber
+         << ",\"tiles\":" << profile.tileCount
+         << ",\"samplesPerPixel\":" << profile.samplesPerRenderCall
+         << ",\"samples\":" << profile.samples
+         << ",\"rays\":" << profile.rays
+         << ",\"activePixels\":" << profile.activePixels
+         << ",\"gpuMilliseconds\":" << profile.milliseconds
+         << ",\"barrierMilliseconds\":" << profile.barrierMilliseconds
+         << ",\"traceRaysMilliseconds\":" << profile.traceRaysMilliseconds
+         << ",\"copyMilliseconds\":" << profile.copyMilliseconds
+         << ",\"samplesPerSecond\":" << (seconds > 0.0 ? double(profile.samples) / seconds : 0.0)
+         << ",\"megaRaysPerSecond\":" << (seconds > 0.0 ? double(profile.rays) / seconds / 1e6 : 0.0)
+         << "}";
+
+    *stream << line.str() << std::endl;
+}
+
+std::string ProfileWriter::escapeJSON(const std::string &value) {
+    std::ostringstream escaped;
+
+    for (const char c: value) {
+        if (c == '"' || c == '\\') {
+            escaped << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c);
+        } else {
+            escaped << c;
+        }
+    }
+
+    return escaped.str();
+}
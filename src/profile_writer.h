@@ -0,0 +1,20 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include "render_call_profile.h"
+
+// WRITES ONE JSON OBJECT PER RENDER CALL (JSON LINES), "-" WRITES TO STDOUT
+class ProfileWriter {
+public:
+    ProfileWriter(const std::string &path, RendererInfo rendererInfo);
+
+    void write(const RenderCallProfile &profile);
+
+    [[nodiscard]] static std::string escapeJSON(const std::string &value);
+
+private:
+    RendererInfo rendererInfo;
+    std::ofstream file;
+    std::ostream* stream;
+};
@@ -2,7 +2,22 @@
 
 #include <memory>
 
+// ACTIVE PIXELS & SAMPLER SEEDS PACK A PIXEL AS (y << 16) | x
+const uint32_t MAX_IMAGE_EXTENT = 65535;
+
+// THE SAMPLE COUNT OF A PIXEL IS A FLOAT (THE ALPHA OF THE SUMMED PIXEL COLOR), WHICH IS ONLY EXACT UP TO 2^24.
+// ADAPTIVE SAMPLING COMPARES IT, SO IT CANNOT SAMPLE A PIXEL MORE OFTEN
+const uint32_t MAX_ADAPTIVE_SAMPLES = 1u << 24;
+
 struct RenderCallInfo {
     uint32_t number;
     uint32_t samplesPerRenderCall;
 };
+
+struct RenderCallPushConstants {
+    RenderCallInfo renderCallInfo;
+    uint32_t tileOffsetX;
+    uint32_t tileOffsetY;
+    uint32_t activePixelOffset; // FIRST ENTRY OF THE ACTIVE PIXEL LIST THE TILE SAMPLES, ONLY USED BY ADAPTIVE SAMPLING
+    uint32_t firstSample; // SAMPLES OF EVERY PIXEL BEFORE THE RENDER CALL, ONLY USED BY THE RGB32F ACCUMULATION FORMAT
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RenderCallProfile {
+    uint32_t renderCallNumber;
+    uint32_t tileCount;
+    uint32_t samplesPerRenderCall;
+
+    // PIXEL SAMPLES (PIXELS * SAMPLES PER PIXEL) & TRACED RAYS, rays IS 0 IF RAYS ARE NOT COUNTED
+    uint64_t samples;
+    uint64_t rays;
+
+    // PIXELS SAMPLED BY THE RENDER CALL, ALL OF THEM WITHOUT ADAPTIVE SAMPLING. 0 ONCE EVERY PIXEL HAS CONVERGED
+    uint64_t activePixels;
+
+    // DEVICE TIME OF ALL TILES (TRACE RAYS + THE RESOLVE & COPY OF A PRESENT). THE BARRIER TIME IS SPENT WAITING FOR
+    // EARLIER WORK ON THE QUEUE
+    double milliseconds;
+    double barrierMilliseconds;
+    double traceRaysMilliseconds;
+    double copyMilliseconds;
+};
+
+struct StartupStageTiming {
+    std::string stage;
+    double milliseconds;
+};
+
+struct RendererInfo {
+    std::string backend;
+    std::string deviceName;
+    std::string driverVersion;
+    uint32_t imageWidth, imageHeight;
+
+    // CONSTRUCTOR STAGES IN EXECUTION ORDER & THE MEMORY THE RENDERER ALLOCATED FOR ITS RESOURCES
+    std::vector<StartupStageTiming> startupTimings;
+    uint64_t allocatedMemory;
+
+    // DEVICE MEMORY THE ALLOCATIONS ARE SUBALLOCATED FROM, ITS BLOCKS & ALLOCATIONS OF THEIR OWN, AND THE SHARE OF THE
+    // FREE BLOCK MEMORY OUTSIDE THE LARGEST FREE RANGE OF EACH BLOCK. THE CPU BACKEND ONLY HAS HOST ALLOCATIONS
+    uint64_t reservedMemory;
+    uint32_t memoryBlockCount;
+    uint32_t dedicatedAllocationCount;
+    double memoryFragmentation;
+
+    // DEVICE LOCAL MEMORY USED BY THE PROCESS & ITS BUDGET, 0 WITHOUT VK_EXT_memory_budget
+    uint64_t deviceMemoryUsage;
+    uint64_t deviceMemoryBudget;
+
+    // BYTES OF THE INITIAL SCENE UPLOAD & ITS DURATION INCLUDING THE COPIES, 0 WHEN THE SCENE IS GENERATED ON THE DEVICE
+    // OR THE BACKEND RENDERS FROM HOST MEMORY
+    uint64_t sceneUploadBytes;
+    double sceneUploadMilliseconds;
+
+    // SIZE OF THE ACCELERATION STRUCTURES IN USE & WHAT THEY WOULD TAKE WITHOUT COMPACTION
+    uint64_t accelerationStructureMemory;
+    uint64_t uncompactedAccelerationStructureMemory;
+
+    // BOTTOM LEVEL STRUCTURES & THEIR TOP LEVEL INSTANCES, THE CPU BACKEND HAS A SINGLE BVH
+    uint32_t bottomAccelerationStructureCount;
+    uint32_t instanceCount;
+
+    // HIT GROUPS IN THE SHADER BINDING TABLE, 0 FOR THE CPU BACKEND
+    uint32_t hitGroupCount;
+
+    // ACCUMULATION & PREVIEW IMAGES, AND THE BYTES A SAMPLED PIXEL LOADS & STORES IN THE ACCUMULATION IMAGES PER RENDER
+    // CALL. THE PREVIEW IS ONLY RESOLVED WHEN IT IS PRESENTED
+    uint64_t accumulationMemory;
+    uint32_t accumulationBytesPerPixel;
+};
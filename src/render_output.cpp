@@ -0,0 +1,34 @@
+#include "render_output.h"
+#include <algorithm>
+#include <cmath>
+
+float toneMap(float color, ToneMapOperator toneMapOperator) {
+    color = std::max(color, 0.0f);
+
+    if (toneMapOperator == TONE_MAP_REINHARD) {
+        color = color / (1.0f + color);
+    } else if (toneMapOperator == TONE_MAP_ACES) {
+        color = color * (2.51f * color + 0.03f) / (color * (2.43f * color + 0.59f) + 0.14f);
+    }
+
+    return std::sqrt(std::clamp(color, 0.0f, 1.0f));
+}
+
+std::vector<uint8_t> resolveRenderTarget(const std::vector<float> &summedPixelColor, ToneMapOperator toneMapOperator) {
+    const size_t pixelCount = summedPixelColor.size() / 4;
+    std::vector<uint8_t> renderTarget(pixelCount * 4, 0);
+
+    for (size_t pixel = 0; pixel < pixelCount; pixel++) {
+        const float sampleCount = summedPixelColor[pixel * 4 + 3];
+
+        // RGBA8 UNORM CONVERSION OF THE RESOLVED COLOR
+        for (size_t channel = 0; channel < 3 && sampleCount > 0.0f; channel++) {
+            const float pixelColor = toneMap(summedPixelColor[pixel * 4 + channel] / sampleCount, toneMapOperator);
+            renderTarget[pixel * 4 + channel] = static_cast<uint8_t>(std::lround(pixelColor * 255.0f));
+        }
+
+        renderTarget[pixel * 4 + 3] = 255;
+    }
+
+    return renderTarget;
+}
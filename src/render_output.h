@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "tone_map_operator.h"
+
+struct RenderOutput {
+    uint32_t width;
+    uint32_t height;
+    uint32_t sampleCount; // SAMPLES OF A PIXEL THAT WAS SAMPLED IN EVERY RENDER CALL
+    std::vector<uint8_t> renderTarget;
+    std::vector<float> summedPixelColor; // RGBA, ALPHA HOLDS THE PIXEL'S OWN SAMPLE COUNT
+    std::vector<double> summedPixelColorFp64; // RGB, THE DOUBLE TOTAL OF FP64 ACCUMULATION. EMPTY FOR THE OTHERS
+};
+
+// MEAN PIXEL COLOR -> TONE MAPPED & GAMMA 2 ENCODED COLOR IN [0, 1], THE CONVERSION OF resolve.comp
+float toneMap(float color, ToneMapOperator toneMapOperator);
+
+// RGBA8 PREVIEW OF THE SUMMED PIXEL COLORS. READBACKS RESOLVE IT ON THE HOST, SO THE RENDERERS ONLY RESOLVE A PREVIEW
+// WHEN THEY PRESENT ONE
+std::vector<uint8_t> resolveRenderTarget(const std::vector<float> &summedPixelColor, ToneMapOperator toneMapOperator);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include "render_call_info.h"
+#include "render_call_profile.h"
+#include "render_output.h"
+#include "scene.h"
+#include "tile_scheduler.h"
+
+class Renderer {
+public:
+    virtual ~Renderer() = default;
+
+    virtual void update() = 0;
+
+    virtual void render(const RenderCallInfo &renderCallInfo) = 0;
+
+    virtual void finish() = 0;
+
+    [[nodiscard]] virtual bool shouldExit() const = 0;
+
+    virtual void requestReadback() = 0;
+
+    [[nodiscard]] virtual bool isReadbackPending() const = 0;
+
+    [[nodiscard]] virtual std::optional<RenderOutput> pollReadback() = 0;
+
+    [[nodiscard]] virtual RenderOutput waitForReadback() = 0;
+
+    virtual void setTileCompletedCallback(std::function<void(const TileProgress &)> callback) = 0;
+
+    [[nodiscard]] virtual uint32_t getTileSize() const = 0;
+
+    // CALLED ONCE ALL TILES OF A RENDER CALL HAVE COMPLETED, IN RENDER CALL ORDER
+    virtual void setRenderCallProfiledCallback(std::function<void(const RenderCallProfile &)> callback) = 0;
+
+    [[nodiscard]] virtual RendererInfo getRendererInfo() const = 0;
+
+    // REPLACES SPHERES OF THE SCENE THE RENDERER WAS CREATED WITH, AFTER ALL SUBMITTED RENDER CALLS HAVE FINISHED.
+    // SAMPLES ACCUMULATED BEFORE STAY IN THE IMAGE, SO THE CALLER STARTS A NEW ACCUMULATION
+    virtual void updateScene(std::span<const SceneUpdate> updates) = 0;
+};
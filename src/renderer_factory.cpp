@@ -0,0 +1,27 @@
+#include "renderer_factory.h"
+#include <iostream>
+#include "vulkan.h"
+
+bool isSupportedBackend(const std::string &backend) {
+    return backend == "auto" || backend == "gpu" || backend == "cpu";
+}
+
+std::unique_ptr<Renderer> createRenderer(const std::string &backend, const VulkanSettings &settings,
+                                         const CpuRendererSettings &cpuSettings, const Scene &scene) {
+    if (backend == "cpu") {
+        return std::make_unique<CpuRenderer>(cpuSettings, scene);
+    }
+
+    if (backend == "gpu") {
+        return std::make_unique<Vulkan>(settings, scene);
+    }
+
+    // AUTO: FALL BACK TO THE CPU IF THERE IS NO RAY TRACING CAPABLE GPU
+    try {
+        return std::make_unique<Vulkan>(settings, scene);
+    } catch (const std::exception &exception) {
+        std::cerr << "GPU backend unavailable (" << exception.what() << "), falling back to the CPU backend"
+            << std::endl;
+        return std::make_unique<CpuRenderer>(cpuSettings, scene);
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "renderer.h"
+#include "vulkan_settings.h"
+#include "cpu_renderer.h"
+#include "scene.h"
+
+// BACKEND IS "gpu", "cpu" OR "auto" (GPU WITH A FALLBACK TO THE CPU IF NO RAY TRACING CAPABLE GPU IS AVAILABLE)
+[[nodiscard]] bool isSupportedBackend(const std::string &backend);
+
+[[nodiscard]] std::unique_ptr<Renderer> createRenderer(const std::string &backend, const VulkanSettings &settings,
+                                                       const CpuRendererSettings &cpuSettings, const Scene &scene);
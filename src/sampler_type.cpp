@@ -0,0 +1,29 @@
+#include "sampler_type.h"
+
+std::optional<SamplerType> parseSamplerType(const std::string &name) {
+    if (name == "random") {
+        return SAMPLER_RANDOM;
+    }
+
+    if (name == "sobol") {
+        return SAMPLER_SOBOL;
+    }
+
+    if (name == "blue-noise") {
+        return SAMPLER_BLUE_NOISE;
+    }
+
+    return std::nullopt;
+}
+
+std::string getSamplerTypeName(SamplerType samplerType) {
+    if (samplerType == SAMPLER_SOBOL) {
+        return "sobol";
+    }
+
+    if (samplerType == SAMPLER_BLUE_NOISE) {
+        return "blue-noise";
+    }
+
+    return "random";
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// SAMPLERS OF random.glsl, THE VALUES OF ITS SAMPLER SPECIALIZATION CONSTANT
+enum SamplerType {
+    SAMPLER_RANDOM = 0,    // TEA SEEDED LCG, ONE STREAM PER PIXEL & RENDER CALL
+    SAMPLER_SOBOL = 1,     // OWEN SCRAMBLED SOBOL, SHUFFLED & SCRAMBLED PER PIXEL
+    SAMPLER_BLUE_NOISE = 2 // ONE OWEN SCRAMBLED SOBOL SEQUENCE, ROTATED PER PIXEL BY A SCREEN SPACE NOISE MASK
+};
+
+// COMMAND LINE NAMES: random, sobol, blue-noise
+std::optional<SamplerType> parseSamplerType(const std::string &name);
+
+std::string getSamplerTypeName(SamplerType samplerType);
@@ -1,20 +1,24 @@
 #include "scene.h"
-#include <random>
-
-float randomFloat(float min, float max) {
-    std::random_device rd;
-    std::mt19937 engine(rd());
-    std::uniform_real_distribution<float> distribution(min, max);
-    return distribution(engine);
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+// PCG HASH (JARZYNSKI & OLANO, "HASH FUNCTIONS FOR GPU RENDERING")
+uint32_t hashScene(uint32_t value) {
+    const uint32_t state = value * 747796405u + 2891336453u;
+    const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
 }
 
-float randomFloat() {
-    return randomFloat(0.0f, 1.0f);
+float getSceneRandomFloat(uint32_t seed, uint32_t cell, uint32_t counter) {
+    return float(hashScene(hashScene(hashScene(seed) ^ cell) + counter) >> 8) * (1.0f / 16777216.0f);
 }
 
 // https://www.codespeedy.com/hsv-to-rgb-in-cpp/
-glm::vec4 getRandomColor() {
-    float h = std::floor(randomFloat(0.0f, 360.0f));
+glm::vec4 getColorFromHue(float h) {
     float s = 0.75f, v = 0.45f;
 
     float C = s * v;
@@ -40,10 +44,81 @@ glm::vec4 getRandomColor() {
     return {r + m, g + m, b + m, 1.0f};
 }
 
-Scene generateRandomScene() {
-    Scene scene = {};
+uint32_t getSceneGridSize(const SceneGenerationSettings &settings) {
+    if (settings.sphereAmount < 4) {
+        throw std::runtime_error("Sphere amount " + std::to_string(settings.sphereAmount) + " is less than 4!");
+    }
+
+    const uint64_t cellCount = settings.sphereAmount - 4;
+
+    if (settings.gridSize == 0) {
+        auto gridSize = static_cast<uint64_t>(std::sqrt(double(cellCount)));
+        while (gridSize * gridSize < cellCount) {
+            gridSize++;
+        }
+
+        return static_cast<uint32_t>(gridSize);
+    }
+
+    if (uint64_t(settings.gridSize) * settings.gridSize < cellCount) {
+        throw std::runtime_error("A " + std::to_string(settings.gridSize) + " x " +
+                                 std::to_string(settings.gridSize) + " grid cannot hold " +
+                                 std::to_string(cellCount) + " small spheres!");
+    }
+
+    return settings.gridSize;
+}
+
+// CELLS ARE FILLED ROW BY ROW, COUNTER 0 & 1 JITTER THE POSITION, 2 PICKS THE MATERIAL, 3 - 5 PICK THE COLOR
+Sphere generateGridSphere(const SceneGenerationSettings &settings, uint32_t gridSize, uint32_t cell) {
+    const int gridBegin = -static_cast<int>(gridSize / 2);
+    const int a = gridBegin + static_cast<int>(cell / gridSize);
+    const int b = gridBegin + static_cast<int>(cell % gridSize);
+
+    // FLOOR MODULO, SO THE PATTERN REPEATS FROM THE ORIGIN IN EVERY DIRECTION
+    const auto pattern = static_cast<int>(settings.patternSize);
+    const uint32_t randomCell = pattern == 0 ? cell : static_cast<uint32_t>(
+            ((a % pattern + pattern) % pattern) * pattern + (b % pattern + pattern) % pattern);
+
+    const auto random = [&settings, randomCell](uint32_t counter) {
+        return getSceneRandomFloat(settings.seed, randomCell, counter);
+    };
+
+    Sphere sphere = {};
+    sphere.geometry = glm::vec4(float(a) + 0.9f * random(0), 0.2f, float(b) + 0.9f * random(1), 0.2f);
+
+    const float materialProbability = random(2);
 
-    scene.spheres[0] = {
+    if (materialProbability < settings.diffuseProbability) {
+        sphere.materialType = MaterialType::DIFFUSE;
+        sphere.textureType = TextureType::SOLID;
+        sphere.colors[0] = getColorFromHue(std::floor(360.0f * random(3)));
+        sphere.materialSpecificAttribute = 0.0f;
+
+    } else if (materialProbability < settings.diffuseProbability + settings.metalProbability) {
+        sphere.materialType = MaterialType::METAL;
+        sphere.textureType = TextureType::SOLID;
+        sphere.colors[0] = glm::vec4(0.5f + 0.5f * random(3), 0.5f + 0.5f * random(4), 0.5f + 0.5f * random(5),
+                                     1.0f);
+        sphere.materialSpecificAttribute = 0.0f;
+
+    } else {
+        sphere.materialType = MaterialType::REFRACTIVE;
+        sphere.textureType = TextureType::SOLID;
+        sphere.colors[0] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+        sphere.materialSpecificAttribute = 1.5f;
+    }
+
+    return sphere;
+}
+
+Scene generateRandomScene(const SceneGenerationSettings &settings) {
+    const uint32_t gridSize = getSceneGridSize(settings);
+
+    auto storage = std::make_shared<std::vector<Sphere>>(settings.sphereAmount);
+    std::vector<Sphere> &spheres = *storage;
+
+    spheres[0] = {
             .geometry = glm::vec4(0.0f, -1000.0f, 1.0f, 1000.0f),
             .materialType = MaterialType::DIFFUSE,
             .textureType = TextureType::CHECKERED,
@@ -51,7 +126,7 @@ Scene generateRandomScene() {
             .materialSpecificAttribute = 0.0f
     };
 
-    scene.spheres[1] = {
+    spheres[1] = {
             .geometry = glm::vec4(-4.0f, 1.0f, 0.0f, 1.0f),
             .materialType = MaterialType::DIFFUSE,
             .textureType = TextureType::SOLID,
@@ -59,7 +134,7 @@ Scene generateRandomScene() {
             .materialSpecificAttribute = 0.0f
     };
 
-    scene.spheres[2] = {
+    spheres[2] = {
             .geometry = glm::vec4(4.0f, 1.0f, 0.0f, 1.0f),
             .materialType = MaterialType::METAL,
             .textureType = TextureType::SOLID,
@@ -67,7 +142,7 @@ Scene generateRandomScene() {
             .materialSpecificAttribute = 0.0f
     };
 
-    scene.spheres[3] = {
+    spheres[3] = {
             .geometry = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f),
             .materialType = MaterialType::REFRACTIVE,
             .textureType = TextureType::SOLID,
@@ -75,39 +150,28 @@ Scene generateRandomScene() {
             .materialSpecificAttribute = 1.5f
     };
 
-    uint32_t sphereIndex = 4;
-
-    for (int a = -11; a < 11; a++) {
-        for (int b = -11; b < 11; b++) {
-            scene.spheres[sphereIndex].geometry =
-                    glm::vec4(float(a) + 0.9f * randomFloat(), 0.2f, float(b) + 0.9f * randomFloat(), 0.2f);
-
-            const float materialProbability = randomFloat();
-
-            if (materialProbability < 0.7) {
-                scene.spheres[sphereIndex].materialType = MaterialType::DIFFUSE;
-                scene.spheres[sphereIndex].textureType = TextureType::SOLID;
-                scene.spheres[sphereIndex].colors[0] = getRandomColor();
-                scene.spheres[sphereIndex].materialSpecificAttribute = 0.0f;
+    // SMALL SPHERES: CHUNKS OF CELLS IN PARALLEL, A POOL IS ONLY WORTH STARTING FOR LARGE SCENES
+    const uint32_t cellCount = settings.sphereAmount - 4;
+    const uint32_t cellsPerChunk = 1 << 14;
+    const uint32_t chunkCount = (cellCount + cellsPerChunk - 1) / cellsPerChunk;
 
-            } else if (materialProbability < 0.85) {
-                scene.spheres[sphereIndex].materialType = MaterialType::METAL;
-                scene.spheres[sphereIndex].textureType = TextureType::SOLID;
-                scene.spheres[sphereIndex].colors[0] = glm::vec4(randomFloat(0.5f, 1.0f), randomFloat(0.5f, 1.0f),
-                                                                 randomFloat(0.5f, 1.0f), 1.0f);
-                scene.spheres[sphereIndex].materialSpecificAttribute = 0.0f;
+    const auto generateChunk = [&](uint32_t chunk) {
+        const uint32_t end = std::min(cellCount, (chunk + 1) * cellsPerChunk);
 
-            } else {
-                scene.spheres[sphereIndex].materialType = MaterialType::REFRACTIVE;
-                scene.spheres[sphereIndex].textureType = TextureType::SOLID;
-                scene.spheres[sphereIndex].colors[0] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-                scene.spheres[sphereIndex].materialSpecificAttribute = 1.5f;
-            }
-
-            sphereIndex++;
+        for (uint32_t cell = chunk * cellsPerChunk; cell < end; cell++) {
+            spheres[4 + cell] = generateGridSphere(settings, gridSize, cell);
         }
+    };
+
+    if (chunkCount > 1) {
+        ThreadPool threadPool(settings.threadCount);
+        threadPool.parallelFor(chunkCount, generateChunk);
+    } else if (chunkCount == 1) {
+        generateChunk(0);
     }
 
-    scene.sphereAmount = sphereIndex;
-    return scene;
+    return {
+            .spheres = spheres,
+            .storage = storage
+    };
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <span>
 #include <glm/glm.hpp>
 
 enum MaterialType {
@@ -21,12 +24,50 @@ struct Sphere {
     alignas(4) float materialSpecificAttribute;
 };
 
-const uint32_t MAX_SPHERE_AMOUNT = 512;
+const uint32_t DEFAULT_SPHERE_AMOUNT = 488;
 
+struct SceneGenerationSettings {
+    uint32_t sphereAmount = DEFAULT_SPHERE_AMOUNT;
+    uint32_t seed = 0;
+
+    // EDGE LENGTH OF THE SQUARE GRID OF SMALL SPHERES, 0 FOR THE SMALLEST GRID THAT FITS ALL SPHERES
+    uint32_t gridSize = 0;
+
+    // MATERIAL MIX OF THE SMALL SPHERES, THE REMAINING ONES ARE REFRACTIVE
+    float diffuseProbability = 0.7f;
+    float metalProbability = 0.15f;
+
+    // CELLS patternSize APART SHARE THEIR SPHERE, SO THE GRID REPEATS & ITS CLUSTERS CAN BE INSTANCED. 0 FOR NO PATTERN
+    uint32_t patternSize = 0;
+
+    // CPU GENERATION ONLY, 0 FOR ALL HARDWARE THREADS
+    uint32_t threadCount = 0;
+};
+
+// UPLOADED AS IS INTO A STD430 STORAGE BUFFER, sizeof(Sphere) MATCHES THE GLSL ARRAY STRIDE.
+// THE SPHERES EITHER LIVE IN A VECTOR OR IN A MEMORY-MAPPED SCENE FILE, storage KEEPS THEM ALIVE AND MAKES
+// COPIES OF A SCENE CHEAP. IF generation IS SET, spheres IS EMPTY AND THE RENDERER GENERATES THE SCENE ITSELF
+// (THE GPU BACKEND WITH A COMPUTE SHADER, STRAIGHT INTO ITS SPHERE & AABB BUFFERS)
 struct Scene {
-    alignas(64) Sphere spheres[MAX_SPHERE_AMOUNT];
-    alignas(4) uint32_t sphereAmount;
+    std::span<const Sphere> spheres;
+    std::shared_ptr<const void> storage;
+    std::optional<SceneGenerationSettings> generation;
 };
 
+// REPLACES spheres.size() SPHERES OF A SCENE, STARTING AT firstSphere
+struct SceneUpdate {
+    uint32_t firstSphere;
+    std::span<const Sphere> spheres;
+};
+
+
+// THE 4 LARGE SPHERES, FOLLOWED BY SMALL SPHERES ON A SQUARE GRID AROUND THE ORIGIN (22 x 22 FOR THE DEFAULT).
+// EVERY GRID CELL ONLY DEPENDS ON THE SEED & ITS INDEX, SO THE SAME SETTINGS ALWAYS GENERATE THE SAME SCENE
+Scene generateRandomScene(const SceneGenerationSettings &settings = {});
+
+[[nodiscard]] uint32_t getSceneGridSize(const SceneGenerationSettings &settings);
+
+// COUNTER-BASED RANDOM NUMBER IN [0, 1), KEEP IN SYNC WITH shaders/generate_scene.comp
+[[nodiscard]] float getSceneRandomFloat(uint32_t seed, uint32_t cell, uint32_t counter);
 
-Scene generateRandomScene();
+[[nodiscard]] Sphere generateGridSphere(const SceneGenerationSettings &settings, uint32_t gridSize, uint32_t cell);
@@ -0,0 +1,257 @@
+#include "scene_file.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "mapped_file.h"
+
+bool isBinaryScenePath(const std::string &path) {
+    return std::filesystem::path(path).extension() == ".rtscene";
+}
+
+Scene loadScene(const std::string &path) {
+    return isBinaryScenePath(path) ? loadBinaryScene(path) : loadTextScene(path);
+}
+
+// BINARY
+Scene loadBinaryScene(const std::string &path) {
+    // THE SPHERES ARE MAPPED AS THEY ARE, SO THE FILE'S BYTE ORDER HAS TO BE THE HOST'S
+    if (std::endian::native != std::endian::little) {
+        throw std::runtime_error("[Error] Binary scene files can only be loaded on little endian hosts!");
+    }
+
+    auto file = std::make_shared<MappedFile>(path);
+
+    if (file->getSize() < sizeof(SceneFileHeader)) {
+        throw std::runtime_error("[Error] '" + path + "' is too small to be a scene file!");
+    }
+
+    SceneFileHeader header = {};
+    memcpy(&header, file->getData(), sizeof(SceneFileHeader));
+
+    if (memcmp(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) != 0) {
+        throw std::runtime_error("[Error] '" + path + "' is not a scene file!");
+    }
+
+    if (header.version != SCENE_FILE_VERSION) {
+        throw std::runtime_error("[Error] '" + path + "' has version " + std::to_string(header.version) +
+                                 ", expected version " + std::to_string(SCENE_FILE_VERSION) + "!");
+    }
+
+    if (header.sphereSize != sizeof(Sphere)) {
+        throw std::runtime_error("[Error] '" + path + "' was written with a different sphere layout (" +
+                                 std::to_string(header.sphereSize) + " instead of " +
+                                 std::to_string(sizeof(Sphere)) + " bytes)!");
+    }
+
+    if (header.sphereAmount == 0 || header.sphereAmount > UINT32_MAX ||
+        header.spheresOffset % alignof(Sphere) != 0 || header.spheresOffset > file->getSize() ||
+        header.sphereAmount > (file->getSize() - header.spheresOffset) / sizeof(Sphere)) {
+        throw std::runtime_error("[Error] '" + path + "' is truncated or corrupt!");
+    }
+
+    const auto* spheres = reinterpret_cast<const Sphere*>(file->getData() + header.spheresOffset);
+
+    // THE SHADERS & THE TEXT WRITER INDEX BY THE MATERIAL & TEXTURE TYPE
+    for (uint64_t sphere = 0; sphere < header.sphereAmount; sphere++) {
+        if (spheres[sphere].materialType > REFRACTIVE || spheres[sphere].textureType > CHECKERED) {
+            throw std::runtime_error("[Error] '" + path + "' has an invalid material or texture type at sphere " +
+                                     std::to_string(sphere) + "!");
+        }
+    }
+
+    return {
+            .spheres = std::span<const Sphere>(spheres, header.sphereAmount),
+            .storage = file
+    };
+}
+
+void writeBinaryScene(const std::string &path, const Scene &scene) {
+    if (std::endian::native != std::endian::little) {
+        throw std::runtime_error("[Error] Binary scene files can only be written on little endian hosts!");
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("[Error] Failed to open '" + path + "' for writing!");
+    }
+
+    SceneFileHeader header = {
+            .version = SCENE_FILE_VERSION,
+            .sphereSize = sizeof(Sphere),
+            .sphereAmount = scene.spheres.size(),
+            .spheresOffset = sizeof(SceneFileHeader)
+    };
+
+    memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(SceneFileHeader));
+    file.write(reinterpret_cast<const char*>(scene.spheres.data()),
+               static_cast<std::streamsize>(scene.spheres.size_bytes()));
+
+    if (!file) {
+        throw std::runtime_error("[Error] Failed to write '" + path + "'!");
+    }
+}
+
+// TEXT
+std::vector<std::string_view> splitWhitespace(std::string_view line) {
+    std::vector<std::string_view> tokens;
+
+    size_t position = 0;
+    while (position < line.size()) {
+        const size_t begin = line.find_first_not_of(" \t\r", position);
+        if (begin == std::string_view::npos) {
+            break;
+        }
+
+        const size_t end = std::min(line.find_first_of(" \t\r", begin), line.size());
+        tokens.push_back(line.substr(begin, end - begin));
+        position = end;
+    }
+
+    return tokens;
+}
+
+float parseSceneFloat(std::string_view token, const std::string &path, size_t lineNumber) {
+    float value = 0.0f;
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+
+    if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+        throw std::runtime_error("[Error] Invalid number '" + std::string(token) + "' in line " +
+                                 std::to_string(lineNumber) + " of '" + path + "'!");
+    }
+
+    return value;
+}
+
+Scene loadTextScene(const std::string &path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("[Error] Failed to open '" + path + "'!");
+    }
+
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto storage = std::make_shared<std::vector<Sphere>>();
+    std::vector<Sphere> &spheres = *storage;
+
+    size_t lineBegin = 0, lineNumber = 0;
+    while (lineBegin < content.size()) {
+        const size_t lineEnd = std::min(content.find('\n', lineBegin), content.size());
+        const std::string_view line(content.data() + lineBegin, lineEnd - lineBegin);
+        lineBegin = lineEnd + 1;
+        lineNumber++;
+
+        const std::vector<std::string_view> tokens = splitWhitespace(line);
+        if (tokens.empty() || tokens[0].starts_with('#')) {
+            continue;
+        }
+
+        if (tokens.size() != 10 && tokens.size() != 13) {
+            throw std::runtime_error("[Error] Expected 10 or 13 values in line " + std::to_string(lineNumber) +
+                                     " of '" + path + "'!");
+        }
+
+        Sphere sphere = {};
+        sphere.geometry = glm::vec4(parseSceneFloat(tokens[0], path, lineNumber),
+                                    parseSceneFloat(tokens[1], path, lineNumber),
+                                    parseSceneFloat(tokens[2], path, lineNumber),
+                                    parseSceneFloat(tokens[3], path, lineNumber));
+
+        if (tokens[4] == "diffuse") {
+            sphere.materialType = MaterialType::DIFFUSE;
+        } else if (tokens[4] == "metal") {
+            sphere.materialType = MaterialType::METAL;
+        } else if (tokens[4] == "refractive") {
+            sphere.materialType = MaterialType::REFRACTIVE;
+        } else {
+            throw std::runtime_error("[Error] Unknown material '" + std::string(tokens[4]) + "' in line " +
+                                     std::to_string(lineNumber) + " of '" + path + "'!");
+        }
+
+        sphere.materialSpecificAttribute = parseSceneFloat(tokens[5], path, lineNumber);
+
+        if (tokens[6] == "solid") {
+            sphere.textureType = TextureType::SOLID;
+        } else if (tokens[6] == "checkered" && tokens.size() == 13) {
+            sphere.textureType = TextureType::CHECKERED;
+        } else {
+            throw std::runtime_error("[Error] Unknown texture '" + std::string(tokens[6]) + "' or missing second "
+                                     "color in line " + std::to_string(lineNumber) + " of '" + path + "'!");
+        }
+
+        for (size_t color = 0; color < (tokens.size() - 7) / 3; color++) {
+            sphere.colors[color] = glm::vec4(parseSceneFloat(tokens[7 + color * 3], path, lineNumber),
+                                             parseSceneFloat(tokens[8 + color * 3], path, lineNumber),
+                                             parseSceneFloat(tokens[9 + color * 3], path, lineNumber), 1.0f);
+        }
+
+        spheres.push_back(sphere);
+    }
+
+    if (spheres.empty()) {
+        throw std::runtime_error("[Error] '" + path + "' does not contain any spheres!");
+    }
+
+    return {
+            .spheres = spheres,
+            .storage = storage
+    };
+}
+
+void writeTextScene(const std::string &path, const Scene &scene) {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("[Error] Failed to open '" + path + "' for writing!");
+    }
+
+    const char* materialNames[] = {"diffuse", "metal", "refractive"};
+    const char* textureNames[] = {"solid", "checkered"};
+
+    // SHORTEST REPRESENTATION THAT PARSES BACK TO THE SAME FLOAT
+    char buffer[512];
+    const auto appendFloat = [&buffer](char* position, float value) {
+        *position++ = ' ';
+        return std::to_chars(position, buffer + sizeof(buffer), value).ptr;
+    };
+
+    file << "# x y z radius material refraction_index texture r g b [r g b]\n";
+
+    for (const Sphere &sphere: scene.spheres) {
+        char* position = buffer;
+
+        for (int i = 0; i < 4; i++) {
+            position = appendFloat(position, sphere.geometry[i]);
+        }
+
+        position += snprintf(position, 16, " %s", materialNames[sphere.materialType]);
+        position = appendFloat(position, sphere.materialSpecificAttribute);
+        position += snprintf(position, 16, " %s", textureNames[sphere.textureType]);
+
+        const int colorCount = sphere.textureType == TextureType::CHECKERED ? 2 : 1;
+        for (int color = 0; color < colorCount; color++) {
+            for (int i = 0; i < 3; i++) {
+                position = appendFloat(position, sphere.colors[color][i]);
+            }
+        }
+
+        *position++ = '\n';
+
+        // SKIP THE LEADING SPACE
+        file.write(buffer + 1, position - buffer - 1);
+    }
+
+    if (!file) {
+        throw std::runtime_error("[Error] Failed to write '" + path + "'!");
+    }
+}
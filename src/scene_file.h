@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "scene.h"
+
+// BINARY SCENE FILE (.rtscene): A 64 BYTE HEADER FOLLOWED BY THE SPHERES IN EXACTLY THEIR GPU LAYOUT (LITTLE ENDIAN).
+// THE MATERIAL OF A SPHERE IS PART OF ITS Sphere STRUCT, SO THERE IS NO SEPARATE MATERIAL ARRAY.
+struct SceneFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sphereSize;
+    uint64_t sphereAmount;
+    uint64_t spheresOffset;
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(SceneFileHeader) == 64);
+
+const char SCENE_FILE_MAGIC[8] = {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+const uint32_t SCENE_FILE_VERSION = 1;
+
+// TEXT SCENE FILE: ONE SPHERE PER LINE, EMPTY LINES AND LINES STARTING WITH # ARE IGNORED
+//   <x> <y> <z> <radius> <diffuse|metal|refractive> <refraction index> <solid|checkered> <r> <g> <b> [<r> <g> <b>]
+// THE SECOND COLOR IS ONLY READ FOR CHECKERED TEXTURES
+
+[[nodiscard]] bool isBinaryScenePath(const std::string &path);
+
+// LOADS A BINARY OR TEXT SCENE DEPENDING ON THE EXTENSION OF path
+[[nodiscard]] Scene loadScene(const std::string &path);
+
+// MAPS THE FILE, THE SPHERES OF THE SCENE POINT DIRECTLY INTO THE MAPPING
+[[nodiscard]] Scene loadBinaryScene(const std::string &path);
+
+[[nodiscard]] Scene loadTextScene(const std::string &path);
+
+void writeBinaryScene(const std::string &path, const Scene &scene);
+
+void writeTextScene(const std::string &path, const Scene &scene);
@@ -0,0 +1,207 @@
+#include "scene_partition.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <unordered_map>
+
+// POSITIONS INSIDE A CLUSTER ARE COMPARED IN 1/1024 UNITS, SO REPEATED CLUSTERS MATCH DESPITE FLOAT ROUNDING
+const double CLUSTER_POSITION_SCALE = 1024.0;
+const double CLUSTER_POSITION_TOLERANCE = 1e-3;
+
+struct ClusterSphere {
+    uint64_t cell;
+    uint32_t materialVariant;
+    int64_t position[3];
+    uint32_t index;
+};
+
+uint64_t getClusterCell(const glm::vec3 &center) {
+    uint64_t cell = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        const double coordinate = std::floor(double(center[axis]) / SCENE_CLUSTER_SIZE) + double(1 << 20);
+        cell = (cell << 21) | static_cast<uint64_t>(std::clamp(coordinate, 0.0, double((1 << 21) - 1)));
+    }
+
+    return cell;
+}
+
+glm::dvec3 getClusterOrigin(const glm::vec3 &center) {
+    return glm::floor(glm::dvec3(center) / double(SCENE_CLUSTER_SIZE)) * double(SCENE_CLUSTER_SIZE);
+}
+
+// EVERYTHING BUT THE POSITION HAS TO MATCH EXACTLY
+bool isSameSphereMaterial(const Sphere &a, const Sphere &b) {
+    return a.geometry.w == b.geometry.w && a.materialType == b.materialType && a.textureType == b.textureType &&
+           a.colors[0] == b.colors[0] && a.colors[1] == b.colors[1] &&
+           a.materialSpecificAttribute == b.materialSpecificAttribute;
+}
+
+uint64_t hashClusterSphere(uint64_t hash, const ClusterSphere &clusterSphere, const Sphere &sphere) {
+    const auto combine = [&hash](const void* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ull;
+        }
+    };
+
+    combine(clusterSphere.position, sizeof(clusterSphere.position));
+    combine(&sphere.geometry.w, sizeof(float));
+    combine(&sphere.materialType, sizeof(uint32_t));
+    combine(&sphere.textureType, sizeof(uint32_t));
+    combine(sphere.colors, sizeof(sphere.colors));
+    combine(&sphere.materialSpecificAttribute, sizeof(float));
+
+    return hash;
+}
+
+uint32_t getMaterialVariant(const Sphere &sphere) {
+    if (sphere.materialType >= MATERIAL_TYPE_COUNT || sphere.textureType >= TEXTURE_TYPE_COUNT) {
+        return MIXED_MATERIAL_VARIANT;
+    }
+
+    return sphere.materialType * TEXTURE_TYPE_COUNT + sphere.textureType;
+}
+
+ScenePartition partitionHostScene(std::span<const Sphere> spheres, bool instanceClusters,
+                                  bool splitMaterialVariants) {
+    ScenePartition partition;
+    partition.sphereIndices.reserve(spheres.size());
+
+    const auto addInstance = [&partition](uint32_t cluster, const glm::dvec3 &translation) {
+        partition.instances.push_back({.cluster = cluster, .translation = glm::vec3(translation)});
+    };
+
+    const auto getClusterMaterialVariant = [splitMaterialVariants](const Sphere &sphere) {
+        return splitMaterialVariants ? getMaterialVariant(sphere) : MIXED_MATERIAL_VARIANT;
+    };
+
+    // LARGE SPHERES FIRST, EACH IN A CLUSTER OF ITS OWN. THE SMALL ONES ARE SORTED BY CELL & MATERIAL VARIANT, THEN BY
+    // POSITION, SO REPEATED CLUSTERS LIST THEIR SPHERES IN THE SAME ORDER
+    std::vector<ClusterSphere> clusterSpheres;
+    clusterSpheres.reserve(spheres.size());
+
+    for (uint32_t i = 0; i < spheres.size(); i++) {
+        const glm::vec3 center = glm::vec3(spheres[i].geometry);
+
+        if (spheres[i].geometry.w > SCENE_CLUSTER_SIZE / 4.0f) {
+            partition.clusters.push_back({.firstSphere = static_cast<uint32_t>(partition.sphereIndices.size()),
+                                          .sphereAmount = 1,
+                                          .materialVariant = getClusterMaterialVariant(spheres[i])});
+            partition.sphereIndices.push_back(i);
+            addInstance(static_cast<uint32_t>(partition.clusters.size() - 1), glm::dvec3(0.0));
+            continue;
+        }
+
+        const glm::dvec3 position = (glm::dvec3(center) - getClusterOrigin(center)) * CLUSTER_POSITION_SCALE;
+        clusterSpheres.push_back({
+                .cell = getClusterCell(center),
+                .materialVariant = getClusterMaterialVariant(spheres[i]),
+                .position = {std::llround(position.x), std::llround(position.y), std::llround(position.z)},
+                .index = i
+        });
+    }
+
+    std::sort(clusterSpheres.begin(), clusterSpheres.end(), [](const ClusterSphere &a, const ClusterSphere &b) {
+        return std::tie(a.cell, a.materialVariant, a.position[0], a.position[1], a.position[2], a.index) <
+               std::tie(b.cell, b.materialVariant, b.position[0], b.position[1], b.position[2], b.index);
+    });
+
+    // ONE CLUSTER PER OCCUPIED CELL & MATERIAL VARIANT, UNLESS AN EARLIER CLUSTER WITH THE SAME HASH MATCHES IT
+    std::unordered_map<uint64_t, std::vector<uint32_t>> clustersByHash;
+    std::vector<glm::dvec3> clusterOrigins(partition.clusters.size());
+
+    const auto isSameCluster = [&](uint32_t cluster, size_t begin, size_t end, const glm::dvec3 &origin) {
+        const SceneCluster &candidate = partition.clusters[cluster];
+        if (candidate.sphereAmount != end - begin) {
+            return false;
+        }
+
+        for (size_t i = begin; i < end; i++) {
+            const Sphere &sphere = spheres[clusterSpheres[i].index];
+            const Sphere &candidateSphere = spheres[partition.sphereIndices[candidate.firstSphere + (i - begin)]];
+
+            const glm::dvec3 offset = (glm::dvec3(glm::vec3(sphere.geometry)) - origin) -
+                                      (glm::dvec3(glm::vec3(candidateSphere.geometry)) - clusterOrigins[cluster]);
+
+            if (!isSameSphereMaterial(sphere, candidateSphere) || std::abs(offset.x) > CLUSTER_POSITION_TOLERANCE ||
+                std::abs(offset.y) > CLUSTER_POSITION_TOLERANCE || std::abs(offset.z) > CLUSTER_POSITION_TOLERANCE) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    for (size_t begin = 0; begin < clusterSpheres.size();) {
+        size_t end = begin;
+        uint64_t hash = 14695981039346656037ull;
+
+        while (end < clusterSpheres.size() && clusterSpheres[end].cell == clusterSpheres[begin].cell &&
+               clusterSpheres[end].materialVariant == clusterSpheres[begin].materialVariant) {
+            hash = hashClusterSphere(hash, clusterSpheres[end], spheres[clusterSpheres[end].index]);
+            end++;
+        }
+
+        const glm::dvec3 origin = getClusterOrigin(glm::vec3(spheres[clusterSpheres[begin].index].geometry));
+
+        std::vector<uint32_t> &candidates = clustersByHash[hash];
+        const auto match = !instanceClusters ? candidates.end() :
+                           std::find_if(candidates.begin(), candidates.end(), [&](uint32_t cluster) {
+                               return isSameCluster(cluster, begin, end, origin);
+                           });
+
+        if (match != candidates.end()) {
+            addInstance(*match, origin - clusterOrigins[*match]);
+        } else {
+            const auto cluster = static_cast<uint32_t>(partition.clusters.size());
+
+            partition.clusters.push_back({.firstSphere = static_cast<uint32_t>(partition.sphereIndices.size()),
+                                          .sphereAmount = static_cast<uint32_t>(end - begin),
+                                          .materialVariant = clusterSpheres[begin].materialVariant});
+            clusterOrigins.push_back(origin);
+            candidates.push_back(cluster);
+
+            for (size_t i = begin; i < end; i++) {
+                partition.sphereIndices.push_back(clusterSpheres[i].index);
+            }
+
+            addInstance(cluster, glm::dvec3(0.0));
+        }
+
+        begin = end;
+    }
+
+    partition.uploadedSphereAmount = static_cast<uint32_t>(partition.sphereIndices.size());
+
+    return partition;
+}
+
+// THE GROUND SPHERE, THE 3 REMAINING LARGE SPHERES, THEN STRIPS OF WHOLE GRID ROWS OF ABOUT ONE CLUSTER CELL EACH
+ScenePartition partitionGeneratedScene(const SceneGenerationSettings &settings) {
+    const uint32_t gridSize = getSceneGridSize(settings);
+    const uint32_t cellCount = settings.sphereAmount - 4;
+    const uint32_t rowsPerCluster = std::max(1u, static_cast<uint32_t>(SCENE_CLUSTER_SIZE * SCENE_CLUSTER_SIZE) /
+                                                 std::max(gridSize, 1u));
+    const uint32_t cellsPerCluster = rowsPerCluster * gridSize;
+
+    ScenePartition partition = {
+            .clusters = {{.firstSphere = 0, .sphereAmount = 1}, {.firstSphere = 1, .sphereAmount = 3}},
+            .uploadedSphereAmount = settings.sphereAmount
+    };
+
+    for (uint32_t cell = 0; cell < cellCount; cell += cellsPerCluster) {
+        partition.clusters.push_back({.firstSphere = 4 + cell,
+                                      .sphereAmount = std::min(cellsPerCluster, cellCount - cell)});
+    }
+
+    for (uint32_t cluster = 0; cluster < partition.clusters.size(); cluster++) {
+        partition.instances.push_back({.cluster = cluster, .translation = glm::vec3(0.0f)});
+    }
+
+    return partition;
+}
+
+ScenePartition partitionScene(const Scene &scene, bool instanceClusters, bool splitMaterialVariants) {
+    return scene.generation ? partitionGeneratedScene(*scene.generation)
+                            : partitionHostScene(scene.spheres, instanceClusters, splitMaterialVariants);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "scene.h"
+
+// EDGE LENGTH OF THE CUBES SMALL SPHERES ARE CLUSTERED IN, SPHERES WITH A RADIUS ABOVE A QUARTER OF IT GET A
+// CLUSTER OF THEIR OWN, SO THEIR BOUNDS NEVER OVERLAP THE SMALL ONES
+const float SCENE_CLUSTER_SIZE = 32.0f;
+
+// MATERIAL TYPE & TEXTURE TYPE OF A SPHERE IN ONE INDEX (materialType * TEXTURE_TYPE_COUNT + textureType), SO EVERY
+// VARIANT CAN BE SHADED WITHOUT BRANCHING ON THE SPHERE. CLUSTERS OF SEVERAL VARIANTS ARE MIXED_MATERIAL_VARIANT
+const uint32_t MATERIAL_TYPE_COUNT = 3;
+const uint32_t TEXTURE_TYPE_COUNT = 2;
+const uint32_t MATERIAL_VARIANT_COUNT = MATERIAL_TYPE_COUNT * TEXTURE_TYPE_COUNT;
+const uint32_t MIXED_MATERIAL_VARIANT = MATERIAL_VARIANT_COUNT;
+
+// A RANGE OF THE UPLOADED SPHERES, BUILT INTO ONE BOTTOM LEVEL ACCELERATION STRUCTURE
+struct SceneCluster {
+    uint32_t firstSphere;
+    uint32_t sphereAmount;
+    uint32_t materialVariant = MIXED_MATERIAL_VARIANT;
+};
+
+// ONE TOP LEVEL INSTANCE OF A CLUSTER, MOVED BY translation
+struct SceneInstance {
+    uint32_t cluster;
+    glm::vec3 translation;
+};
+
+// CLUSTERS THAT MATCH AN EARLIER ONE UP TO A TRANSLATION (SAME SPHERES, MATERIALS & COLORS) ARE NOT UPLOADED AGAIN BUT
+// BECOME ANOTHER INSTANCE OF IT. sphereIndices LISTS THE SCENE SPHERES TO UPLOAD IN CLUSTER ORDER, IT IS EMPTY IF THE
+// SCENE IS UPLOADED AS IS
+struct ScenePartition {
+    std::vector<uint32_t> sphereIndices;
+    std::vector<SceneCluster> clusters;
+    std::vector<SceneInstance> instances;
+    uint32_t uploadedSphereAmount = 0;
+};
+
+// UNKNOWN TYPES ARE MIXED_MATERIAL_VARIANT
+[[nodiscard]] uint32_t getMaterialVariant(const Sphere &sphere);
+
+// HOST SCENES ARE CLUSTERED & DEDUPLICATED BY THEIR SPHERES, DEVICE GENERATED ONES BY THEIR KNOWN LAYOUT (THE LARGE
+// SPHERES, THEN STRIPS OF GRID ROWS) WITHOUT INSTANCING. SCENES THAT ARE UPDATED LATER NEED EVERY SPHERE UPLOADED, SO
+// instanceClusters TURNS THE DEDUPLICATION OFF. splitMaterialVariants GIVES THE SPHERES OF EVERY MATERIAL VARIANT IN A
+// CELL A CLUSTER OF THEIR OWN (HOST SCENES ONLY, THE MATERIALS OF A GENERATED SCENE ARE NOT KNOWN ON THE HOST)
+[[nodiscard]] ScenePartition partitionScene(const Scene &scene, bool instanceClusters = true,
+                                            bool splitMaterialVariants = false);
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "scene.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+const uint32_t SPHERE_PACKET_WIDTH = 8;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+const uint32_t SPHERE_PACKET_WIDTH = 4;
+#else
+const uint32_t SPHERE_PACKET_WIDTH = 1;
+#endif
+
+// STRUCTURE OF ARRAYS, PADDED TO A MULTIPLE OF SPHERE_PACKET_WIDTH. PADDING SPHERES CAN NEVER BE HIT
+struct SpherePackets {
+    std::vector<float> centerX, centerY, centerZ, radiusSquared;
+    std::vector<uint32_t> sphereIndices;
+};
+
+struct SphereHit {
+    float t;
+    uint32_t sphereIndex;
+};
+
+const float SPHERE_PACKET_PADDING_RADIUS_SQUARED = -1e30f;
+
+inline void appendSpherePacket(SpherePackets &packets, const Sphere* spheres, const uint32_t* sphereIndices,
+                               uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec4 &geometry = spheres[sphereIndices[i]].geometry;
+
+        packets.centerX.push_back(geometry.x);
+        packets.centerY.push_back(geometry.y);
+        packets.centerZ.push_back(geometry.z);
+        packets.radiusSquared.push_back(geometry.w * geometry.w);
+        packets.sphereIndices.push_back(sphereIndices[i]);
+    }
+
+    while (packets.sphereIndices.size() % SPHERE_PACKET_WIDTH != 0) {
+        packets.centerX.push_back(0.0f);
+        packets.centerY.push_back(0.0f);
+        packets.centerZ.push_back(0.0f);
+        packets.radiusSquared.push_back(SPHERE_PACKET_PADDING_RADIUS_SQUARED);
+        packets.sphereIndices.push_back(0);
+    }
+}
+
+// SAME SEMANTICS AS shader.rint: THE NEAR ROOT IF IT IS INSIDE [tMin, tMax], OTHERWISE THE FAR ROOT.
+// hit.t IS THE CURRENT tMax AND ONLY GETS REPLACED BY CLOSER HITS. begin & end ARE PACKET ALIGNED
+inline bool intersectSpherePackets(const SpherePackets &packets, uint32_t begin, uint32_t end,
+                                   const glm::vec3 &origin, const glm::vec3 &direction, float tMin, SphereHit &hit) {
+    const float a = glm::dot(direction, direction);
+    bool hasHit = false;
+
+#if defined(__AVX2__)
+    const __m256 originX = _mm256_set1_ps(origin.x), originY = _mm256_set1_ps(origin.y),
+            originZ = _mm256_set1_ps(origin.z);
+    const __m256 directionX = _mm256_set1_ps(direction.x), directionY = _mm256_set1_ps(direction.y),
+            directionZ = _mm256_set1_ps(direction.z);
+    const __m256 aPacket = _mm256_set1_ps(a), tMinPacket = _mm256_set1_ps(tMin);
+    const __m256 zero = _mm256_setzero_ps(), infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+    for (uint32_t i = begin; i < end; i += SPHERE_PACKET_WIDTH) {
+        const __m256 ocX = _mm256_sub_ps(originX, _mm256_loadu_ps(&packets.centerX[i]));
+        const __m256 ocY = _mm256_sub_ps(originY, _mm256_loadu_ps(&packets.centerY[i]));
+        const __m256 ocZ = _mm256_sub_ps(originZ, _mm256_loadu_ps(&packets.centerZ[i]));
+
+        const __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, directionX), _mm256_mul_ps(ocY, directionY)),
+                                       _mm256_mul_ps(ocZ, directionZ));
+        const __m256 c = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, ocX), _mm256_mul_ps(ocY, ocY)), _mm256_mul_ps(ocZ, ocZ)),
+                _mm256_loadu_ps(&packets.radiusSquared[i]));
+        const __m256 D = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(aPacket, c));
+
+        const __m256 hasRoots = _mm256_cmp_ps(D, zero, _CMP_GE_OQ);
+        if (_mm256_movemask_ps(hasRoots) == 0) {
+            continue;
+        }
+
+        const __m256 sqrtD = _mm256_sqrt_ps(_mm256_max_ps(D, zero));
+        const __m256 minusB = _mm256_sub_ps(zero, b);
+        const __m256 t1 = _mm256_div_ps(_mm256_sub_ps(minusB, sqrtD), aPacket);
+        const __m256 t2 = _mm256_div_ps(_mm256_add_ps(minusB, sqrtD), aPacket);
+
+        const __m256 tMaxPacket = _mm256_set1_ps(hit.t);
+        const __m256 t1Valid = _mm256_and_ps(hasRoots, _mm256_and_ps(_mm256_cmp_ps(t1, tMinPacket, _CMP_GE_OQ),
+                                                                     _mm256_cmp_ps(t1, tMaxPacket, _CMP_LE_OQ)));
+        const __m256 t2Valid = _mm256_and_ps(hasRoots, _mm256_and_ps(_mm256_cmp_ps(t2, tMinPacket, _CMP_GE_OQ),
+                                                                     _mm256_cmp_ps(t2, tMaxPacket, _CMP_LE_OQ)));
+
+        __m256 t = _mm256_blendv_ps(infinity, t2, t2Valid);
+        t = _mm256_blendv_ps(t, t1, t1Valid);
+
+        const int validMask = _mm256_movemask_ps(_mm256_or_ps(t1Valid, t2Valid));
+        if (validMask == 0) {
+            continue;
+        }
+
+        alignas(32) float tValues[SPHERE_PACKET_WIDTH];
+        _mm256_store_ps(tValues, t);
+
+        for (uint32_t lane = 0; lane < SPHERE_PACKET_WIDTH; lane++) {
+            if ((validMask & (1 << lane)) && tValues[lane] <= hit.t) {
+                hit = {.t = tValues[lane], .sphereIndex = packets.sphereIndices[i + lane]};
+                hasHit = true;
+            }
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t originX = vdupq_n_f32(origin.x), originY = vdupq_n_f32(origin.y),
+            originZ = vdupq_n_f32(origin.z);
+    const float32x4_t aPacket = vdupq_n_f32(a), zero = vdupq_n_f32(0.0f);
+    const float32x4_t infinity = vdupq_n_f32(std::numeric_limits<float>::infinity());
+
+    for (uint32_t i = begin; i < end; i += SPHERE_PACKET_WIDTH) {
+        const float32x4_t ocX = vsubq_f32(originX, vld1q_f32(&packets.centerX[i]));
+        const float32x4_t ocY = vsubq_f32(originY, vld1q_f32(&packets.centerY[i]));
+        const float32x4_t ocZ = vsubq_f32(originZ, vld1q_f32(&packets.centerZ[i]));
+
+        const float32x4_t b = vaddq_f32(vaddq_f32(vmulq_n_f32(ocX, direction.x), vmulq_n_f32(ocY, direction.y)),
+                                        vmulq_n_f32(ocZ, direction.z));
+        const float32x4_t c = vsubq_f32(vaddq_f32(vaddq_f32(vmulq_f32(ocX, ocX), vmulq_f32(ocY, ocY)),
+                                                  vmulq_f32(ocZ, ocZ)),
+                                        vld1q_f32(&packets.radiusSquared[i]));
+        const float32x4_t D = vsubq_f32(vmulq_f32(b, b), vmulq_f32(aPacket, c));
+
+        const uint32x4_t hasRoots = vcgeq_f32(D, zero);
+        if (vmaxvq_u32(hasRoots) == 0) {
+            continue;
+        }
+
+        const float32x4_t sqrtD = vsqrtq_f32(vmaxq_f32(D, zero));
+        const float32x4_t minusB = vnegq_f32(b);
+        const float32x4_t t1 = vdivq_f32(vsubq_f32(minusB, sqrtD), aPacket);
+        const float32x4_t t2 = vdivq_f32(vaddq_f32(minusB, sqrtD), aPacket);
+
+        const float32x4_t tMinPacket = vdupq_n_f32(tMin), tMaxPacket = vdupq_n_f32(hit.t);
+        const uint32x4_t t1Valid = vandq_u32(hasRoots, vandq_u32(vcgeq_f32(t1, tMinPacket), vcleq_f32(t1, tMaxPacket)));
+        const uint32x4_t t2Valid = vandq_u32(hasRoots, vandq_u32(vcgeq_f32(t2, tMinPacket), vcleq_f32(t2, tMaxPacket)));
+
+        float32x4_t t = vbslq_f32(t2Valid, t2, infinity);
+        t = vbslq_f32(t1Valid, t1, t);
+
+        if (vmaxvq_u32(vorrq_u32(t1Valid, t2Valid)) == 0) {
+            continue;
+        }
+
+        float tValues[SPHERE_PACKET_WIDTH];
+        vst1q_f32(tValues, t);
+
+        for (uint32_t lane = 0; lane < SPHERE_PACKET_WIDTH; lane++) {
+            if (tValues[lane] <= hit.t) {
+                hit = {.t = tValues[lane], .sphereIndex = packets.sphereIndices[i + lane]};
+                hasHit = true;
+            }
+        }
+    }
+#else
+    for (uint32_t i = begin; i < end; i++) {
+        const glm::vec3 oc = origin - glm::vec3(packets.centerX[i], packets.centerY[i], packets.centerZ[i]);
+        const float b = glm::dot(oc, direction);
+        const float c = glm::dot(oc, oc) - packets.radiusSquared[i];
+        const float D = b * b - a * c;
+
+        if (D < 0.0f) {
+            continue;
+        }
+
+        const float t1 = (-b - std::sqrt(D)) / a;
+        const float t2 = (-b + std::sqrt(D)) / a;
+
+        if (t1 >= tMin && t1 <= hit.t) {
+            hit = {.t = t1, .sphereIndex = packets.sphereIndices[i]};
+            hasHit = true;
+        } else if (t2 >= tMin && t2 <= hit.t) {
+            hit = {.t = t2, .sphereIndex = packets.sphereIndices[i]};
+            hasHit = true;
+        }
+    }
+#endif
+
+    return hasHit;
+}
@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threadCount) :
+        threadCount(threadCount == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threadCount) {
+
+    // THE THREAD CALLING parallelFor() IS WORKER 0
+    for (uint32_t workerIndex = 1; workerIndex < this->threadCount; workerIndex++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, workerIndex);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+
+    jobCondition.notify_all();
+
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t index)> &task) {
+    if (count == 0) {
+        return;
+    }
+
+    // EVERY WORKER STARTS WITH A CONTIGUOUS RANGE OF INDICES AND STEALS FROM THE OTHERS ONCE IT RUNS OUT
+    auto job = std::make_shared<Job>();
+    job->task = &task;
+    job->queues = std::make_unique<WorkQueue[]>(threadCount);
+    job->remainingTasks = count;
+
+    for (uint32_t index = 0; index < count; index++) {
+        job->queues[static_cast<uint64_t>(index) * threadCount / count].indices.push_back(index);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        currentJob = job;
+        jobGeneration++;
+    }
+
+    jobCondition.notify_all();
+    runTasks(*job, 0);
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    doneCondition.wait(lock, [&job]() { return job->remainingTasks == 0; });
+    currentJob.reset();
+}
+
+uint32_t ThreadPool::getThreadCount() const {
+    return threadCount;
+}
+
+void ThreadPool::workerLoop(uint32_t workerIndex) {
+    uint64_t lastJobGeneration = 0;
+
+    while (true) {
+        std::shared_ptr<Job> job;
+
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [&]() { return stopping || jobGeneration != lastJobGeneration; });
+
+            if (stopping) {
+                return;
+            }
+
+            lastJobGeneration = jobGeneration;
+            job = currentJob;
+        }
+
+        // A JOB THAT ALREADY FINISHED HAS NO INDICES LEFT, SO HOLDING A STALE ONE IS HARMLESS
+        if (job) {
+            runTasks(*job, workerIndex);
+        }
+    }
+}
+
+void ThreadPool::runTasks(Job &job, uint32_t workerIndex) {
+    while (std::optional<uint32_t> index = popOrSteal(job, workerIndex)) {
+        (*job.task)(*index);
+
+        if (--job.remainingTasks == 0) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            doneCondition.notify_all();
+        }
+    }
+}
+
+std::optional<uint32_t> ThreadPool::popOrSteal(Job &job, uint32_t workerIndex) const {
+    // OWN QUEUE FROM THE FRONT
+    {
+        WorkQueue &queue = job.queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.indices.empty()) {
+            const uint32_t index = queue.indices.front();
+            queue.indices.pop_front();
+            return index;
+        }
+    }
+
+    // OTHER QUEUES FROM THE BACK
+    for (uint32_t offset = 1; offset < threadCount; offset++) {
+        WorkQueue &queue = job.queues[(workerIndex + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.indices.empty()) {
+            const uint32_t index = queue.indices.back();
+            queue.indices.pop_back();
+            return index;
+        }
+    }
+
+    return std::nullopt;
+}
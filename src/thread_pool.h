@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t threadCount = 0);
+
+    ~ThreadPool();
+
+    void parallelFor(uint32_t count, const std::function<void(uint32_t index)> &task);
+
+    [[nodiscard]] uint32_t getThreadCount() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<uint32_t> indices;
+    };
+
+    struct Job {
+        const std::function<void(uint32_t index)>* task;
+        std::unique_ptr<WorkQueue[]> queues;
+        std::atomic<uint32_t> remainingTasks;
+    };
+
+    uint32_t threadCount;
+    std::vector<std::thread> workers;
+
+    std::mutex jobMutex;
+    std::condition_variable jobCondition;
+    std::condition_variable doneCondition;
+    std::shared_ptr<Job> currentJob;
+    uint64_t jobGeneration = 0;
+    bool stopping = false;
+
+    void workerLoop(uint32_t workerIndex);
+
+    void runTasks(Job &job, uint32_t workerIndex);
+
+    [[nodiscard]] std::optional<uint32_t> popOrSteal(Job &job, uint32_t workerIndex) const;
+};
@@ -0,0 +1,57 @@
+#include "tile_scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+TileScheduler::TileScheduler(uint32_t imageWidth, uint32_t imageHeight, uint32_t tileSize,
+                             float targetSubmitMilliseconds) :
+        imageWidth(imageWidth), imageHeight(imageHeight), targetSubmitMilliseconds(targetSubmitMilliseconds) {
+
+    // A TILE SIZE OF 0 DISPATCHES THE WHOLE IMAGE AT ONCE
+    this->tileSize = tileSize == 0 ? std::max(imageWidth, imageHeight) : tileSize;
+}
+
+std::vector<Tile> TileScheduler::getTiles(uint32_t samplesPerRenderCall) {
+    // ADAPT THE TILE SIZE SO ONE TILE TAKES ABOUT THE TARGET DURATION ON THE GPU
+    if (targetSubmitMilliseconds > 0.0f && pixelSamplesPerMillisecond > 0.0) {
+        const double targetPixels = pixelSamplesPerMillisecond * targetSubmitMilliseconds /
+                                    std::max(samplesPerRenderCall, 1u);
+        const auto maxTileSize = std::max(imageWidth, imageHeight);
+        const auto alignedTileSize = static_cast<uint32_t>(std::sqrt(targetPixels)) / tileSizeAlignment *
+                                     tileSizeAlignment;
+
+        tileSize = std::clamp(alignedTileSize, tileSizeAlignment, maxTileSize);
+    }
+
+    std::vector<Tile> tiles;
+    for (uint32_t offsetY = 0; offsetY < imageHeight; offsetY += tileSize) {
+        for (uint32_t offsetX = 0; offsetX < imageWidth; offsetX += tileSize) {
+            tiles.push_back(
+                    {
+                            .offsetX = offsetX,
+                            .offsetY = offsetY,
+                            .width = std::min(tileSize, imageWidth - offsetX),
+                            .height = std::min(tileSize, imageHeight - offsetY)
+                    });
+        }
+    }
+
+    return tiles;
+}
+
+void TileScheduler::reportSubmitDuration(const Tile &tile, uint32_t samplesPerRenderCall, double milliseconds) {
+    if (milliseconds <= 0.0) {
+        return;
+    }
+
+    const double measuredThroughput =
+            static_cast<double>(tile.width) * tile.height * samplesPerRenderCall / milliseconds;
+
+    pixelSamplesPerMillisecond = pixelSamplesPerMillisecond == 0.0
+                                 ? measuredThroughput
+                                 : throughputSmoothing * measuredThroughput +
+                                   (1.0 - throughputSmoothing) * pixelSamplesPerMillisecond;
+}
+
+uint32_t TileScheduler::getTileSize() const {
+    return tileSize;
+}
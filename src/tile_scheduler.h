@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct Tile {
+    uint32_t offsetX, offsetY;
+    uint32_t width, height;
+};
+
+struct TileProgress {
+    uint32_t renderCallNumber;
+    uint32_t tileIndex;
+    uint32_t tileCount;
+    Tile tile;
+    double milliseconds;
+};
+
+class TileScheduler {
+public:
+    TileScheduler(uint32_t imageWidth, uint32_t imageHeight, uint32_t tileSize, float targetSubmitMilliseconds);
+
+    [[nodiscard]] std::vector<Tile> getTiles(uint32_t samplesPerRenderCall);
+
+    void reportSubmitDuration(const Tile &tile, uint32_t samplesPerRenderCall, double milliseconds);
+
+    [[nodiscard]] uint32_t getTileSize() const;
+
+private:
+    const uint32_t tileSizeAlignment = 8;
+    const double throughputSmoothing = 0.5;
+
+    uint32_t imageWidth, imageHeight;
+    uint32_t tileSize;
+    float targetSubmitMilliseconds;
+
+    // MEASURED PIXEL SAMPLES PER MILLISECOND, 0 UNTIL THE FIRST MEASUREMENT
+    double pixelSamplesPerMillisecond = 0.0;
+};
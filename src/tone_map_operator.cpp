@@ -0,0 +1,29 @@
+#include "tone_map_operator.h"
+
+std::optional<ToneMapOperator> parseToneMapOperator(const std::string &name) {
+    if (name == "clamp") {
+        return TONE_MAP_CLAMP;
+    }
+
+    if (name == "reinhard") {
+        return TONE_MAP_REINHARD;
+    }
+
+    if (name == "aces") {
+        return TONE_MAP_ACES;
+    }
+
+    return std::nullopt;
+}
+
+std::string getToneMapOperatorName(ToneMapOperator toneMapOperator) {
+    if (toneMapOperator == TONE_MAP_REINHARD) {
+        return "reinhard";
+    }
+
+    if (toneMapOperator == TONE_MAP_ACES) {
+        return "aces";
+    }
+
+    return "clamp";
+}
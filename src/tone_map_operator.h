@@ -0,0 +1,17 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// OPERATOR OF THE RESOLVE FROM THE MEAN PIXEL COLORS TO THE RGBA8 PREVIEW, THE VALUES OF THE TONE_MAP SPECIALIZATION
+// CONSTANT OF resolve.comp. EVERY OPERATOR IS FOLLOWED BY THE GAMMA 2 ENCODING (sqrt)
+enum ToneMapOperator {
+    TONE_MAP_CLAMP = 0,    // NONE, VALUES ABOVE 1 ARE CLIPPED
+    TONE_MAP_REINHARD = 1, // c / (1 + c) PER CHANNEL
+    TONE_MAP_ACES = 2      // FILMIC CURVE FIT OF THE ACES REFERENCE RENDERING TRANSFORM (NARKOWICZ)
+};
+
+// COMMAND LINE NAMES: clamp, reinhard, aces
+std::optional<ToneMapOperator> parseToneMapOperator(const std::string &name);
+
+std::string getToneMapOperatorName(ToneMapOperator toneMapOperator);
@@ -1,135 +1,752 @@
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-
 #include "vulkan.h"
 #include <iostream>
 #include <set>
 #include <fstream>
-#include <stb_image_write.h>
 #include "shader_path.hpp"
 #include <algorithm>
+#include <filesystem>
+#include <bit>
+#include <cstring>
+#include <future>
+#include <thread>
+#include "thread_pool.h"
+
+Vulkan::Vulkan(VulkanSettings settings, const Scene &scene) :
+        settings(settings),
+        tileScheduler(settings.windowWidth, settings.windowHeight, settings.tileSize,
+                      settings.targetSubmitMilliseconds),
+        window(nullptr) {
+
+    // EVERY STAGE IS TIMED ON ITS OWN, SO STARTS WITH & WITHOUT A PIPELINE CACHE CAN BE COMPARED
+    if (!settings.headless) {
+        measureStartupStage("createWindow", [this]() { createWindow(); });
+    }
+
+    measureStartupStage("createInstance", [this]() { createInstance(); });
+
+    if (!settings.headless) {
+        measureStartupStage("createSurface", [this]() { createSurface(); });
+    }
+
+    measureStartupStage("pickPhysicalDevice", [this]() {
+        pickPhysicalDevice();
+        findQueueFamilies();
+    });
+
+    measureStartupStage("createLogicalDevice", [this]() {
+        createLogicalDevice();
+
+        dynamicDispatchLoader = vk::DispatchLoaderDynamic(instance, vkGetInstanceProcAddr, device);
+        memoryAllocator = std::make_unique<VulkanMemoryAllocator>(physicalDevice, device, memoryBudgetSupported);
+
+        createCommandPool();
+        stagingRing = std::make_unique<VulkanStagingRing>(device, computeQueue, commandPool, *memoryAllocator,
+                                                          STAGING_RING_SIZE);
+    });
+
+    measureStartupStage("loadPipelineCache", [this]() { loadPipelineCache(); });
+
+    std::shared_future<void> scenePartitioning = std::async(std::launch::async, [this, &scene]() {
+        measureStartupStage("partitionScene", [this, &scene]() { createScenePartition(scene); });
+    }).share();
+
+    // THE PIPELINE ONLY NEEDS LAYOUTS & THE MATERIAL VARIANTS OF THE PARTITION, SO IT COMPILES WHILE THE SCENE IS
+    // UPLOADED & ITS ACCELERATION STRUCTURES ARE BUILT. BOTH THREADS ONLY USE INTERNALLY SYNCHRONIZED DEVICE CALLS, THE
+    // QUEUE, COMMAND POOL, ALLOCATOR & STAGING RING STAY ON THIS THREAD
+    std::future<void> pipelineCreation = std::async(std::launch::async, [this, scenePartitioning]() {
+        measureStartupStage("createPipelineLayout", [this]() {
+            createDescriptorSetLayout();
+            createPipelineLayout();
+        });
+
+        if (isAdaptiveSampling()) {
+            measureStartupStage("createActivePixelPipeline", [this]() { createActivePixelPipeline(); });
+        }
+
+        if (!settings.headless) {
+            measureStartupStage("createResolvePipeline", [this]() { createResolvePipeline(); });
+        }
+
+        scenePartitioning.get();
+        measureStartupStage("createRTPipeline", [this]() { createRTPipeline(); });
+    });
+
+    if (!settings.headless) {
+        measureStartupStage("createSwapChain", [this]() { createSwapChain(); });
+    }
+
+    measureStartupStage("createImages", [this]() {
+        createImages();
+        createActivePixelBuffer();
+        createSummedPixelColorFp64Buffer();
+    });
+
+    scenePartitioning.get();
+
+    if (scene.generation) {
+        measureStartupStage("generateSceneOnDevice", [this, &scene]() {
+            generateSceneOnDevice(*scene.generation);
+        });
+    } else {
+        sceneUploadMilliseconds = measureStartupStage("createSphereBuffer", [this, &scene]() {
+            createSphereBuffer(scene);
+            createAABBBuffer(scene);
+
+            // WAITS FOR THE COPIES, SO THE STAGE MEASURES THE WHOLE UPLOAD
+            stagingRing->flush();
+        });
+
+        sceneUploadBytes = getSphereBufferSize() + sizeof(vk::AabbPositionsKHR) * sphereAmount;
+    }
 
-Vulkan::Vulkan(VulkanSettings settings, Scene scene) :
-        settings(settings), scene(scene), window(nullptr) {
+    measureStartupStage("createRayCounterBuffer", [this]() { createRayCounterBuffer(); });
 
-    aabbs.reserve(scene.sphereAmount);
-    for (int i = 0; i < scene.sphereAmount; i++) {
-        aabbs.push_back(getAABBFromSphere(scene.spheres[i].geometry));
+    // THE STAGE IS ONLY NAMED ONCE IT IS KNOWN WHETHER THE CACHE WAS HIT
+    const auto bottomAccelerationStructureBeginTime = std::chrono::steady_clock::now();
+    createBottomAccelerationStructures(scene);
+    recordStartupStage(bottomAccelerationStructuresFromCache
+                       ? "loadBottomAccelerationStructures"
+                       : "createBottomAccelerationStructures",
+                       std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - bottomAccelerationStructureBeginTime).count());
+    measureStartupStage("createTopAccelerationStructure", [this]() { createTopAccelerationStructure(); });
+
+    if (settings.dynamicScene) {
+        measureStartupStage("createUpdateScratchBuffer", [this]() { createUpdateScratchBuffer(); });
     }
 
-    createWindow();
-    createInstance();
-    createSurface();
-    pickPhysicalDevice();
-    findQueueFamilies();
-    createLogicalDevice();
+    // RETHROWS AN ERROR OF THE PIPELINE THREAD
+    pipelineCreation.get();
 
-    dynamicDispatchLoader = vk::DispatchLoaderDynamic(instance, vkGetInstanceProcAddr, device);
+    measureStartupStage("createDescriptorSet", [this]() {
+        createDescriptorPool();
+        createDescriptorSet();
 
-    createCommandPool();
-    createSwapChain();
-    createImages();
+        if (isAdaptiveSampling()) {
+            createActivePixelDescriptorSet();
+        }
 
-    createAABBBuffer();
-    createBottomAccelerationStructure();
-    createTopAccelerationStructure();
+        if (!settings.headless) {
+            createResolveDescriptorSet();
+        }
+    });
 
-    createSphereBuffer();
-    createRenderCallInfoBuffer();
+    measureStartupStage("createShaderBindingTable", [this]() { createShaderBindingTable(); });
 
-    createDescriptorSetLayout();
-    createDescriptorPool();
-    createDescriptorSet();
-    createPipelineLayout();
-    createRTPipeline();
+    measureStartupStage("createCommandBuffers", [this]() {
+        createCommandBuffers();
+        createQueryPools();
 
-    createShaderBindingTable();
-    createCommandBuffer();
+        createReadbackBuffers();
+        createReadbackCommandBuffer();
 
-    createFence();
-    createSemaphore();
+        createSyncObjects();
+    });
 }
 
 Vulkan::~Vulkan() {
-    std::ranges::for_each(semaphores, [this](auto semaphore) {device.destroySemaphore(semaphore); });
-    device.destroyFence(fence);
+    device.waitIdle();
+
+    savePipelineCache();
+    device.destroyPipelineCache(pipelineCache);
+
+    std::ranges::for_each(framesInFlight, [this](auto frame) {
+        if (frame.imageAvailableSemaphore) {
+            device.destroySemaphore(frame.imageAvailableSemaphore);
+        }
+
+        if (frame.timestampQueryPool) {
+            device.destroyQueryPool(frame.timestampQueryPool);
+        }
+
+        if (frame.counterReadbackBuffer.buffer) {
+            destroyBuffer(frame.counterReadbackBuffer);
+        }
+    });
+    std::ranges::for_each(renderFinishedSemaphores, [this](auto semaphore) {device.destroySemaphore(semaphore); });
+    device.destroySemaphore(timelineSemaphore);
 
     device.destroyPipeline(rtPipeline);
     device.destroyPipelineLayout(rtPipelineLayout);
     device.destroyDescriptorSetLayout(rtDescriptorSetLayout);
     device.destroyDescriptorPool(rtDescriptorPool);
 
-    destroyAccelerationStructure(topAccelerationStructure);
-    destroyAccelerationStructure(bottomAccelerationStructure);
+    if (isAdaptiveSampling()) {
+        device.destroyPipeline(activePixelPipeline);
+        device.destroyPipelineLayout(activePixelPipelineLayout);
+        device.destroyDescriptorSetLayout(activePixelDescriptorSetLayout);
+        device.destroyDescriptorPool(activePixelDescriptorPool);
+    }
+
+    if (!settings.headless) {
+        device.destroyPipeline(resolvePipeline);
+        device.destroyPipelineLayout(resolvePipelineLayout);
+        device.destroyDescriptorSetLayout(resolveDescriptorSetLayout);
+        device.destroyDescriptorPool(resolveDescriptorPool);
+    }
+
+    destroyAccelerationStructures(topAccelerationStructure);
+    destroyAccelerationStructures(bottomAccelerationStructures);
+
+    if (instancesBuffer.buffer) {
+        destroyBuffer(instancesBuffer);
+    }
+
+    if (updateScratchBuffer.buffer) {
+        destroyBuffer(updateScratchBuffer);
+    }
 
     destroyBuffer(sphereBuffer);
+    destroyBuffer(rayCounterBuffer);
+    destroyBuffer(activePixelBuffer);
+    destroyBuffer(summedPixelColorFp64Buffer);
     destroyBuffer(aabbBuffer);
     destroyBuffer(shaderBindingTableBuffer);
-    destroyBuffer(renderCallInfoBuffer);
+
+    destroyBuffer(summedPixelColorReadbackBuffer);
+
+    if (summedPixelColorFp64ReadbackBuffer.buffer) {
+        destroyBuffer(summedPixelColorFp64ReadbackBuffer);
+    }
 
     std::ranges::for_each(swapChainImageViews, [this](auto swapChainImageView) {device.destroyImageView(swapChainImageView); });
-    device.destroySwapchainKHR(swapChain);
+
+    if (swapChain) {
+        device.destroySwapchainKHR(swapChain);
+    }
+
+    stagingRing.reset();
     device.destroyCommandPool(commandPool);
 
     destroyImage(renderTargetImage);
     destroyImage(summedPixelColorImage);
+    destroyImage(summedSquaredLuminanceImage);
+    destroyImage(summedPixelColorErrorImage);
+    destroyImage(summedPixelColorPlanes);
 
+    memoryAllocator.reset();
     device.destroy();
-    instance.destroySurfaceKHR(surface);
+
+    if (surface) {
+        instance.destroySurfaceKHR(surface);
+    }
+
     instance.destroy();
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
 
 void Vulkan::update() {
-    glfwPollEvents();
+    if (window) {
+        glfwPollEvents();
+    }
 }
 
 void Vulkan::render(const RenderCallInfo &renderCallInfo) {
-    updateRenderCallInfoBuffer(renderCallInfo);
-
-    uint32_t swapChainImageIndex = 0;
-    auto semaphore = *semaphores.begin();
-    semaphores.pop_front();
-    semaphores.push_back(semaphore);
-    if (auto [result, index] = device.acquireNextImageKHR(swapChain, UINT64_MAX, semaphore);
-        result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR) {
+    // EVERY TILE IS ITS OWN SUBMIT. ONLY THE LAST ONE OF A RENDER CALL WITH A DUE PRESENT RESOLVES THE PREVIEW & COPIES
+    // IT TO THE SWAP CHAIN, ALL OTHER SUBMITS ONLY TRACE & ACCUMULATE
+    const std::vector<Tile> tiles = tileScheduler.getTiles(renderCallInfo.samplesPerRenderCall);
+    const auto tileCount = static_cast<uint32_t>(tiles.size());
+
+    renderCallsSincePresent++;
+    const bool present = isPresentDue();
+
+    // WITH ADAPTIVE SAMPLING, EVERY TILE SAMPLES AS MANY ENTRIES OF THE ACTIVE PIXEL LIST AS IT HAS PIXELS
+    uint32_t activePixelOffset = 0;
+
+    for (uint32_t tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+        submitTile(renderCallInfo, tiles[tileIndex], tileIndex, tileCount, activePixelOffset,
+                   present && tileIndex + 1 == tileCount);
+
+        activePixelOffset += tiles[tileIndex].width * tiles[tileIndex].height;
+    }
+
+    lastRenderCallInfo = renderCallInfo;
+    accumulatedSamples += renderCallInfo.samplesPerRenderCall;
+
+    if (present) {
+        renderCallsSincePresent = 0;
+        lastPresentTime = std::chrono::steady_clock::now();
+    }
+}
+
+// EVERY presentInterval RENDER CALLS, BUT NOT MORE OFTEN THAN presentRate PER SECOND
+bool Vulkan::isPresentDue() const {
+    if (settings.headless || renderCallsSincePresent < std::max(settings.presentInterval, 1u)) {
+        return false;
+    }
+
+    return settings.presentRate <= 0.0f ||
+           std::chrono::duration<float>(std::chrono::steady_clock::now() - lastPresentTime).count() >=
+           1.0f / settings.presentRate;
+}
+
+// RESOLVES & PRESENTS THE SUMS OF ALL FINISHED RENDER CALLS IN A SUBMIT OF ITS OWN
+void Vulkan::presentAccumulation() {
+    vk::Fence imageAcquiredFence = device.createFence({});
+
+    uint32_t swapChainImageIndex;
+    if (auto [result, index] = device.acquireNextImageKHR(swapChain, UINT64_MAX, nullptr, imageAcquiredFence);
+            result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR) {
+        swapChainImageIndex = index;
+    } else {
+        device.destroyFence(imageAcquiredFence);
+        throw std::runtime_error{"failed to acquire next image"};
+    }
+
+    device.waitForFences(1, &imageAcquiredFence, true, UINT64_MAX);
+    device.destroyFence(imageAcquiredFence);
+
+    // WAITS FOR THE COPY, SO THE PRESENT NEEDS NO SEMAPHORE
+    executeSingleTimeCommand([this, swapChainImageIndex](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        recordPresent(singleTimeCommandBuffer, swapChainImages[swapChainImageIndex], accumulatedSamples);
+    });
+
+    vk::PresentInfoKHR presentInfo = {
+            .swapchainCount = 1,
+            .pSwapchains = &swapChain,
+            .pImageIndices = &swapChainImageIndex
+    };
+
+    presentQueue.presentKHR(presentInfo);
+
+    renderCallsSincePresent = 0;
+    lastPresentTime = std::chrono::steady_clock::now();
+}
+
+void Vulkan::submitTile(const RenderCallInfo &renderCallInfo, const Tile &tile, uint32_t tileIndex,
+                        uint32_t tileCount, uint32_t activePixelOffset, bool present) {
+    FrameInFlight &frame = framesInFlight[currentFrameIndex];
+    currentFrameIndex = (currentFrameIndex + 1) % static_cast<uint32_t>(framesInFlight.size());
+
+    // ONLY BLOCKS IF THIS FRAME'S PREVIOUS SUBMIT IS STILL IN FLIGHT
+    completeFrame(frame);
+
+    std::optional<uint32_t> swapChainImageIndex;
+    if (present) {
+        if (auto [result, index] = device.acquireNextImageKHR(swapChain, UINT64_MAX, frame.imageAvailableSemaphore);
+            result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR) {
             swapChainImageIndex = index;
+        } else {
+            throw std::runtime_error{"failed to acquire next image"};
+        }
     }
-    else {
-        throw std::runtime_error{ "failed to acquire next image" };
+
+    frame.tileProgress = {
+            .renderCallNumber = renderCallInfo.number,
+            .tileIndex = tileIndex,
+            .tileCount = tileCount,
+            .tile = tile,
+            .milliseconds = 0.0
+    };
+    frame.samplesPerRenderCall = renderCallInfo.samplesPerRenderCall;
+    frame.activePixelOffset = activePixelOffset;
+
+    frame.commandBuffer.reset();
+    frame.timestampCount = swapChainImageIndex ? TIMESTAMP_COPY_END + 1 : TIMESTAMP_TRACE_RAYS_END + 1;
+    recordCommandBuffer(frame, renderCallInfo, tile, swapChainImageIndex);
+
+    frame.timelineValue = ++timelineValue;
+    frame.completed = false;
+
+
+    // SUBMIT: SIGNAL THE TIMELINE (AND THE BINARY PRESENT SEMAPHORE WHEN A SWAP CHAIN IMAGE IS USED)
+    std::vector<vk::Semaphore> waitSemaphores;
+    std::vector<vk::PipelineStageFlags> waitStages;
+    std::vector<uint64_t> waitValues;
+
+    std::vector<vk::Semaphore> signalSemaphores = {timelineSemaphore};
+    std::vector<uint64_t> signalValues = {frame.timelineValue};
+
+    if (swapChainImageIndex) {
+        waitSemaphores.push_back(frame.imageAvailableSemaphore);
+        waitStages.emplace_back(vk::PipelineStageFlagBits::eTransfer);
+        waitValues.push_back(0);
+
+        signalSemaphores.push_back(renderFinishedSemaphores[*swapChainImageIndex]);
+        signalValues.push_back(0);
     }
 
-    device.resetFences(fence);
+    vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+            .waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+            .pWaitSemaphoreValues = waitValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+            .pSignalSemaphoreValues = signalValues.data()
+    };
 
     vk::SubmitInfo submitInfo = {
+            .pNext = &timelineSubmitInfo,
+            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+            .pWaitSemaphores = waitSemaphores.data(),
+            .pWaitDstStageMask = waitStages.data(),
             .commandBufferCount = 1,
-            .pCommandBuffers = &commandBuffers[swapChainImageIndex]
+            .pCommandBuffers = &frame.commandBuffer,
+            .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+            .pSignalSemaphores = signalSemaphores.data()
     };
 
-    computeQueue.submit(1, &submitInfo, fence);
+    frame.submitTime = std::chrono::steady_clock::now();
+    computeQueue.submit(1, &submitInfo, nullptr);
 
-    device.waitForFences(1, &fence, true, UINT64_MAX);
-    device.resetFences(fence);
+    if (!swapChainImageIndex) {
+        return;
+    }
 
     vk::PresentInfoKHR presentInfo = {
             .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &semaphore,
+            .pWaitSemaphores = &renderFinishedSemaphores[*swapChainImageIndex],
             .swapchainCount = 1,
             .pSwapchains = &swapChain,
-            .pImageIndices = &swapChainImageIndex
+            .pImageIndices = &*swapChainImageIndex
     };
 
     presentQueue.presentKHR(presentInfo);
-    vk::SubmitInfo wait_to_present = {
+}
+
+void Vulkan::completeFrame(FrameInFlight &frame) {
+    if (frame.completed) {
+        return;
+    }
+
+    const bool stillInFlight = device.getSemaphoreCounterValue(timelineSemaphore) < frame.timelineValue;
+    waitForTimelineValue(frame.timelineValue);
+    frame.completed = true;
+
+    RenderCallProfile tileProfile = getTileProfile(frame);
+
+    // WITHOUT TIMESTAMPS: THE GPU RUNS SUBMITS IN ORDER, SO IF THE HOST HAD TO WAIT, THE TILE RAN FROM ITS SUBMIT
+    // (OR THE PREVIOUS COMPLETION) UNTIL NOW. OTHERWISE THE COMPLETION TIME IS UNKNOWN AND THE TILE IS NOT MEASURED
+    if (stillInFlight) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto beginTime = std::max(frame.submitTime, lastTileCompletionTime);
+
+        if (!timestampsSupported) {
+            tileProfile.milliseconds = std::chrono::duration<double, std::milli>(now - beginTime).count();
+            tileProfile.traceRaysMilliseconds = tileProfile.milliseconds;
+        }
+
+        lastTileCompletionTime = now;
+    }
+
+    frame.tileProgress.milliseconds = tileProfile.milliseconds;
+
+    if (tileProfile.milliseconds > 0.0) {
+        tileScheduler.reportSubmitDuration(frame.tileProgress.tile, frame.samplesPerRenderCall,
+                                           tileProfile.milliseconds);
+    }
+
+    if (tileCompletedCallback) {
+        tileCompletedCallback(frame.tileProgress);
+    }
+
+    // FRAMES COMPLETE IN SUBMISSION ORDER, SO THE TILES OF A RENDER CALL ARRIVE ONE AFTER ANOTHER
+    if (frame.tileProgress.tileIndex == 0) {
+        renderCallProfile = {
+                .renderCallNumber = frame.tileProgress.renderCallNumber,
+                .tileCount = frame.tileProgress.tileCount,
+                .samplesPerRenderCall = frame.samplesPerRenderCall
+        };
+    }
+
+    renderCallProfile.activePixels += tileProfile.activePixels;
+
+    // ONLY THE PART OF THE TILE'S SLICE THAT HOLDS ACTIVE PIXELS IS SAMPLED, THE COUNT CAME WITH THE FIRST TILE
+    if (isAdaptiveSampling()) {
+        const uint64_t slicePixels = static_cast<uint64_t>(frame.tileProgress.tile.width) *
+                                     frame.tileProgress.tile.height;
+        const uint64_t activeSlicePixels = std::min(
+                slicePixels, renderCallProfile.activePixels -
+                             std::min<uint64_t>(renderCallProfile.activePixels, frame.activePixelOffset));
+
+        tileProfile.samples = activeSlicePixels * frame.samplesPerRenderCall;
+    }
+
+    renderCallProfile.samples += tileProfile.samples;
+    renderCallProfile.rays += tileProfile.rays;
+    renderCallProfile.milliseconds += tileProfile.milliseconds;
+    renderCallProfile.barrierMilliseconds += tileProfile.barrierMilliseconds;
+    renderCallProfile.traceRaysMilliseconds += tileProfile.traceRaysMilliseconds;
+    renderCallProfile.copyMilliseconds += tileProfile.copyMilliseconds;
+
+    if (frame.tileProgress.tileIndex + 1 == frame.tileProgress.tileCount && renderCallProfiledCallback) {
+        renderCallProfiledCallback(renderCallProfile);
+    }
+}
+
+RenderCallProfile Vulkan::getTileProfile(const FrameInFlight &frame) const {
+    const Tile &tile = frame.tileProgress.tile;
+
+    RenderCallProfile profile = {
+            .renderCallNumber = frame.tileProgress.renderCallNumber,
+            .tileCount = 1,
+            .samplesPerRenderCall = frame.samplesPerRenderCall,
+            .samples = static_cast<uint64_t>(tile.width) * tile.height * frame.samplesPerRenderCall,
+            .activePixels = static_cast<uint64_t>(tile.width) * tile.height
+    };
+
+    if (settings.countRays) {
+        uint64_t rays;
+        const void* rayCountData = frame.counterReadbackBuffer.allocation.mappedData;
+        memcpy(&rays, rayCountData, sizeof(uint64_t));
+
+        profile.rays = rays;
+    }
+
+    // THE ACTIVE PIXELS OF THE WHOLE RENDER CALL ARE SELECTED BY ITS FIRST TILE
+    if (isAdaptiveSampling()) {
+        uint32_t activePixels = 0;
+        if (frame.tileProgress.tileIndex == 0) {
+            const auto* counterData = static_cast<const uint8_t*>(frame.counterReadbackBuffer.allocation.mappedData);
+            memcpy(&activePixels, counterData + sizeof(uint64_t), sizeof(uint32_t));
+        }
+
+        profile.activePixels = activePixels;
+    }
+
+    if (!timestampsSupported) {
+        return profile;
+    }
+
+    uint64_t timestamps[TIMESTAMP_QUERY_COUNT] = {};
+    const vk::Result result = device.getQueryPoolResults(
+            frame.timestampQueryPool, 0, frame.timestampCount, sizeof(uint64_t) * frame.timestampCount, timestamps,
+            sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+
+    if (result != vk::Result::eSuccess) {
+        return profile;
+    }
+
+    const auto getMilliseconds = [&](TimestampQuery begin, TimestampQuery end) {
+        return static_cast<double>((timestamps[end] - timestamps[begin]) & timestampMask) * timestampPeriod / 1e6;
+    };
+
+    profile.barrierMilliseconds = getMilliseconds(TIMESTAMP_BEGIN, TIMESTAMP_BARRIERS_END);
+    profile.traceRaysMilliseconds = getMilliseconds(TIMESTAMP_BARRIERS_END, TIMESTAMP_TRACE_RAYS_END);
+
+    if (frame.timestampCount > TIMESTAMP_COPY_END) {
+        profile.copyMilliseconds = getMilliseconds(TIMESTAMP_TRACE_RAYS_END, TIMESTAMP_COPY_END);
+    }
+
+    // THE BARRIER TIME OVERLAPS THE PREVIOUS SUBMIT, SO IT IS NOT PART OF THIS TILE'S DEVICE TIME
+    profile.milliseconds = profile.traceRaysMilliseconds + profile.copyMilliseconds;
+    return profile;
+}
+
+void Vulkan::finish() {
+    // COMPLETE THE FRAMES IN SUBMISSION ORDER, STARTING WITH THE OLDEST
+    for (uint32_t i = 0; i < framesInFlight.size(); i++) {
+        completeFrame(framesInFlight[(currentFrameIndex + i) % framesInFlight.size()]);
+    }
+
+    waitForTimelineValue(timelineValue);
+
+    // THE WINDOW SHOWS THE FINAL SUMS, EVEN IF THE PRESENT OF THE LAST RENDER CALL WAS NOT DUE
+    if (!settings.headless && renderCallsSincePresent > 0) {
+        presentAccumulation();
+    }
+}
+
+// STAGES THE CHANGED SPHERES FOR UPLOAD. ONLY CLUSTERS WITH A MOVED OR RESIZED SPHERE ARE REFIT, A CHANGE
+// OF MATERIALS OR COLORS ALONE LEAVES THE ACCELERATION STRUCTURES AS THEY ARE
+void Vulkan::updateScene(std::span<const SceneUpdate> updates) {
+    if (!settings.dynamicScene) {
+        throw std::runtime_error("[Error] The scene can only be updated if the renderer was created for a dynamic "
+                                 "scene!");
+    }
+
+    for (const SceneUpdate &update: updates) {
+        if (update.firstSphere > sphereAmount || update.spheres.size() > sphereAmount - update.firstSphere) {
+            throw std::runtime_error("[Error] Scene update of spheres " + std::to_string(update.firstSphere) + " to " +
+                                     std::to_string(update.firstSphere + update.spheres.size()) +
+                                     " is out of the scene's " + std::to_string(sphereAmount) + " spheres!");
+        }
+    }
+
+    // SUBMITTED RENDER CALLS STILL READ THE BUFFERS & STRUCTURES
+    finish();
+
+    // SPHERES FIRST, THEN THE AABBS OF THE MOVED ONES, SO NEIGHBORING LOCATIONS SHARE THEIR COPY REGIONS
+    std::vector<uint32_t> movedLocations;
+
+    for (const SceneUpdate &update: updates) {
+        for (uint32_t i = 0; i < update.spheres.size(); i++) {
+            const uint32_t sceneIndex = update.firstSphere + i;
+            const uint32_t location = sphereLocations.empty() ? sceneIndex : sphereLocations[sceneIndex];
+
+            *static_cast<Sphere*>(stagingRing->stage(sphereBuffer.buffer, location * sizeof(Sphere),
+                                                     sizeof(Sphere))) = update.spheres[i];
+
+            if (update.spheres[i].geometry != sphereGeometries[location]) {
+                sphereGeometries[location] = update.spheres[i].geometry;
+                movedLocations.push_back(location);
+            }
+        }
+    }
+
+    std::vector<bool> isClusterDirty(scenePartition.clusters.size(), false);
+
+    for (const uint32_t location: movedLocations) {
+        *static_cast<vk::AabbPositionsKHR*>(stagingRing->stage(aabbBuffer.buffer,
+                                                               location * sizeof(vk::AabbPositionsKHR),
+                                                               sizeof(vk::AabbPositionsKHR))) =
+                getAABBFromSphere(sphereGeometries[location]);
+
+        // THE CLUSTERS ARE SORTED BY THEIR FIRST SPHERE
+        const auto cluster = std::upper_bound(scenePartition.clusters.begin(), scenePartition.clusters.end(),
+                                              location, [](uint32_t sphere, const SceneCluster &cluster) {
+                                                  return sphere < cluster.firstSphere;
+                                              }) - 1;
+        isClusterDirty[cluster - scenePartition.clusters.begin()] = true;
+    }
+
+    stagingRing->submit();
+
+    std::vector<uint32_t> dirtyClusters;
+    for (uint32_t cluster = 0; cluster < isClusterDirty.size(); cluster++) {
+        if (isClusterDirty[cluster]) {
+            dirtyClusters.push_back(cluster);
+        }
+    }
+
+    if (!dirtyClusters.empty()) {
+        refitAccelerationStructures(dirtyClusters);
+    }
+}
+
+void Vulkan::setTileCompletedCallback(std::function<void(const TileProgress &)> callback) {
+    tileCompletedCallback = std::move(callback);
+}
+
+uint32_t Vulkan::getTileSize() const {
+    return tileScheduler.getTileSize();
+}
+
+void Vulkan::setRenderCallProfiledCallback(std::function<void(const RenderCallProfile &)> callback) {
+    renderCallProfiledCallback = std::move(callback);
+}
+
+double Vulkan::measureStartupStage(const std::string &stage, const std::function<void()> &function) {
+    const auto beginTime = std::chrono::steady_clock::now();
+    function();
+
+    const double milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - beginTime).count();
+    recordStartupStage(stage, milliseconds);
+
+    return milliseconds;
+}
+
+void Vulkan::recordStartupStage(const std::string &stage, double milliseconds) {
+    std::lock_guard<std::mutex> lock(startupTimingsMutex);
+    startupTimings.push_back({.stage = stage, .milliseconds = milliseconds});
+}
+
+RendererInfo Vulkan::getRendererInfo() const {
+    vk::PhysicalDeviceDriverProperties driverProperties = {};
+
+    vk::PhysicalDeviceProperties2 physicalDeviceProperties2 = {
+            .pNext = &driverProperties
+    };
+
+    physicalDevice.getProperties2(&physicalDeviceProperties2);
+
+    const VulkanMemoryStatistics memoryStatistics = memoryAllocator->getStatistics();
+
+    return {
+            .backend = "gpu",
+            .deviceName = static_cast<std::string>(physicalDeviceProperties2.properties.deviceName),
+            .driverVersion = static_cast<std::string>(driverProperties.driverName) + " " +
+                             static_cast<std::string>(driverProperties.driverInfo),
+            .imageWidth = settings.windowWidth,
+            .imageHeight = settings.windowHeight,
+            .startupTimings = startupTimings,
+            .allocatedMemory = memoryStatistics.allocatedBytes,
+            .reservedMemory = memoryStatistics.reservedBytes,
+            .memoryBlockCount = memoryStatistics.blockCount,
+            .dedicatedAllocationCount = memoryStatistics.dedicatedAllocationCount,
+            .memoryFragmentation = memoryStatistics.fragmentation,
+            .deviceMemoryUsage = memoryStatistics.deviceLocalUsage,
+            .deviceMemoryBudget = memoryStatistics.deviceLocalBudget,
+            .sceneUploadBytes = sceneUploadBytes,
+            .sceneUploadMilliseconds = sceneUploadMilliseconds,
+            .accelerationStructureMemory = accelerationStructureMemory,
+            .uncompactedAccelerationStructureMemory = uncompactedAccelerationStructureMemory,
+            .bottomAccelerationStructureCount = static_cast<uint32_t>(scenePartition.clusters.size()),
+            .instanceCount = static_cast<uint32_t>(scenePartition.instances.size()),
+            .hitGroupCount = static_cast<uint32_t>(hitGroupMaterialVariants.size()),
+            .accumulationMemory = renderTargetImage.allocation.size + summedPixelColorImage.allocation.size +
+                                  summedSquaredLuminanceImage.allocation.size +
+                                  summedPixelColorErrorImage.allocation.size + summedPixelColorPlanes.allocation.size +
+                                  summedPixelColorFp64Buffer.allocation.size,
+            .accumulationBytesPerPixel = getAccumulationBytesPerPixel()
     };
-    presentQueue.submit(wait_to_present, fence);
-    device.waitForFences(1, &fence, true, UINT64_MAX);
-    device.resetFences(fence);
 }
 
 bool Vulkan::shouldExit() const {
-    return glfwWindowShouldClose(window);
+    return !window || glfwWindowShouldClose(window);
+}
+
+void Vulkan::requestReadback() {
+    if (readbackPending) {
+        throw std::runtime_error("A readback is already pending!");
+    }
+
+    // THE COPY IS ORDERED AFTER THE LAST RENDER CALL ON THE SAME QUEUE, THE HOST DOES NOT WAIT FOR IT HERE
+    readbackTimelineValue = ++timelineValue;
+
+    vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &readbackTimelineValue
+    };
+
+    vk::SubmitInfo submitInfo = {
+            .pNext = &timelineSubmitInfo,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &readbackCommandBuffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &timelineSemaphore
+    };
+
+    computeQueue.submit(1, &submitInfo, nullptr);
+
+    readbackRenderCallInfo = lastRenderCallInfo;
+    readbackAccumulatedSamples = accumulatedSamples;
+    readbackPending = true;
+}
+
+bool Vulkan::isReadbackPending() const {
+    return readbackPending;
+}
+
+std::optional<RenderOutput> Vulkan::pollReadback() {
+    if (!readbackPending || device.getSemaphoreCounterValue(timelineSemaphore) < readbackTimelineValue) {
+        return std::nullopt;
+    }
+
+    return collectReadback();
+}
+
+RenderOutput Vulkan::waitForReadback() {
+    if (!readbackPending) {
+        throw std::runtime_error("No readback has been requested!");
+    }
+
+    waitForTimelineValue(readbackTimelineValue);
+    return collectReadback();
+}
+
+std::vector<const char*> Vulkan::getDeviceExtensions() const {
+    std::vector<const char*> deviceExtensions = requiredDeviceExtensions;
+
+    if (!settings.headless) {
+        deviceExtensions.insert(deviceExtensions.end(), presentationDeviceExtensions.begin(),
+                                presentationDeviceExtensions.end());
+    }
+
+    return deviceExtensions;
 }
 
 void Vulkan::createWindow() {
@@ -165,10 +782,12 @@ void Vulkan::createInstance() {
 
     std::vector<const char*> enabledExtensions;
 
-    uint32_t windowExtensionCount;
-    const char** windowExtensions = glfwGetRequiredInstanceExtensions(&windowExtensionCount);
+    if (!settings.headless) {
+        uint32_t windowExtensionCount;
+        const char** windowExtensions = glfwGetRequiredInstanceExtensions(&windowExtensionCount);
 
-    enabledExtensions.insert(enabledExtensions.end(), windowExtensions, windowExtensions + windowExtensionCount);
+        enabledExtensions.insert(enabledExtensions.end(), windowExtensions, windowExtensions + windowExtensionCount);
+    }
     enabledExtensions.insert(enabledExtensions.end(), requiredInstanceExtensions.begin(),
                              requiredInstanceExtensions.end());
 
@@ -218,10 +837,12 @@ void Vulkan::pickPhysicalDevice() {
         throw std::runtime_error("No GPU with Vulkan support found!");
     }
 
+    const std::vector<const char*> deviceExtensions = getDeviceExtensions();
+
     std::vector<vk::PhysicalDevice> withRequiredExtensionsPhysicalDevices{};
     for (const vk::PhysicalDevice &d: allPhysicalDevices) {
         std::vector<vk::ExtensionProperties> availableExtensions = d.enumerateDeviceExtensionProperties();
-        std::set<std::string> requiredExtensions(requiredDeviceExtensions.begin(), requiredDeviceExtensions.end());
+        std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
         for (const vk::ExtensionProperties &extension: availableExtensions) {
             requiredExtensions.erase(extension.extensionName);
@@ -258,7 +879,8 @@ void Vulkan::findQueueFamilies() {
                                 == vk::QueueFlagBits::eGraphics;
         bool supportsCompute = (queueFamilies[i].queueFlags & vk::QueueFlagBits::eCompute)
                                == vk::QueueFlagBits::eCompute;
-        bool supportsPresenting = physicalDevice.getSurfaceSupportKHR(static_cast<uint32_t>(i), surface);
+        bool supportsPresenting = !settings.headless &&
+                                  physicalDevice.getSurfaceSupportKHR(static_cast<uint32_t>(i), surface);
 
         if (supportsCompute && !supportsGraphics && !computeFamilyFound) {
             computeQueueFamily = i;
@@ -274,33 +896,75 @@ void Vulkan::findQueueFamilies() {
         if (computeFamilyFound && presentFamilyFound)
             break;
     }
+
+    // FALL BACK TO A COMBINED GRAPHICS & COMPUTE FAMILY (E.G. LAVAPIPE)
+    if (!computeFamilyFound) {
+        for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+            if (queueFamilies[i].queueFlags & vk::QueueFlagBits::eCompute) {
+                computeQueueFamily = i;
+                computeFamilyFound = true;
+                break;
+            }
+        }
+    }
+
+    if (!computeFamilyFound) {
+        throw std::runtime_error("No queue family with compute support found!");
+    }
+
+    // HEADLESS: THE PRESENT QUEUE IS NEVER USED FOR PRESENTING
+    if (settings.headless) {
+        presentQueueFamily = computeQueueFamily;
+    }
 }
 
 void Vulkan::createLogicalDevice() {
     float queuePriority = 1.0f;
-    std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos = {
-            {
-                    .queueFamilyIndex = presentQueueFamily,
-                    .queueCount = 1,
-                    .pQueuePriorities = &queuePriority
-            },
-            {
-                    .queueFamilyIndex = computeQueueFamily,
-                    .queueCount = 1,
-                    .pQueuePriorities = &queuePriority
-            }
-    };
+    std::set<uint32_t> queueFamilies = {presentQueueFamily, computeQueueFamily};
+
+    std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
+    for (uint32_t queueFamily: queueFamilies) {
+        queueCreateInfos.push_back(
+                {
+                        .queueFamilyIndex = queueFamily,
+                        .queueCount = 1,
+                        .pQueuePriorities = &queuePriority
+                });
+    }
 
-    vk::PhysicalDeviceFeatures deviceFeatures = {};
+    std::vector<const char*> deviceExtensions = getDeviceExtensions();
 
-    vk::PhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures = {
-            .bufferDeviceAddress = true,
-            .bufferDeviceAddressCaptureReplay = false,
-            .bufferDeviceAddressMultiDevice = false
+    // OPTIONAL: ONLY REPORTS THE MEMORY BUDGET
+    const std::vector<vk::ExtensionProperties> availableExtensions =
+            physicalDevice.enumerateDeviceExtensionProperties();
+    memoryBudgetSupported = std::ranges::any_of(availableExtensions, [](const vk::ExtensionProperties &extension) {
+        return static_cast<std::string>(extension.extensionName) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    });
+
+    if (memoryBudgetSupported) {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    vk::PhysicalDeviceFeatures deviceFeatures = {};
+
+    // ONLY THE FP64 VARIANT OF THE RAY GENERATION SHADER USES FP64 ARITHMETIC
+    if (settings.accumulationPrecision == ACCUMULATION_FP64) {
+        if (!physicalDevice.getFeatures().shaderFloat64) {
+            throw std::runtime_error("[Error] FP64 accumulation needs a GPU with shaderFloat64, use fp32, kahan or split!");
+        }
+
+        deviceFeatures.shaderFloat64 = true;
+    }
+
+    vk::PhysicalDeviceVulkan12Features vulkan12Features = {
+            .timelineSemaphore = true,
+            .bufferDeviceAddress = true,
+            .bufferDeviceAddressCaptureReplay = false,
+            .bufferDeviceAddressMultiDevice = false
     };
 
     vk::PhysicalDeviceRayTracingPipelineFeaturesKHR rayTracingPipelineFeatures = {
-            .pNext = &bufferDeviceAddressFeatures,
+            .pNext = &vulkan12Features,
             .rayTracingPipeline = true
     };
 
@@ -317,8 +981,8 @@ void Vulkan::createLogicalDevice() {
             .pNext = &accelerationStructureFeatures,
             .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
             .pQueueCreateInfos = queueCreateInfos.data(),
-            .enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size()),
-            .ppEnabledExtensionNames = requiredDeviceExtensions.data(),
+            .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+            .ppEnabledExtensionNames = deviceExtensions.data(),
             .pEnabledFeatures = &deviceFeatures
     };
 
@@ -329,7 +993,11 @@ void Vulkan::createLogicalDevice() {
 }
 
 void Vulkan::createCommandPool() {
-    commandPool = device.createCommandPool({.queueFamilyIndex = computeQueueFamily});
+    commandPool = device.createCommandPool(
+            {
+                    .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+                    .queueFamilyIndex = computeQueueFamily
+            });
 }
 
 void Vulkan::createSwapChain() {
@@ -363,30 +1031,25 @@ void Vulkan::createSwapChain() {
     );
 }
 
-vk::ImageView Vulkan::createImageView(const vk::Image &image, const vk::Format &format) const {
+vk::ImageView Vulkan::createImageView(const vk::Image &image, const vk::Format &format, uint32_t layerCount) const {
     return device.createImageView(
             {
                     .image = image,
-                    .viewType = vk::ImageViewType::e2D,
+                    .viewType = layerCount > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D,
                     .format = format,
                     .subresourceRange = {
                             .aspectMask = vk::ImageAspectFlagBits::eColor,
                             .baseMipLevel = 0,
                             .levelCount = 1,
                             .baseArrayLayer = 0,
-                            .layerCount = 1
+                            .layerCount = layerCount
                     }
             });
 }
 
 void Vulkan::createDescriptorSetLayout() {
+    // THE RENDER TARGET (BINDING 0 OF resolve.comp) IS NOT PART OF THE RAY TRACING SET, TRACING NEVER WRITES IT
     std::vector<vk::DescriptorSetLayoutBinding> bindings = {
-            {
-                    .binding = 0,
-                    .descriptorType = vk::DescriptorType::eStorageImage,
-                    .descriptorCount = 1,
-                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
-            },
             {
                     .binding = 1,
                     .descriptorType = vk::DescriptorType::eAccelerationStructureKHR,
@@ -395,7 +1058,7 @@ void Vulkan::createDescriptorSetLayout() {
             },
             {
                     .binding = 2,
-                    .descriptorType = vk::DescriptorType::eUniformBuffer,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
                     .descriptorCount = 1,
                     .stageFlags = vk::ShaderStageFlagBits::eIntersectionKHR |
                                   vk::ShaderStageFlagBits::eClosestHitKHR
@@ -408,7 +1071,37 @@ void Vulkan::createDescriptorSetLayout() {
             },
             {
                     .binding = 4,
-                    .descriptorType = vk::DescriptorType::eUniformBuffer,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
+            },
+            {
+                    .binding = 5,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
+            },
+            {
+                    .binding = 6,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
+            },
+            {
+                    .binding = 7,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
+            },
+            {
+                    .binding = 8,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
+            },
+            {
+                    .binding = 9,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
                     .descriptorCount = 1,
                     .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR
             }
@@ -425,15 +1118,15 @@ void Vulkan::createDescriptorPool() {
     std::vector<vk::DescriptorPoolSize> poolSizes = {
             {
                     .type = vk::DescriptorType::eStorageImage,
-                    .descriptorCount = 2
+                    .descriptorCount = 4
             },
             {
                     .type = vk::DescriptorType::eAccelerationStructureKHR,
                     .descriptorCount = 1
             },
             {
-                    .type = vk::DescriptorType::eUniformBuffer,
-                    .descriptorCount = 2
+                    .type = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 4
             }
     };
 
@@ -453,21 +1146,15 @@ void Vulkan::createDescriptorSet() {
                     .pSetLayouts = &rtDescriptorSetLayout
             }).front();
 
-
-    vk::DescriptorImageInfo renderTargetImageInfo = {
-            .imageView = renderTargetImage.imageView,
-            .imageLayout = vk::ImageLayout::eGeneral
-    };
-
     vk::WriteDescriptorSetAccelerationStructureKHR accelerationStructureInfo = {
             .accelerationStructureCount = 1,
-            .pAccelerationStructures = &topAccelerationStructure.accelerationStructure
+            .pAccelerationStructures = &topAccelerationStructure.accelerationStructures.front()
     };
 
     vk::DescriptorBufferInfo sphereBufferInfo = {
             .buffer = sphereBuffer.buffer,
             .offset = 0,
-            .range = sizeof(Sphere) * MAX_SPHERE_AMOUNT
+            .range = VK_WHOLE_SIZE
     };
 
     vk::DescriptorImageInfo summedPixelColorImageInfo = {
@@ -475,21 +1162,40 @@ void Vulkan::createDescriptorSet() {
             .imageLayout = vk::ImageLayout::eGeneral
     };
 
-    vk::DescriptorBufferInfo renderCallInfoBufferInfo = {
-            .buffer = renderCallInfoBuffer.buffer,
+    vk::DescriptorBufferInfo rayCounterBufferInfo = {
+            .buffer = rayCounterBuffer.buffer,
+            .offset = 0,
+            .range = sizeof(uint64_t)
+    };
+
+    vk::DescriptorImageInfo summedSquaredLuminanceImageInfo = {
+            .imageView = summedSquaredLuminanceImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    vk::DescriptorBufferInfo activePixelBufferInfo = {
+            .buffer = activePixelBuffer.buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE
+    };
+
+    vk::DescriptorImageInfo summedPixelColorErrorImageInfo = {
+            .imageView = summedPixelColorErrorImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    vk::DescriptorBufferInfo summedPixelColorFp64BufferInfo = {
+            .buffer = summedPixelColorFp64Buffer.buffer,
             .offset = 0,
-            .range = sizeof(RenderCallInfo)
+            .range = VK_WHOLE_SIZE
+    };
+
+    vk::DescriptorImageInfo summedPixelColorPlanesInfo = {
+            .imageView = summedPixelColorPlanes.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
     };
 
     std::vector<vk::WriteDescriptorSet> descriptorWrites = {
-            {
-                    .dstSet = rtDescriptorSet,
-                    .dstBinding = 0,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eStorageImage,
-                    .pImageInfo = &renderTargetImageInfo
-            },
             {
                     .pNext = &accelerationStructureInfo,
                     .dstSet = rtDescriptorSet,
@@ -503,7 +1209,7 @@ void Vulkan::createDescriptorSet() {
                     .dstBinding = 2,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eUniformBuffer,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
                     .pBufferInfo = &sphereBufferInfo
             },
             {
@@ -519,8 +1225,48 @@ void Vulkan::createDescriptorSet() {
                     .dstBinding = 4,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eUniformBuffer,
-                    .pBufferInfo = &renderCallInfoBufferInfo
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &rayCounterBufferInfo
+            },
+            {
+                    .dstSet = rtDescriptorSet,
+                    .dstBinding = 5,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedSquaredLuminanceImageInfo
+            },
+            {
+                    .dstSet = rtDescriptorSet,
+                    .dstBinding = 6,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &activePixelBufferInfo
+            },
+            {
+                    .dstSet = rtDescriptorSet,
+                    .dstBinding = 7,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedPixelColorErrorImageInfo
+            },
+            {
+                    .dstSet = rtDescriptorSet,
+                    .dstBinding = 8,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &summedPixelColorFp64BufferInfo
+            },
+            {
+                    .dstSet = rtDescriptorSet,
+                    .dstBinding = 9,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedPixelColorPlanesInfo
             }
     };
 
@@ -529,26 +1275,153 @@ void Vulkan::createDescriptorSet() {
 }
 
 void Vulkan::createPipelineLayout() {
+    // THE RENDER CALL INFO IS PUSHED PER COMMAND BUFFER, SO FRAMES IN FLIGHT NEVER SHARE A UNIFORM BUFFER
+    vk::PushConstantRange renderCallInfoRange = {
+            .stageFlags = vk::ShaderStageFlagBits::eRaygenKHR,
+            .offset = 0,
+            .size = sizeof(RenderCallPushConstants)
+    };
+
     rtPipelineLayout = device.createPipelineLayout(
             {
                     .setLayoutCount = 1,
                     .pSetLayouts = &rtDescriptorSetLayout,
-                    .pushConstantRangeCount = 0,
-                    .pPushConstantRanges = nullptr
+                    .pushConstantRangeCount = 1,
+                    .pPushConstantRanges = &renderCallInfoRange
             });
 }
 
 void Vulkan::createRTPipeline() {
-    vk::ShaderModule raygenModule = createShaderModule(rgen_shader_path);
+    vk::ShaderModule raygenModule = createShaderModule(
+            settings.accumulationPrecision == ACCUMULATION_FP64 ? rgen_fp64_shader_path : rgen_shader_path);
     vk::ShaderModule intModule = createShaderModule(rint_shader_path);
     vk::ShaderModule chitModule = createShaderModule(rchit_shader_path);
     vk::ShaderModule missModule = createShaderModule(rmiss_shader_path);
 
+    // constant_id = 0: COUNT_RAYS (WITHOUT IT THE ATOMIC IS COMPILED OUT), constant_id = 1: MAX_DEPTH,
+    // constant_id = 2: ROULETTE_DEPTH, constant_id = 3: ADAPTIVE_SAMPLING, constant_id = 4: SAMPLER (random.glsl),
+    // constant_id = 5: ACCUMULATION, constant_id = 6: COMPACT_ACCUMULATION
+    struct RaygenSpecializationData {
+        vk::Bool32 countRays;
+        uint32_t maxDepth;
+        uint32_t rouletteDepth;
+        vk::Bool32 adaptiveSampling;
+        uint32_t sampler;
+        uint32_t accumulationPrecision;
+        vk::Bool32 compactAccumulation;
+    };
+
+    const RaygenSpecializationData raygenSpecializationData = {
+            .countRays = settings.countRays,
+            .maxDepth = settings.maxDepth,
+            .rouletteDepth = settings.rouletteDepth,
+            .adaptiveSampling = isAdaptiveSampling(),
+            .sampler = settings.sampler,
+            .accumulationPrecision = settings.accumulationPrecision,
+            .compactAccumulation = isCompactAccumulation()
+    };
+
+    std::vector<vk::SpecializationMapEntry> raygenMapEntries = {
+            {
+                    .constantID = 0,
+                    .offset = offsetof(RaygenSpecializationData, countRays),
+                    .size = sizeof(vk::Bool32)
+            },
+            {
+                    .constantID = 1,
+                    .offset = offsetof(RaygenSpecializationData, maxDepth),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 2,
+                    .offset = offsetof(RaygenSpecializationData, rouletteDepth),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 3,
+                    .offset = offsetof(RaygenSpecializationData, adaptiveSampling),
+                    .size = sizeof(vk::Bool32)
+            },
+            {
+                    .constantID = 4,
+                    .offset = offsetof(RaygenSpecializationData, sampler),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 5,
+                    .offset = offsetof(RaygenSpecializationData, accumulationPrecision),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 6,
+                    .offset = offsetof(RaygenSpecializationData, compactAccumulation),
+                    .size = sizeof(vk::Bool32)
+            }
+    };
+
+    vk::SpecializationInfo raygenSpecializationInfo = {
+            .mapEntryCount = static_cast<uint32_t>(raygenMapEntries.size()),
+            .pMapEntries = raygenMapEntries.data(),
+            .dataSize = sizeof(RaygenSpecializationData),
+            .pData = &raygenSpecializationData
+    };
+
+    // constant_id = 0: MATERIAL_TYPE, constant_id = 1: TEXTURE_TYPE, constant_id = 4: SAMPLER (random.glsl). THE MIXED
+    // VARIANT ONLY SPECIALIZES THE SAMPLER & KEEPS THE OTHER DEFAULTS, SO IT READS BOTH TYPES FROM THE SPHERE
+    struct ClosestHitSpecializationData {
+        uint32_t materialType;
+        uint32_t textureType;
+        uint32_t sampler;
+    };
+
+    std::vector<vk::SpecializationMapEntry> closestHitMapEntries = {
+            {
+                    .constantID = 0,
+                    .offset = offsetof(ClosestHitSpecializationData, materialType),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 1,
+                    .offset = offsetof(ClosestHitSpecializationData, textureType),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 4,
+                    .offset = offsetof(ClosestHitSpecializationData, sampler),
+                    .size = sizeof(uint32_t)
+            }
+    };
+
+    std::vector<ClosestHitSpecializationData> closestHitSpecializationData;
+    for (uint32_t materialVariant: hitGroupMaterialVariants) {
+        closestHitSpecializationData.push_back(
+                {
+                        .materialType = materialVariant / TEXTURE_TYPE_COUNT,
+                        .textureType = materialVariant % TEXTURE_TYPE_COUNT,
+                        .sampler = settings.sampler
+                });
+    }
+
+    std::vector<vk::SpecializationInfo> closestHitSpecializationInfos;
+    for (uint32_t hitGroup = 0; hitGroup < hitGroupMaterialVariants.size(); hitGroup++) {
+        const bool mixed = hitGroupMaterialVariants[hitGroup] == MIXED_MATERIAL_VARIANT;
+
+        // THE SAMPLER IS THE LAST MAP ENTRY
+        closestHitSpecializationInfos.push_back(
+                {
+                        .mapEntryCount = mixed ? 1 : static_cast<uint32_t>(closestHitMapEntries.size()),
+                        .pMapEntries = mixed ? &closestHitMapEntries.back() : closestHitMapEntries.data(),
+                        .dataSize = sizeof(ClosestHitSpecializationData),
+                        .pData = &closestHitSpecializationData[hitGroup]
+                });
+    }
+
     std::vector<vk::PipelineShaderStageCreateInfo> stages = {
             {
                     .stage = vk::ShaderStageFlagBits::eRaygenKHR,
                     .module = raygenModule,
-                    .pName = "main"
+                    .pName = "main",
+                    .pSpecializationInfo = &raygenSpecializationInfo
             },
             {
                     .stage = vk::ShaderStageFlagBits::eIntersectionKHR,
@@ -559,14 +1432,20 @@ void Vulkan::createRTPipeline() {
                     .stage = vk::ShaderStageFlagBits::eMissKHR,
                     .module = missModule,
                     .pName = "main"
-            },
-            {
-                    .stage = vk::ShaderStageFlagBits::eClosestHitKHR,
-                    .module = chitModule,
-                    .pName = "main"
             }
     };
 
+    // STAGES 0 - 2 ARE SHARED, ONE CLOSEST HIT STAGE PER HIT GROUP FOLLOWS
+    for (uint32_t hitGroup = 0; hitGroup < hitGroupMaterialVariants.size(); hitGroup++) {
+        stages.push_back(
+                {
+                        .stage = vk::ShaderStageFlagBits::eClosestHitKHR,
+                        .module = chitModule,
+                        .pName = "main",
+                        .pSpecializationInfo = &closestHitSpecializationInfos[hitGroup]
+                });
+    }
+
     std::vector<vk::RayTracingShaderGroupCreateInfoKHR> groups = {
             {
                     .type = vk::RayTracingShaderGroupTypeKHR::eGeneral,
@@ -581,16 +1460,20 @@ void Vulkan::createRTPipeline() {
                     .closestHitShader = VK_SHADER_UNUSED_KHR,
                     .anyHitShader = VK_SHADER_UNUSED_KHR,
                     .intersectionShader = VK_SHADER_UNUSED_KHR
-            },
-            {
-                    .type = vk::RayTracingShaderGroupTypeKHR::eProceduralHitGroup,
-                    .generalShader = VK_SHADER_UNUSED_KHR,
-                    .closestHitShader = 3,
-                    .anyHitShader = VK_SHADER_UNUSED_KHR,
-                    .intersectionShader = 1
             }
     };
 
+    for (uint32_t hitGroup = 0; hitGroup < hitGroupMaterialVariants.size(); hitGroup++) {
+        groups.push_back(
+                {
+                        .type = vk::RayTracingShaderGroupTypeKHR::eProceduralHitGroup,
+                        .generalShader = VK_SHADER_UNUSED_KHR,
+                        .closestHitShader = 3 + hitGroup,
+                        .anyHitShader = VK_SHADER_UNUSED_KHR,
+                        .intersectionShader = 1
+                });
+    }
+
     vk::PipelineLibraryCreateInfoKHR libraryCreateInfo = {.libraryCount = 0};
 
     vk::RayTracingPipelineCreateInfoKHR pipelineCreateInfo = {
@@ -606,8 +1489,23 @@ void Vulkan::createRTPipeline() {
             .basePipelineIndex = 0
     };
 
-    rtPipeline = device.createRayTracingPipelineKHR(nullptr, nullptr, pipelineCreateInfo,
-                                                    nullptr, dynamicDispatchLoader).value;
+    // THE DRIVER SPLITS THE COMPILATION INTO WORK THAT HOST THREADS JOIN. THE CREATE INFOS MUST OUTLIVE THE OPERATION,
+    // SO IT IS COMPLETED HERE
+    vk::DeferredOperationKHR deferredOperation = device.createDeferredOperationKHR(nullptr, dynamicDispatchLoader);
+
+    vk::Result result = device.createRayTracingPipelinesKHR(deferredOperation, pipelineCache, 1, &pipelineCreateInfo,
+                                                            nullptr, &rtPipeline, dynamicDispatchLoader);
+
+    if (result == vk::Result::eOperationDeferredKHR) {
+        joinDeferredOperation(deferredOperation);
+        result = device.getDeferredOperationResultKHR(deferredOperation, dynamicDispatchLoader);
+    }
+
+    device.destroyDeferredOperationKHR(deferredOperation, nullptr, dynamicDispatchLoader);
+
+    if (result != vk::Result::eSuccess && result != vk::Result::eOperationNotDeferredKHR) {
+        throw std::runtime_error("[Error] Failed to create the ray tracing pipeline: " + vk::to_string(result));
+    }
 
     device.destroyShaderModule(raygenModule);
     device.destroyShaderModule(chitModule);
@@ -615,138 +1513,844 @@ void Vulkan::createRTPipeline() {
     device.destroyShaderModule(intModule);
 }
 
-std::vector<char> Vulkan::readBinaryFile(const std::string &path) {
-    std::ifstream file(path, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open())
-        throw std::runtime_error("[Error] Failed to open file at '" + path + "'!");
-
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
+void Vulkan::createActivePixelPipeline() {
+    // THE SELECTION RESERVES ITS LIST ENTRIES WITH ONE ATOMIC PER SUBGROUP
+    vk::PhysicalDeviceSubgroupProperties subgroupProperties = {};
 
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
+    vk::PhysicalDeviceProperties2 physicalDeviceProperties2 = {
+            .pNext = &subgroupProperties
+    };
 
-    file.close();
+    physicalDevice.getProperties2(&physicalDeviceProperties2);
 
-    return buffer;
-}
+    if (!(subgroupProperties.supportedStages & vk::ShaderStageFlagBits::eCompute) ||
+        !(subgroupProperties.supportedOperations & vk::SubgroupFeatureFlagBits::eBallot)) {
+        throw std::runtime_error("[Error] Adaptive sampling needs subgroup ballot operations in compute shaders!");
+    }
 
-void Vulkan::createCommandBuffer() {
-    commandBuffers.resize(swapChainImages.size());
-    for (int swapChainImageIndex = 0; swapChainImageIndex < swapChainImages.size(); swapChainImageIndex++) {
-        auto& commandBuffer = commandBuffers[swapChainImageIndex];
-        auto& swapChainImage = swapChainImages[swapChainImageIndex];
-        commandBuffer = device.allocateCommandBuffers(
+    std::vector<vk::DescriptorSetLayoutBinding> bindings = {
             {
-                    .commandPool = commandPool,
-                    .level = vk::CommandBufferLevel::ePrimary,
-                    .commandBufferCount = 1
-            }).front();
-
-        vk::CommandBufferBeginInfo beginInfo = {};
-        commandBuffer.begin(&beginInfo);
-
-        // RENDER TARGET IMAGE & SUMMED PIXEL COLOR IMAGE: UNDEFINED -> GENERAL
-        vk::ImageMemoryBarrier imageBarriersToGeneral[2] = {
-                getImagePipelineBarrier(
-                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eShaderWrite,
-                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, renderTargetImage.image),
-                getImagePipelineBarrier(
-                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eShaderWrite,
-                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, summedPixelColorImage.image)
-        };
-
-        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eRayTracingShaderKHR,
-            vk::PipelineStageFlagBits::eRayTracingShaderKHR,
-            vk::DependencyFlagBits::eByRegion, 0, nullptr,
-            0, nullptr, 2, imageBarriersToGeneral);
-
+                    .binding = 0,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            {
+                    .binding = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            {
+                    .binding = 2,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+    };
 
-        // RAY TRACING
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eRayTracingKHR, rtPipeline);
+    activePixelDescriptorSetLayout = device.createDescriptorSetLayout(
+            {
+                    .bindingCount = static_cast<uint32_t>(bindings.size()),
+                    .pBindings = bindings.data()
+            });
 
-        std::vector<vk::DescriptorSet> descriptorSets = { rtDescriptorSet };
-        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eRayTracingKHR, rtPipelineLayout,
-            0, descriptorSets, nullptr);
+    vk::PushConstantRange pushConstantRange = {
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .offset = 0,
+            .size = sizeof(ActivePixelSelectionPushConstants)
+    };
 
-        commandBuffer.traceRaysKHR(sbtRayGenAddressRegion, sbtMissAddressRegion, sbtHitAddressRegion, {},
-            settings.windowWidth, settings.windowHeight, 1, dynamicDispatchLoader);
+    activePixelPipelineLayout = device.createPipelineLayout(
+            {
+                    .setLayoutCount = 1,
+                    .pSetLayouts = &activePixelDescriptorSetLayout,
+                    .pushConstantRangeCount = 1,
+                    .pPushConstantRanges = &pushConstantRange
+            });
 
+    vk::ShaderModule computeModule = createShaderModule(select_active_pixels_shader_path);
 
-        // RENDER TARGET IMAGE: GENERAL -> TRANSFER SRC & SWAP CHAIN IMAGE: UNDEFINED -> TRANSFER DST
-        vk::ImageMemoryBarrier imageBarriersToTransfer[2] = {
-                getImagePipelineBarrier(
-                        vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead,
-                        vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferSrcOptimal, renderTargetImage.image),
-                getImagePipelineBarrier(
-                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
-                        vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, swapChainImage)
-        };
+    vk::ComputePipelineCreateInfo pipelineCreateInfo = {
+            .stage = {
+                    .stage = vk::ShaderStageFlagBits::eCompute,
+                    .module = computeModule,
+                    .pName = "main"
+            },
+            .layout = activePixelPipelineLayout
+    };
 
-        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eRayTracingShaderKHR, vk::PipelineStageFlagBits::eTransfer,
-            vk::DependencyFlagBits::eByRegion, 0, nullptr,
-            0, nullptr, 2, imageBarriersToTransfer);
+    activePixelPipeline = device.createComputePipeline(pipelineCache, pipelineCreateInfo).value;
 
+    device.destroyShaderModule(computeModule);
+}
 
-        // COPY RENDER TARGET IMAGE TO SWAP CHAIN IMAGE
-        vk::ImageSubresourceLayers subresourceLayers = {
-                .aspectMask = vk::ImageAspectFlagBits::eColor,
-                .mipLevel = 0,
-                .baseArrayLayer = 0,
-                .layerCount = 1
-        };
+void Vulkan::createActivePixelDescriptorSet() {
+    std::vector<vk::DescriptorPoolSize> poolSizes = {
+            {
+                    .type = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 2
+            },
+            {
+                    .type = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1
+            }
+    };
 
-        vk::ImageCopy imageCopy = {
-                .srcSubresource = subresourceLayers,
-                .srcOffset = {0, 0, 0},
-                .dstSubresource = subresourceLayers,
-                .dstOffset = {0, 0, 0},
-                .extent = {
-                        .width = swapChainExtent.width,
-                        .height = swapChainExtent.height,
-                        .depth = 1
-                }
-        };
+    activePixelDescriptorPool = device.createDescriptorPool(
+            {
+                    .maxSets = 1,
+                    .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+                    .pPoolSizes = poolSizes.data()
+            });
 
-        commandBuffer.copyImage(renderTargetImage.image, vk::ImageLayout::eTransferSrcOptimal, swapChainImage,
-            vk::ImageLayout::eTransferDstOptimal, 1, &imageCopy);
+    activePixelDescriptorSet = device.allocateDescriptorSets(
+            {
+                    .descriptorPool = activePixelDescriptorPool,
+                    .descriptorSetCount = 1,
+                    .pSetLayouts = &activePixelDescriptorSetLayout
+            }).front();
 
+    vk::DescriptorImageInfo summedPixelColorImageInfo = {
+            .imageView = summedPixelColorImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
 
-        // SWAP CHAIN IMAGE: TRANSFER DST -> PRESENT
-        vk::ImageMemoryBarrier barrierSwapChainToPresent = getImagePipelineBarrier(
-            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead,
-            vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR, swapChainImage);
+    vk::DescriptorImageInfo summedSquaredLuminanceImageInfo = {
+            .imageView = summedSquaredLuminanceImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
 
-        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-            vk::DependencyFlagBits::eByRegion, 0, nullptr,
-            0, nullptr, 1, &barrierSwapChainToPresent);
+    vk::DescriptorBufferInfo activePixelBufferInfo = {
+            .buffer = activePixelBuffer.buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE
+    };
 
-        commandBuffer.end();
-    }
+    std::vector<vk::WriteDescriptorSet> descriptorWrites = {
+            {
+                    .dstSet = activePixelDescriptorSet,
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedPixelColorImageInfo
+            },
+            {
+                    .dstSet = activePixelDescriptorSet,
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedSquaredLuminanceImageInfo
+            },
+            {
+                    .dstSet = activePixelDescriptorSet,
+                    .dstBinding = 2,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &activePixelBufferInfo
+            }
+    };
+
+    device.updateDescriptorSets(static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(),
+                                0, nullptr);
+}
+
+void Vulkan::createResolvePipeline() {
+    std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+            {
+                    .binding = 0,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            {
+                    .binding = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            {
+                    .binding = 2,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+    };
+
+    resolveDescriptorSetLayout = device.createDescriptorSetLayout(
+            {
+                    .bindingCount = static_cast<uint32_t>(bindings.size()),
+                    .pBindings = bindings.data()
+            });
+
+    vk::PushConstantRange pushConstantRange = {
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .offset = 0,
+            .size = sizeof(ResolvePushConstants)
+    };
+
+    resolvePipelineLayout = device.createPipelineLayout(
+            {
+                    .setLayoutCount = 1,
+                    .pSetLayouts = &resolveDescriptorSetLayout,
+                    .pushConstantRangeCount = 1,
+                    .pPushConstantRanges = &pushConstantRange
+            });
+
+    // constant_id = 0: TONE_MAP, constant_id = 1: COMPACT_ACCUMULATION
+    struct ResolveSpecializationData {
+        uint32_t toneMapOperator;
+        vk::Bool32 compactAccumulation;
+    };
+
+    const ResolveSpecializationData specializationData = {
+            .toneMapOperator = settings.toneMapOperator,
+            .compactAccumulation = isCompactAccumulation()
+    };
+
+    std::vector<vk::SpecializationMapEntry> mapEntries = {
+            {
+                    .constantID = 0,
+                    .offset = offsetof(ResolveSpecializationData, toneMapOperator),
+                    .size = sizeof(uint32_t)
+            },
+            {
+                    .constantID = 1,
+                    .offset = offsetof(ResolveSpecializationData, compactAccumulation),
+                    .size = sizeof(vk::Bool32)
+            }
+    };
+
+    vk::SpecializationInfo specializationInfo = {
+            .mapEntryCount = static_cast<uint32_t>(mapEntries.size()),
+            .pMapEntries = mapEntries.data(),
+            .dataSize = sizeof(ResolveSpecializationData),
+            .pData = &specializationData
+    };
+
+    vk::ShaderModule computeModule = createShaderModule(resolve_shader_path);
+
+    vk::ComputePipelineCreateInfo pipelineCreateInfo = {
+            .stage = {
+                    .stage = vk::ShaderStageFlagBits::eCompute,
+                    .module = computeModule,
+                    .pName = "main",
+                    .pSpecializationInfo = &specializationInfo
+            },
+            .layout = resolvePipelineLayout
+    };
+
+    resolvePipeline = device.createComputePipeline(pipelineCache, pipelineCreateInfo).value;
+
+    device.destroyShaderModule(computeModule);
+}
+
+void Vulkan::createResolveDescriptorSet() {
+    std::vector<vk::DescriptorPoolSize> poolSizes = {
+            {
+                    .type = vk::DescriptorType::eStorageImage,
+                    .descriptorCount = 3
+            }
+    };
+
+    resolveDescriptorPool = device.createDescriptorPool(
+            {
+                    .maxSets = 1,
+                    .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+                    .pPoolSizes = poolSizes.data()
+            });
+
+    resolveDescriptorSet = device.allocateDescriptorSets(
+            {
+                    .descriptorPool = resolveDescriptorPool,
+                    .descriptorSetCount = 1,
+                    .pSetLayouts = &resolveDescriptorSetLayout
+            }).front();
+
+    vk::DescriptorImageInfo renderTargetImageInfo = {
+            .imageView = renderTargetImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    vk::DescriptorImageInfo summedPixelColorImageInfo = {
+            .imageView = summedPixelColorImage.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    vk::DescriptorImageInfo summedPixelColorPlanesInfo = {
+            .imageView = summedPixelColorPlanes.imageView,
+            .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    std::vector<vk::WriteDescriptorSet> descriptorWrites = {
+            {
+                    .dstSet = resolveDescriptorSet,
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &renderTargetImageInfo
+            },
+            {
+                    .dstSet = resolveDescriptorSet,
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedPixelColorImageInfo
+            },
+            {
+                    .dstSet = resolveDescriptorSet,
+                    .dstBinding = 2,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageImage,
+                    .pImageInfo = &summedPixelColorPlanesInfo
+            }
+    };
+
+    device.updateDescriptorSets(static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(),
+                                0, nullptr);
+}
+
+bool Vulkan::isAdaptiveSampling() const {
+    return settings.adaptiveThreshold > 0.0f;
+}
+
+bool Vulkan::hasAccumulationErrorImage() const {
+    return settings.accumulationPrecision == ACCUMULATION_KAHAN || settings.accumulationPrecision == ACCUMULATION_SPLIT;
+}
+
+bool Vulkan::isCompactAccumulation() const {
+    return settings.accumulationFormat == ACCUMULATION_FORMAT_RGB32F;
+}
+
+// LOADS & STORES OF shader.rgen PER SAMPLED PIXEL & RENDER CALL, THE ACTIVE PIXEL LIST IS NOT COUNTED
+uint32_t Vulkan::getAccumulationBytesPerPixel() const {
+    uint32_t bytes = isCompactAccumulation() ? 2 * 3 * sizeof(float) : 2 * 4 * sizeof(float);
+
+    if (hasAccumulationErrorImage()) {
+        bytes += 2 * 4 * sizeof(float);
+    }
+
+    if (settings.accumulationPrecision == ACCUMULATION_FP64) {
+        bytes += 2 * 3 * sizeof(double);
+    }
+
+    if (isAdaptiveSampling()) {
+        bytes += 2 * sizeof(float);
+    }
+
+    return bytes;
+}
+
+void Vulkan::joinDeferredOperation(vk::DeferredOperationKHR deferredOperation) const {
+    const uint32_t maxConcurrency = std::max(
+            device.getDeferredOperationMaxConcurrencyKHR(deferredOperation, dynamicDispatchLoader), 1u);
+    const uint32_t threadCount = std::min(maxConcurrency, std::max(std::thread::hardware_concurrency(), 1u));
+
+    // THE POOL ONLY LIVES FOR THIS OPERATION, THE CALLING THREAD JOINS AS WORKER 0
+    ThreadPool threadPool(threadCount);
+    threadPool.parallelFor(threadCount, [this, deferredOperation](uint32_t) {
+        // IDLE: NO WORK FOR THIS THREAD RIGHT NOW, BUT THE OPERATION IS NOT DONE, SO IT MAY GET MORE
+        while (device.deferredOperationJoinKHR(deferredOperation, dynamicDispatchLoader) ==
+               vk::Result::eThreadIdleKHR) {
+            std::this_thread::yield();
+        }
+    });
+
+    // eThreadDoneKHR ONLY MEANS THERE IS NOTHING LEFT TO HAND OUT, OTHER THREADS MAY STILL BE FINISHING
+    while (device.getDeferredOperationResultKHR(deferredOperation, dynamicDispatchLoader) == vk::Result::eNotReady) {
+        std::this_thread::yield();
+    }
+}
+
+void Vulkan::loadPipelineCache() {
+    std::vector<uint8_t> initialData;
+
+    std::ifstream file;
+    if (!settings.pipelineCachePath.empty()) {
+        file.open(settings.pipelineCachePath, std::ios::binary);
+    }
+
+    if (file.is_open()) {
+        const PipelineCacheFileHeader expectedHeader = getPipelineCacheFileHeader();
+        PipelineCacheFileHeader header = {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheFileHeader));
+
+        const bool sameDevice = file && memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) == 0 &&
+                                header.version == expectedHeader.version &&
+                                header.vendorID == expectedHeader.vendorID &&
+                                header.deviceID == expectedHeader.deviceID &&
+                                header.driverVersion == expectedHeader.driverVersion &&
+                                memcmp(header.deviceUUID, expectedHeader.deviceUUID, VK_UUID_SIZE) == 0 &&
+                                memcmp(header.pipelineCacheUUID, expectedHeader.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+        const uint64_t fileSize = std::filesystem::file_size(settings.pipelineCachePath);
+
+        if (sameDevice && header.dataSize == fileSize - sizeof(PipelineCacheFileHeader)) {
+            initialData.resize(header.dataSize);
+            file.read(reinterpret_cast<char*>(initialData.data()), static_cast<std::streamsize>(header.dataSize));
+
+            if (!file || getChecksum(initialData.data(), initialData.size()) != header.dataChecksum) {
+                std::cerr << "Discarding the corrupt pipeline cache '" << settings.pipelineCachePath << "'"
+                    << std::endl;
+                initialData.clear();
+            }
+        } else {
+            std::cerr << "Discarding the pipeline cache '" << settings.pipelineCachePath
+                << "', it was created for another device or driver or is truncated" << std::endl;
+        }
+    }
+
+    pipelineCache = device.createPipelineCache(
+            {
+                    .initialDataSize = initialData.size(),
+                    .pInitialData = initialData.data()
+            });
+
+    loadedPipelineCacheData = std::move(initialData);
+}
+
+void Vulkan::savePipelineCache() const {
+    if (settings.pipelineCachePath.empty()) {
+        return;
+    }
+
+    // CALLED FROM THE DESTRUCTOR, A CACHE THAT CANNOT BE WRITTEN MUST NOT TAKE THE APPLICATION DOWN
+    try {
+        const std::vector<uint8_t> data = device.getPipelineCacheData(pipelineCache);
+
+        // NOTHING WAS COMPILED THAT WAS NOT ALREADY CACHED
+        if (data == loadedPipelineCacheData) {
+            return;
+        }
+
+        PipelineCacheFileHeader header = getPipelineCacheFileHeader();
+        header.dataSize = data.size();
+        header.dataChecksum = getChecksum(data.data(), data.size());
+
+        // WRITE A TEMPORARY FILE & RENAME IT, SO A CRASH WHILE WRITING NEVER LEAVES A TRUNCATED CACHE BEHIND
+        const std::string temporaryPath = settings.pipelineCachePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(PipelineCacheFileHeader));
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+            if (!file) {
+                throw std::runtime_error("[Error] Failed to write '" + temporaryPath + "'!");
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, settings.pipelineCachePath);
+    } catch (const std::exception &exception) {
+        std::cerr << "Failed to save the pipeline cache: " << exception.what() << std::endl;
+    }
+}
+
+PipelineCacheFileHeader Vulkan::getPipelineCacheFileHeader() const {
+    vk::PhysicalDeviceIDProperties idProperties = {};
+
+    vk::PhysicalDeviceProperties2 physicalDeviceProperties2 = {
+            .pNext = &idProperties
+    };
+
+    physicalDevice.getProperties2(&physicalDeviceProperties2);
+    const vk::PhysicalDeviceProperties &properties = physicalDeviceProperties2.properties;
+
+    PipelineCacheFileHeader header = {
+            .magic = {'R', 'T', 'P', 'C', 'A', 'C', 'H', 'E'},
+            .version = 1,
+            .vendorID = properties.vendorID,
+            .deviceID = properties.deviceID,
+            .driverVersion = properties.driverVersion
+    };
+
+    memcpy(header.deviceUUID, idProperties.deviceUUID.data(), VK_UUID_SIZE);
+    memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+    return header;
+}
+
+// FNV-1a
+uint64_t Vulkan::getChecksum(const void* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+std::vector<char> Vulkan::readBinaryFile(const std::string &path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("[Error] Failed to open file at '" + path + "'!");
+
+    size_t fileSize = (size_t) file.tellg();
+    std::vector<char> buffer(fileSize);
+
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+
+    file.close();
+
+    return buffer;
+}
+
+void Vulkan::createCommandBuffers() {
+    std::vector<vk::CommandBuffer> commandBuffers = device.allocateCommandBuffers(
+            {
+                    .commandPool = commandPool,
+                    .level = vk::CommandBufferLevel::ePrimary,
+                    .commandBufferCount = settings.framesInFlight
+            });
+
+    framesInFlight.resize(settings.framesInFlight);
+    for (uint32_t frameIndex = 0; frameIndex < settings.framesInFlight; frameIndex++) {
+        framesInFlight[frameIndex].commandBuffer = commandBuffers[frameIndex];
+    }
+}
+
+void Vulkan::createQueryPools() {
+    const std::vector<vk::QueueFamilyProperties> queueFamilies = physicalDevice.getQueueFamilyProperties();
+    const uint32_t timestampValidBits = queueFamilies[computeQueueFamily].timestampValidBits;
+
+    timestampsSupported = timestampValidBits > 0;
+    timestampMask = timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << timestampValidBits) - 1;
+    timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+
+    std::ranges::for_each(framesInFlight, [this](auto &frame) {
+        if (timestampsSupported) {
+            frame.timestampQueryPool = device.createQueryPool(
+                    {
+                            .queryType = vk::QueryType::eTimestamp,
+                            .queryCount = TIMESTAMP_QUERY_COUNT
+                    });
+        }
+
+        if (settings.countRays || isAdaptiveSampling()) {
+            frame.counterReadbackBuffer = createBuffer(sizeof(uint64_t) + sizeof(uint32_t),
+                                                       vk::BufferUsageFlagBits::eTransferDst,
+                                                       vk::MemoryPropertyFlagBits::eHostVisible |
+                                                       vk::MemoryPropertyFlagBits::eHostCoherent);
+        }
+    });
+}
+
+void Vulkan::recordCommandBuffer(const FrameInFlight &frame, const RenderCallInfo &renderCallInfo,
+                                 const Tile &tile, std::optional<uint32_t> swapChainImageIndex) {
+    const vk::CommandBuffer &commandBuffer = frame.commandBuffer;
+
+    vk::CommandBufferBeginInfo beginInfo = {
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    };
+
+    commandBuffer.begin(&beginInfo);
+
+    if (timestampsSupported) {
+        commandBuffer.resetQueryPool(frame.timestampQueryPool, 0, TIMESTAMP_QUERY_COUNT);
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.timestampQueryPool,
+                                     TIMESTAMP_BEGIN);
+    }
+
+    // PREVIOUS RAY COUNT -> CLEAR THE RAY COUNTER
+    if (settings.countRays) {
+        vk::MemoryBarrier rayCounterBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferRead,
+                .dstAccessMask = vk::AccessFlagBits::eTransferWrite
+        };
+
+        commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eRayTracingShaderKHR | vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eTransfer,
+                {}, 1, &rayCounterBarrier, 0, nullptr, 0, nullptr);
+
+        commandBuffer.fillBuffer(rayCounterBuffer.buffer, 0, sizeof(uint64_t), 0);
+    }
+
+    // PREVIOUS RENDER CALLS, RESOLVES, READBACKS & THE COUNTER CLEAR -> RAY TRACING (THE IMAGES STAY IN GENERAL)
+    vk::MemoryBarrier accumulationBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+    };
+
+    commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eRayTracingShaderKHR | vk::PipelineStageFlagBits::eComputeShader |
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eRayTracingShaderKHR,
+            {}, 1, &accumulationBarrier, 0, nullptr, 0, nullptr);
+
+    // BOTTOM OF PIPE: LATCHED ONCE ALL EARLIER WORK ON THE QUEUE HAS FINISHED
+    if (timestampsSupported) {
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.timestampQueryPool,
+                                     TIMESTAMP_BARRIERS_END);
+    }
+
+    // THE SELECTION IS PART OF THE FIRST TILE'S TRACE RAYS TIME
+    if (isAdaptiveSampling() && frame.tileProgress.tileIndex == 0) {
+        recordActivePixelSelection(frame);
+    }
+
+
+    // RAY TRACING
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eRayTracingKHR, rtPipeline);
+
+    std::vector<vk::DescriptorSet> descriptorSets = {rtDescriptorSet};
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eRayTracingKHR, rtPipelineLayout,
+                                     0, descriptorSets, nullptr);
+
+    RenderCallPushConstants pushConstants = {
+            .renderCallInfo = renderCallInfo,
+            .tileOffsetX = tile.offsetX,
+            .tileOffsetY = tile.offsetY,
+            .activePixelOffset = frame.activePixelOffset,
+            .firstSample = accumulatedSamples
+    };
+
+    commandBuffer.pushConstants(rtPipelineLayout, vk::ShaderStageFlagBits::eRaygenKHR, 0,
+                                sizeof(RenderCallPushConstants), &pushConstants);
+
+    commandBuffer.traceRaysKHR(sbtRayGenAddressRegion, sbtMissAddressRegion, sbtHitAddressRegion, {},
+                               tile.width, tile.height, 1, dynamicDispatchLoader);
+
+    if (timestampsSupported) {
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.timestampQueryPool,
+                                     TIMESTAMP_TRACE_RAYS_END);
+    }
+
+    // COPY THE RAY COUNT OF THIS SUBMIT TO THE FRAME'S HOST VISIBLE BUFFER
+    if (settings.countRays) {
+        vk::MemoryBarrier rayCounterToTransfer = {
+                .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                .dstAccessMask = vk::AccessFlagBits::eTransferRead
+        };
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eRayTracingShaderKHR,
+                                      vk::PipelineStageFlagBits::eTransfer,
+                                      {}, 1, &rayCounterToTransfer, 0, nullptr, 0, nullptr);
+
+        vk::BufferCopy rayCountCopy = {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = sizeof(uint64_t)
+        };
+
+        commandBuffer.copyBuffer(rayCounterBuffer.buffer, frame.counterReadbackBuffer.buffer, 1, &rayCountCopy);
+
+        vk::MemoryBarrier rayCountToHost = {
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eHostRead
+        };
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                                      {}, 1, &rayCountToHost, 0, nullptr, 0, nullptr);
+    }
+
+    if (!swapChainImageIndex) {
+        commandBuffer.end();
+        return;
+    }
+
+    // THE SUMS INCLUDE THIS RENDER CALL, ITS TILES RAN BEFORE
+    recordPresent(commandBuffer, swapChainImages[*swapChainImageIndex],
+                  accumulatedSamples + renderCallInfo.samplesPerRenderCall);
+
+    if (timestampsSupported) {
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.timestampQueryPool,
+                                     TIMESTAMP_COPY_END);
+    }
+
+    commandBuffer.end();
 }
 
-void Vulkan::createFence() {
-    fence = device.createFence({});
+void Vulkan::recordPresent(const vk::CommandBuffer &commandBuffer, const vk::Image &swapChainImage,
+                           uint32_t sampleCount) const {
+    // RAY TRACING -> RESOLVE (THE RENDER TARGET IS IN GENERAL SINCE THE LAST COPY)
+    vk::MemoryBarrier accumulationBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eRayTracingShaderKHR,
+                                  vk::PipelineStageFlagBits::eComputeShader,
+                                  {}, 1, &accumulationBarrier, 0, nullptr, 0, nullptr);
+
+
+    // RESOLVE: ONE INVOCATION PER PIXEL, 8 x 8 PER WORK GROUP
+    const ResolvePushConstants pushConstants = {
+            .sampleCount = sampleCount
+    };
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, resolvePipeline);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, resolvePipelineLayout, 0, 1,
+                                     &resolveDescriptorSet, 0, nullptr);
+    commandBuffer.pushConstants(resolvePipelineLayout, vk::ShaderStageFlagBits::eCompute, 0,
+                                sizeof(ResolvePushConstants), &pushConstants);
+    commandBuffer.dispatch((settings.windowWidth + 7) / 8, (settings.windowHeight + 7) / 8, 1);
+
+
+    // RENDER TARGET IMAGE: GENERAL -> TRANSFER SRC & SWAP CHAIN IMAGE: UNDEFINED -> TRANSFER DST
+    vk::ImageMemoryBarrier imageBarriersToTransfer[2] = {
+            getImagePipelineBarrier(
+                    vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead,
+                    vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferSrcOptimal, renderTargetImage.image),
+            getImagePipelineBarrier(
+                    vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
+                    vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, swapChainImage)
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer,
+                                  vk::DependencyFlagBits::eByRegion, 0, nullptr,
+                                  0, nullptr, 2, imageBarriersToTransfer);
+
+
+    // COPY RENDER TARGET IMAGE TO SWAP CHAIN IMAGE
+    vk::ImageSubresourceLayers subresourceLayers = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+    };
+
+    vk::ImageCopy imageCopy = {
+            .srcSubresource = subresourceLayers,
+            .srcOffset = {0, 0, 0},
+            .dstSubresource = subresourceLayers,
+            .dstOffset = {0, 0, 0},
+            .extent = {
+                    .width = swapChainExtent.width,
+                    .height = swapChainExtent.height,
+                    .depth = 1
+            }
+    };
+
+    commandBuffer.copyImage(renderTargetImage.image, vk::ImageLayout::eTransferSrcOptimal, swapChainImage,
+                            vk::ImageLayout::eTransferDstOptimal, 1, &imageCopy);
+
+
+    // RENDER TARGET IMAGE: TRANSFER SRC -> GENERAL & SWAP CHAIN IMAGE: TRANSFER DST -> PRESENT
+    vk::ImageMemoryBarrier imageBarriersAfterCopy[2] = {
+            getImagePipelineBarrier(
+                    vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eShaderWrite,
+                    vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eGeneral, renderTargetImage.image),
+            getImagePipelineBarrier(
+                    vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead,
+                    vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR, swapChainImage)
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                                  vk::DependencyFlagBits::eByRegion, 0, nullptr,
+                                  0, nullptr, 2, imageBarriersAfterCopy);
+}
+
+void Vulkan::recordActivePixelSelection(const FrameInFlight &frame) const {
+    const vk::CommandBuffer &commandBuffer = frame.commandBuffer;
+
+    // PREVIOUS RENDER CALL (SUMS WRITTEN, LIST READ) -> CLEAR THE COUNT
+    vk::MemoryBarrier selectionBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferWrite
+    };
+
+    commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eRayTracingShaderKHR | vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+            {}, 1, &selectionBarrier, 0, nullptr, 0, nullptr);
+
+    commandBuffer.fillBuffer(activePixelBuffer.buffer, 0, sizeof(uint32_t), 0);
+
+    vk::MemoryBarrier countClearBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                                  {}, 1, &countClearBarrier, 0, nullptr, 0, nullptr);
+
+
+    // SELECT: ONE INVOCATION PER PIXEL, 8 x 8 PER WORK GROUP
+    const ActivePixelSelectionPushConstants pushConstants = {
+            .threshold = settings.adaptiveThreshold,
+            .minSamples = settings.adaptiveMinSamples
+    };
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, activePixelPipeline);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, activePixelPipelineLayout, 0, 1,
+                                     &activePixelDescriptorSet, 0, nullptr);
+    commandBuffer.pushConstants(activePixelPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0,
+                                sizeof(ActivePixelSelectionPushConstants), &pushConstants);
+    commandBuffer.dispatch((settings.windowWidth + 7) / 8, (settings.windowHeight + 7) / 8, 1);
+
+
+    // THE LIST -> RAY TRACING & THE COUNT -> THE FRAME'S HOST VISIBLE BUFFER
+    vk::MemoryBarrier listBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                  vk::PipelineStageFlagBits::eRayTracingShaderKHR |
+                                  vk::PipelineStageFlagBits::eTransfer,
+                                  {}, 1, &listBarrier, 0, nullptr, 0, nullptr);
+
+    vk::BufferCopy activePixelCountCopy = {
+            .srcOffset = 0,
+            .dstOffset = sizeof(uint64_t),
+            .size = sizeof(uint32_t)
+    };
+
+    commandBuffer.copyBuffer(activePixelBuffer.buffer, frame.counterReadbackBuffer.buffer, 1, &activePixelCountCopy);
+
+    vk::MemoryBarrier activePixelCountToHost = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                                  {}, 1, &activePixelCountToHost, 0, nullptr, 0, nullptr);
 }
 
-void Vulkan::createSemaphore() {
-    semaphores.resize(swapChainImages.size());
-    std::ranges::for_each(semaphores, [this](auto& semaphore) {
+void Vulkan::createSyncObjects() {
+    vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+            .semaphoreType = vk::SemaphoreType::eTimeline,
+            .initialValue = 0
+    };
+
+    timelineSemaphore = device.createSemaphore({.pNext = &semaphoreTypeCreateInfo});
+
+    // BINARY SEMAPHORES ARE ONLY NEEDED FOR THE SWAP CHAIN
+    if (settings.headless) {
+        return;
+    }
+
+    std::ranges::for_each(framesInFlight, [this](auto &frame) {
+        frame.imageAvailableSemaphore = device.createSemaphore({});
+    });
+
+    renderFinishedSemaphores.resize(swapChainImages.size());
+    std::ranges::for_each(renderFinishedSemaphores, [this](auto &semaphore) {
         semaphore = device.createSemaphore({});
-        });
+    });
 }
 
-uint32_t Vulkan::findMemoryTypeIndex(const uint32_t &memoryTypeBits, const vk::MemoryPropertyFlags &properties) {
-    vk::PhysicalDeviceMemoryProperties memoryProperties = physicalDevice.getMemoryProperties();
-
-    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-        if ((memoryTypeBits & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
+void Vulkan::waitForTimelineValue(uint64_t value) const {
+    if (value == 0) {
+        return;
     }
 
-    throw std::runtime_error("Unable to find suitable memory type!");
+    vk::SemaphoreWaitInfo waitInfo = {
+            .semaphoreCount = 1,
+            .pSemaphores = &timelineSemaphore,
+            .pValues = &value
+    };
+
+    device.waitSemaphores(waitInfo, UINT64_MAX);
 }
 
 vk::ImageMemoryBarrier Vulkan::getImagePipelineBarrier(
@@ -767,18 +2371,23 @@ vk::ImageMemoryBarrier Vulkan::getImagePipelineBarrier(
                     .baseMipLevel = 0,
                     .levelCount = 1,
                     .baseArrayLayer = 0,
-                    .layerCount = 1
+                    .layerCount = VK_REMAINING_ARRAY_LAYERS
             },
     };
 }
 
-VulkanImage Vulkan::createImage(const vk::Format &format, const vk::Flags<vk::ImageUsageFlagBits> &usageFlagBits) {
+VulkanImage Vulkan::createImage(const vk::Format &format, const vk::Flags<vk::ImageUsageFlagBits> &usageFlagBits,
+                                std::optional<vk::Extent2D> extent, uint32_t arrayLayers) {
+    if (!extent) {
+        extent = vk::Extent2D{.width = settings.windowWidth, .height = settings.windowHeight};
+    }
+
     vk::ImageCreateInfo imageCreateInfo = {
             .imageType = vk::ImageType::e2D,
             .format = format,
-            .extent = {.width = settings.windowWidth, .height = settings.windowHeight, .depth = 1},
+            .extent = {.width = extent->width, .height = extent->height, .depth = 1},
             .mipLevels = 1,
-            .arrayLayers = 1,
+            .arrayLayers = arrayLayers,
             .samples = vk::SampleCountFlagBits::e1,
             .tiling = vk::ImageTiling::eOptimal,
             .usage = usageFlagBits,
@@ -788,36 +2397,106 @@ VulkanImage Vulkan::createImage(const vk::Format &format, const vk::Flags<vk::Im
 
     vk::Image image = device.createImage(imageCreateInfo);
 
-    vk::MemoryRequirements memoryRequirements = device.getImageMemoryRequirements(image);
-
-    vk::MemoryAllocateInfo allocateInfo = {
-            .allocationSize = memoryRequirements.size,
-            .memoryTypeIndex = findMemoryTypeIndex(memoryRequirements.memoryTypeBits,
-                                                   vk::MemoryPropertyFlagBits::eDeviceLocal)
-    };
-
-    vk::DeviceMemory memory = device.allocateMemory(allocateInfo);
-
-    device.bindImageMemory(image, memory, 0);
-
     return {
             .image = image,
-            .memory = memory,
-            .imageView = createImageView(image, format)
+            .allocation = memoryAllocator->allocateImageMemory(image, vk::MemoryPropertyFlagBits::eDeviceLocal),
+            .imageView = createImageView(image, format, arrayLayers)
     };
 }
 
 void Vulkan::createImages() {
+    if (settings.windowWidth > MAX_IMAGE_EXTENT || settings.windowHeight > MAX_IMAGE_EXTENT) {
+        throw std::runtime_error("[Error] The image can be at most " + std::to_string(MAX_IMAGE_EXTENT) + " pixels wide "
+                                 "and high!");
+    }
+
+    if (isCompactAccumulation() && isAdaptiveSampling()) {
+        throw std::runtime_error("[Error] The rgb32f accumulation format has no sample count per pixel, use rgba32f for "
+                                 "adaptive sampling!");
+    }
+
+    const std::optional<vk::Extent2D> unusedExtent = vk::Extent2D{.width = 1, .height = 1};
+
     renderTargetImage = createImage(swapChainImageFormat,
-                                    vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc);
+                                    vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc,
+                                    settings.headless ? unusedExtent : std::nullopt);
+
+    summedPixelColorImage = createImage(summedPixelColorImageFormat,
+                                        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc |
+                                        vk::ImageUsageFlagBits::eTransferDst,
+                                        isCompactAccumulation() ? unusedExtent : std::nullopt);
+
+    summedSquaredLuminanceImage = createImage(summedSquaredLuminanceImageFormat,
+                                              vk::ImageUsageFlagBits::eStorage |
+                                              vk::ImageUsageFlagBits::eTransferDst,
+                                              isAdaptiveSampling() ? std::nullopt : unusedExtent);
+
+    summedPixelColorErrorImage = createImage(summedPixelColorErrorImageFormat,
+                                             vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst,
+                                             hasAccumulationErrorImage() ? std::nullopt : unusedExtent);
+
+    summedPixelColorPlanes = createImage(summedPixelColorPlaneFormat,
+                                         vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc |
+                                         vk::ImageUsageFlagBits::eTransferDst,
+                                         isCompactAccumulation() ? std::nullopt : unusedExtent, 3);
+
+    // ALL IMAGES STAY IN GENERAL BETWEEN RENDER CALLS: UNDEFINED -> GENERAL ONCE. THE SUMS START AT ZERO, THE ALPHA
+    // CHANNEL OF THE RGBA32F FORMAT COUNTS THE SAMPLES OF EVERY PIXEL
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        vk::ImageMemoryBarrier imageBarriersToGeneral[5] = {
+                getImagePipelineBarrier(
+                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eShaderWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, renderTargetImage.image),
+                getImagePipelineBarrier(
+                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, summedPixelColorImage.image),
+                getImagePipelineBarrier(
+                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, summedSquaredLuminanceImage.image),
+                getImagePipelineBarrier(
+                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, summedPixelColorErrorImage.image),
+                getImagePipelineBarrier(
+                        vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, summedPixelColorPlanes.image)
+        };
+
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                                vk::PipelineStageFlagBits::eComputeShader |
+                                                vk::PipelineStageFlagBits::eTransfer,
+                                                {}, 0, nullptr, 0, nullptr, 5, imageBarriersToGeneral);
+
+        const vk::ClearColorValue zero = {};
+        const vk::ImageSubresourceRange subresourceRange = {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS
+        };
+
+        for (const VulkanImage &image: {summedPixelColorImage, summedSquaredLuminanceImage, summedPixelColorErrorImage,
+                                        summedPixelColorPlanes}) {
+            singleTimeCommandBuffer.clearColorImage(image.image, vk::ImageLayout::eGeneral, &zero, 1,
+                                                    &subresourceRange);
+        }
+
+        vk::MemoryBarrier clearBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        };
 
-    summedPixelColorImage = createImage(summedPixelColorImageFormat, vk::ImageUsageFlagBits::eStorage);
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                                vk::PipelineStageFlagBits::eRayTracingShaderKHR |
+                                                vk::PipelineStageFlagBits::eComputeShader,
+                                                {}, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+    });
 }
 
-void Vulkan::destroyImage(const VulkanImage &image) const {
+void Vulkan::destroyImage(const VulkanImage &image) {
     device.destroyImageView(image.imageView);
     device.destroyImage(image.image);
-    device.freeMemory(image.memory);
+    memoryAllocator->free(image.allocation);
 }
 
 VulkanBuffer Vulkan::createBuffer(const vk::DeviceSize &size, const vk::Flags<vk::BufferUsageFlagBits> &usage,
@@ -830,31 +2509,15 @@ VulkanBuffer Vulkan::createBuffer(const vk::DeviceSize &size, const vk::Flags<vk
 
     vk::Buffer buffer = device.createBuffer(bufferCreateInfo);
 
-    vk::MemoryRequirements memoryRequirements = device.getBufferMemoryRequirements(buffer);
-
-    vk::MemoryAllocateFlagsInfo allocateFlagsInfo = {
-            .flags = vk::MemoryAllocateFlagBits::eDeviceAddress
-    };
-
-    vk::MemoryAllocateInfo allocateInfo = {
-            .pNext = &allocateFlagsInfo,
-            .allocationSize = memoryRequirements.size,
-            .memoryTypeIndex = findMemoryTypeIndex(memoryRequirements.memoryTypeBits, memoryProperty)
-    };
-
-    vk::DeviceMemory memory = device.allocateMemory(allocateInfo);
-
-    device.bindBufferMemory(buffer, memory, 0);
-
     return {
             .buffer = buffer,
-            .memory = memory,
+            .allocation = memoryAllocator->allocateBufferMemory(buffer, memoryProperty)
     };
 }
 
-void Vulkan::destroyBuffer(const VulkanBuffer &buffer) const {
+void Vulkan::destroyBuffer(const VulkanBuffer &buffer) {
     device.destroyBuffer(buffer.buffer);
-    device.freeMemory(buffer.memory);
+    memoryAllocator->free(buffer.allocation);
 }
 
 void Vulkan::executeSingleTimeCommand(const std::function<void(const vk::CommandBuffer &singleTimeCommandBuffer)> &c) {
@@ -869,226 +2532,780 @@ void Vulkan::executeSingleTimeCommand(const std::function<void(const vk::Command
             .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
     };
 
-    singleTimeCommandBuffer.begin(&beginInfo);
+    singleTimeCommandBuffer.begin(&beginInfo);
+
+    c(singleTimeCommandBuffer);
+
+    singleTimeCommandBuffer.end();
+
+
+    vk::SubmitInfo submitInfo = {
+            .commandBufferCount = 1,
+            .pCommandBuffers = &singleTimeCommandBuffer
+    };
+
+    vk::Fence f = device.createFence({});
+    computeQueue.submit(1, &submitInfo, f);
+    device.waitForFences(1, &f, true, UINT64_MAX);
+
+    device.destroyFence(f);
+    device.freeCommandBuffers(commandPool, singleTimeCommandBuffer);
+}
+
+void Vulkan::createAABBBuffer(const Scene &scene) {
+    const vk::DeviceSize bufferSize = sizeof(vk::AabbPositionsKHR) * sphereAmount;
+
+    aabbBuffer = createBuffer(bufferSize,
+                              vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
+                              vk::BufferUsageFlagBits::eShaderDeviceAddress |
+                              vk::BufferUsageFlagBits::eTransferDst,
+                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    // WRITTEN STRAIGHT INTO THE STAGING RING IN CLUSTER ORDER, WITHOUT AN INTERMEDIATE HOST ARRAY
+    stagingRing->upload(aabbBuffer.buffer, sizeof(vk::AabbPositionsKHR), sphereAmount,
+                        [&](void* data, size_t firstSphere, size_t count) {
+                            auto* aabbs = static_cast<vk::AabbPositionsKHR*>(data);
+                            for (size_t i = 0; i < count; i++) {
+                                aabbs[i] = getAABBFromSphere(
+                                        scene.spheres[scenePartition.sphereIndices[firstSphere + i]].geometry);
+                            }
+                        });
+}
+
+void Vulkan::createScenePartition(const Scene &scene) {
+    // THE MATERIAL OF A DYNAMIC SCENE CAN CHANGE, SO ITS CLUSTERS ARE NOT SPLIT BY MATERIAL VARIANT
+    scenePartition = partitionScene(scene, !settings.dynamicScene, settings.materialHitGroups && !settings.dynamicScene);
+    sphereAmount = scenePartition.uploadedSphereAmount;
+
+    // ONLY THE VARIANTS IN THE SCENE GET A HIT GROUP, THE PIPELINE ALWAYS HAS AT LEAST ONE
+    std::set<uint32_t> materialVariants;
+    for (const SceneCluster &cluster: scenePartition.clusters) {
+        materialVariants.insert(cluster.materialVariant);
+    }
+
+    hitGroupMaterialVariants.assign(materialVariants.begin(), materialVariants.end());
+    if (hitGroupMaterialVariants.empty()) {
+        hitGroupMaterialVariants.push_back(MIXED_MATERIAL_VARIANT);
+    }
+
+    // UPDATES ADDRESS SPHERES BY THEIR SCENE INDEX, A DEVICE GENERATED SCENE IS UPLOADED IN SCENE ORDER
+    if (settings.dynamicScene && !scenePartition.sphereIndices.empty()) {
+        sphereLocations.resize(sphereAmount);
+        for (uint32_t i = 0; i < sphereAmount; i++) {
+            sphereLocations[scenePartition.sphereIndices[i]] = i;
+        }
+    }
+
+    // THE INSTANCE CUSTOM INDEX HOLDS THE FIRST SPHERE OF A CLUSTER & ONLY HAS 24 BITS
+    if (sphereAmount > (1u << 24)) {
+        throw std::runtime_error("[Error] " + std::to_string(sphereAmount) + " unique spheres exceed the " +
+                                 std::to_string(1u << 24) + " spheres instances can address!");
+    }
+}
+
+// ONE BLAS PER CLUSTER, ALL BUILT FROM THE SAME AABB BUFFER
+void Vulkan::createBottomAccelerationStructures(const Scene &scene) {
+    const uint64_t sceneHash = getSceneHash(scene, settings.materialHitGroups);
+    const std::string cachePath = getAccelerationStructureCachePath(sceneHash);
+
+    if (!cachePath.empty() && loadBottomAccelerationStructures(cachePath, sceneHash)) {
+        bottomAccelerationStructuresFromCache = true;
+        return;
+    }
+
+    const vk::AccelerationStructureGeometryKHR geometry = getSphereGeometry();
+
+    std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos;
+    std::vector<vk::AccelerationStructureBuildRangeInfoKHR> buildRangeInfos;
+
+    for (uint32_t cluster = 0; cluster < scenePartition.clusters.size(); cluster++) {
+        buildInfos.push_back(
+                {
+                        .type = vk::AccelerationStructureTypeKHR::eBottomLevel,
+                        .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace,
+                        .mode = vk::BuildAccelerationStructureModeKHR::eBuild,
+                        .srcAccelerationStructure = nullptr,
+                        .dstAccelerationStructure = nullptr,
+                        .geometryCount = 1,
+                        .pGeometries = &geometry,
+                        .scratchData = {}
+                });
+
+        buildRangeInfos.push_back(getClusterBuildRangeInfo(cluster));
+    }
+
+    bottomAccelerationStructures = buildAccelerationStructures(buildInfos, buildRangeInfos);
+
+    if (!cachePath.empty()) {
+        saveBottomAccelerationStructures(cachePath, sceneHash);
+    }
+}
+
+// ALL CLUSTERS SHARE THE AABB BUFFER, THEIR BUILD RANGES SELECT THEIR SPHERES
+vk::AccelerationStructureGeometryKHR Vulkan::getSphereGeometry() const {
+    vk::AccelerationStructureGeometryKHR geometry = {
+            .geometryType = vk::GeometryTypeKHR::eAabbs,
+            .flags = vk::GeometryFlagBitsKHR::eOpaque
+    };
+
+    geometry.geometry.aabbs.sType = vk::StructureType::eAccelerationStructureGeometryAabbsDataKHR;
+    geometry.geometry.aabbs.stride = sizeof(vk::AabbPositionsKHR);
+    geometry.geometry.aabbs.data.deviceAddress = device.getBufferAddress({.buffer = aabbBuffer.buffer});
+
+    return geometry;
+}
+
+vk::AccelerationStructureBuildRangeInfoKHR Vulkan::getClusterBuildRangeInfo(uint32_t cluster) const {
+    return {
+            .primitiveCount = scenePartition.clusters[cluster].sphereAmount,
+            .primitiveOffset = static_cast<uint32_t>(scenePartition.clusters[cluster].firstSphere *
+                                                     sizeof(vk::AabbPositionsKHR)),
+            .firstVertex = 0,
+            .transformOffset = 0
+    };
+}
+
+vk::AccelerationStructureGeometryKHR Vulkan::getInstancesGeometry() const {
+    vk::AccelerationStructureGeometryKHR geometry = {
+            .geometryType = vk::GeometryTypeKHR::eInstances,
+            .flags = vk::GeometryFlagBitsKHR::eOpaque
+    };
+
+    geometry.geometry.instances.sType = vk::StructureType::eAccelerationStructureGeometryInstancesDataKHR;
+    geometry.geometry.instances.arrayOfPointers = false;
+    geometry.geometry.instances.data.deviceAddress = device.getBufferAddress({.buffer = instancesBuffer.buffer});
+
+    return geometry;
+}
+
+// ONE INSTANCE PER CLUSTER OCCURRENCE. INSTANCES ONLY EVER TRANSLATE, SO OBJECT & WORLD SPACE DIRECTIONS AND RAY
+// DISTANCES MATCH. EVERY INSTANCE SELECTS THE HIT GROUP OF ITS CLUSTER'S MATERIAL VARIANT THROUGH ITS SBT RECORD OFFSET
+void Vulkan::createTopAccelerationStructure() {
+    std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos = {
+            {
+                    .type = vk::AccelerationStructureTypeKHR::eTopLevel,
+                    .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace,
+                    .mode = vk::BuildAccelerationStructureModeKHR::eBuild,
+                    .srcAccelerationStructure = nullptr,
+                    .dstAccelerationStructure = nullptr,
+                    .geometryCount = 1,
+                    .scratchData = {}
+            }
+    };
+
+
+    // UPLOAD THE INSTANCES INTO A NEW BUFFER, ONLY NEEDED DURING THE BUILD
+    std::vector<vk::DeviceAddress> bottomAccelerationStructureAddresses;
+    for (const vk::AccelerationStructureKHR &bottomAccelerationStructure:
+            bottomAccelerationStructures.accelerationStructures) {
+        bottomAccelerationStructureAddresses.push_back(device.getAccelerationStructureAddressKHR(
+                {.accelerationStructure = bottomAccelerationStructure}, dynamicDispatchLoader));
+    }
+
+    const vk::DeviceSize instancesBufferSize =
+            sizeof(vk::AccelerationStructureInstanceKHR) * std::max<size_t>(scenePartition.instances.size(), 1);
+
+    instancesBuffer = createBuffer(
+            instancesBufferSize,
+            vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
+            vk::BufferUsageFlagBits::eShaderDeviceAddress |
+            vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    stagingRing->upload(instancesBuffer.buffer, sizeof(vk::AccelerationStructureInstanceKHR),
+                        scenePartition.instances.size(), [&](void* data, size_t firstInstance, size_t count) {
+                auto* instances = static_cast<vk::AccelerationStructureInstanceKHR*>(data);
+
+                for (size_t i = 0; i < count; i++) {
+                    const SceneInstance &instance = scenePartition.instances[firstInstance + i];
+
+                    std::array<std::array<float, 4>, 3> matrix = {
+                            {
+                                    {1.0f, 0.0f, 0.0f, instance.translation.x},
+                                    {0.0f, 1.0f, 0.0f, instance.translation.y},
+                                    {0.0f, 0.0f, 1.0f, instance.translation.z}
+                            }};
+
+                    instances[i] = {
+                            .transform = {.matrix = matrix},
+                            .instanceCustomIndex = scenePartition.clusters[instance.cluster].firstSphere,
+                            .mask = 0xFF,
+                            .instanceShaderBindingTableRecordOffset = getHitGroupIndex(
+                                    scenePartition.clusters[instance.cluster].materialVariant),
+                            .accelerationStructureReference = bottomAccelerationStructureAddresses[instance.cluster],
+                    };
+                }
+            });
+
+    // THE GEOMETRY POINTS AT THE INSTANCES BUFFER, SO IT IS ONLY KNOWN ONCE THE BUFFER EXISTS
+    const vk::AccelerationStructureGeometryKHR geometry = getInstancesGeometry();
+    buildInfos.front().pGeometries = &geometry;
+
+
+    // BUILD THE ACCELERATION STRUCTURE
+    std::vector<vk::AccelerationStructureBuildRangeInfoKHR> buildRangeInfos = {
+            {
+                    .primitiveCount = static_cast<uint32_t>(scenePartition.instances.size()),
+                    .primitiveOffset = 0,
+                    .firstVertex = 0,
+                    .transformOffset = 0
+            }
+    };
+
+    topAccelerationStructure = buildAccelerationStructures(buildInfos, buildRangeInfos);
+
+    // A REFIT OF THE TLAS READS THE INSTANCES AGAIN
+    if (!settings.dynamicScene) {
+        destroyBuffer(instancesBuffer);
+        instancesBuffer = {};
+    }
+}
+
+// ONE SCRATCH REGION PER STRUCTURE, SO ANY SET OF REFITS FITS INTO ONE SUBMIT WITHOUT BARRIERS BETWEEN THE BLASES
+void Vulkan::createUpdateScratchBuffer() {
+    std::vector<vk::DeviceSize> scratchSizes = bottomAccelerationStructures.updateScratchSizes;
+    scratchSizes.insert(scratchSizes.end(), topAccelerationStructure.updateScratchSizes.begin(),
+                        topAccelerationStructure.updateScratchSizes.end());
+
+    updateScratchOffsets = getAlignedOffsets(
+            scratchSizes, getAccelerationStructureProperties().minAccelerationStructureScratchOffsetAlignment);
+
+    updateScratchBuffer = createBuffer(std::max<vk::DeviceSize>(updateScratchOffsets.back(), 1),
+                                       vk::BufferUsageFlagBits::eStorageBuffer |
+                                       vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                       vk::MemoryPropertyFlagBits::eDeviceLocal);
+}
+
+// UPDATES THE DIRTY BLASES IN PLACE, THEN THE TLAS, WHOSE INSTANCES STILL REFERENCE THE SAME BLASES BUT WHOSE BOUNDS
+// CHANGED. A REFIT KEEPS THE TREE TOPOLOGY, SO IT IS FAR CHEAPER THAN A BUILD BUT TRACES SLOWER THE FURTHER SPHERES MOVE
+void Vulkan::refitAccelerationStructures(const std::vector<uint32_t> &clusters) {
+    const vk::AccelerationStructureGeometryKHR sphereGeometry = getSphereGeometry();
+    const vk::AccelerationStructureGeometryKHR instancesGeometry = getInstancesGeometry();
+    const vk::DeviceAddress scratchAddress = device.getBufferAddress({.buffer = updateScratchBuffer.buffer});
+
+    std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos;
+    std::vector<vk::AccelerationStructureBuildRangeInfoKHR> buildRangeInfos;
+
+    for (const uint32_t cluster: clusters) {
+        const vk::AccelerationStructureKHR accelerationStructure =
+                bottomAccelerationStructures.accelerationStructures[cluster];
+
+        buildInfos.push_back(
+                {
+                        .type = vk::AccelerationStructureTypeKHR::eBottomLevel,
+                        .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace |
+                                 vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate,
+                        .mode = vk::BuildAccelerationStructureModeKHR::eUpdate,
+                        .srcAccelerationStructure = accelerationStructure,
+                        .dstAccelerationStructure = accelerationStructure,
+                        .geometryCount = 1,
+                        .pGeometries = &sphereGeometry,
+                        .scratchData = {.deviceAddress = scratchAddress + updateScratchOffsets[cluster]}
+                });
+
+        buildRangeInfos.push_back(getClusterBuildRangeInfo(cluster));
+    }
+
+    std::vector<const vk::AccelerationStructureBuildRangeInfoKHR*> pBuildRangeInfos;
+    for (const vk::AccelerationStructureBuildRangeInfoKHR &buildRangeInfo: buildRangeInfos) {
+        pBuildRangeInfos.push_back(&buildRangeInfo);
+    }
+
+    const vk::AccelerationStructureKHR topLevel = topAccelerationStructure.accelerationStructures.front();
+
+    vk::AccelerationStructureBuildGeometryInfoKHR topBuildInfo = {
+            .type = vk::AccelerationStructureTypeKHR::eTopLevel,
+            .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace |
+                     vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate,
+            .mode = vk::BuildAccelerationStructureModeKHR::eUpdate,
+            .srcAccelerationStructure = topLevel,
+            .dstAccelerationStructure = topLevel,
+            .geometryCount = 1,
+            .pGeometries = &instancesGeometry,
+            .scratchData = {.deviceAddress = scratchAddress + updateScratchOffsets[
+                    bottomAccelerationStructures.accelerationStructures.size()]}
+    };
+
+    const vk::AccelerationStructureBuildRangeInfoKHR topBuildRangeInfo = {
+            .primitiveCount = static_cast<uint32_t>(scenePartition.instances.size()),
+            .primitiveOffset = 0,
+            .firstVertex = 0,
+            .transformOffset = 0
+    };
+    const vk::AccelerationStructureBuildRangeInfoKHR* pTopBuildRangeInfo = &topBuildRangeInfo;
+
+    // THE STAGING RING'S LAST SUBMIT ENDS WITH THE BARRIER FOR THE UPLOADED AABBS
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        singleTimeCommandBuffer.buildAccelerationStructuresKHR(static_cast<uint32_t>(buildInfos.size()),
+                                                               buildInfos.data(), pBuildRangeInfos.data(),
+                                                               dynamicDispatchLoader);
+
+        // THE TLAS UPDATE READS THE REFIT BLASES
+        vk::MemoryBarrier memoryBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eAccelerationStructureWriteKHR,
+                .dstAccessMask = vk::AccessFlagBits::eAccelerationStructureReadKHR
+        };
+
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR,
+                                                vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR,
+                                                {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        singleTimeCommandBuffer.buildAccelerationStructuresKHR(1, &topBuildInfo, &pTopBuildRangeInfo,
+                                                               dynamicDispatchLoader);
+    });
+}
+
+// ALL STRUCTURES SHARE ONE BUFFER, SO THOUSANDS OF CLUSTERS DO NOT EXHAUST THE ALLOCATION COUNT LIMIT
+VulkanAccelerationStructures Vulkan::createAccelerationStructures(vk::AccelerationStructureTypeKHR type,
+                                                                  const std::vector<vk::DeviceSize> &sizes) {
+    const std::vector<vk::DeviceSize> offsets = getAlignedOffsets(sizes, ACCELERATION_STRUCTURE_ALIGNMENT);
+
+    VulkanAccelerationStructures accelerationStructures = {
+            .structureBuffer = createBuffer(std::max<vk::DeviceSize>(offsets.back(), 1),
+                                            vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR |
+                                            vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                            vk::MemoryPropertyFlagBits::eDeviceLocal)
+    };
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+        vk::AccelerationStructureCreateInfoKHR createInfo = {
+                .buffer = accelerationStructures.structureBuffer.buffer,
+                .offset = offsets[i],
+                .size = sizes[i],
+                .type = type
+        };
+
+        accelerationStructures.accelerationStructures.push_back(
+                device.createAccelerationStructureKHR(createInfo, nullptr, dynamicDispatchLoader));
+    }
+
+    return accelerationStructures;
+}
+
+// BUILDS INTO TEMPORARY STRUCTURES, QUERIES THEIR COMPACTED SIZES & COPIES THEM INTO STRUCTURES OF EXACTLY THAT SIZE.
+// ALL BUILDS SHARE ONE SUBMIT & ONE SCRATCH BUFFER, WHICH IS FREED WITH THE UNCOMPACTED STRUCTURES RIGHT AFTERWARDS.
+// STRUCTURES OF A DYNAMIC SCENE ARE REFIT LATER, SO THEY ALLOW UPDATES & ARE NOT COMPACTED
+VulkanAccelerationStructures Vulkan::buildAccelerationStructures(
+        std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos,
+        const std::vector<vk::AccelerationStructureBuildRangeInfoKHR> &buildRangeInfos) {
+
+    const vk::AccelerationStructureTypeKHR type = buildInfos.front().type;
+
+    // CALCULATE REQUIRED SIZES FOR THE ACCELERATION STRUCTURES
+    std::vector<vk::DeviceSize> uncompactedSizes, scratchSizes, updateScratchSizes;
+
+    for (size_t i = 0; i < buildInfos.size(); i++) {
+        buildInfos[i].flags |= settings.dynamicScene ? vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate
+                                                     : vk::BuildAccelerationStructureFlagBitsKHR::eAllowCompaction;
+
+        std::vector<uint32_t> maxPrimitiveCounts = {buildRangeInfos[i].primitiveCount};
+
+        vk::AccelerationStructureBuildSizesInfoKHR buildSizesInfo = device.getAccelerationStructureBuildSizesKHR(
+                vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfos[i], maxPrimitiveCounts,
+                dynamicDispatchLoader);
+
+        uncompactedSizes.push_back(buildSizesInfo.accelerationStructureSize);
+        scratchSizes.push_back(buildSizesInfo.buildScratchSize);
+        updateScratchSizes.push_back(buildSizesInfo.updateScratchSize);
+    }
+
+
+    // BUILD
+    VulkanAccelerationStructures uncompactedAccelerationStructures =
+            createAccelerationStructures(type, uncompactedSizes);
+
+    const std::vector<vk::DeviceSize> scratchOffsets = getAlignedOffsets(
+            scratchSizes, getAccelerationStructureProperties().minAccelerationStructureScratchOffsetAlignment);
+
+    VulkanBuffer scratchBuffer = createBuffer(std::max<vk::DeviceSize>(scratchOffsets.back(), 1),
+                                              vk::BufferUsageFlagBits::eStorageBuffer |
+                                              vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    const vk::DeviceAddress scratchAddress = device.getBufferAddress({.buffer = scratchBuffer.buffer});
+
+    std::vector<const vk::AccelerationStructureBuildRangeInfoKHR*> pBuildRangeInfos;
+    for (size_t i = 0; i < buildInfos.size(); i++) {
+        buildInfos[i].dstAccelerationStructure = uncompactedAccelerationStructures.accelerationStructures[i];
+        buildInfos[i].scratchData.deviceAddress = scratchAddress + scratchOffsets[i];
+        pBuildRangeInfos.push_back(&buildRangeInfos[i]);
+    }
+
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        singleTimeCommandBuffer.buildAccelerationStructuresKHR(static_cast<uint32_t>(buildInfos.size()),
+                                                               buildInfos.data(), pBuildRangeInfos.data(),
+                                                               dynamicDispatchLoader);
+    });
+
+    destroyBuffer(scratchBuffer);
+
+    for (size_t i = 0; i < uncompactedSizes.size(); i++) {
+        uncompactedAccelerationStructureMemory += uncompactedSizes[i];
+    }
+
+    if (settings.dynamicScene) {
+        for (size_t i = 0; i < uncompactedSizes.size(); i++) {
+            accelerationStructureMemory += uncompactedSizes[i];
+        }
+
+        uncompactedAccelerationStructures.updateScratchSizes = std::move(updateScratchSizes);
+        return uncompactedAccelerationStructures;
+    }
+
+
+    // COMPACT
+    const std::vector<vk::DeviceSize> compactedSizes = queryAccelerationStructureProperties(
+            uncompactedAccelerationStructures.accelerationStructures,
+            vk::QueryType::eAccelerationStructureCompactedSizeKHR);
+
+    VulkanAccelerationStructures accelerationStructures = createAccelerationStructures(type, compactedSizes);
+
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        for (size_t i = 0; i < compactedSizes.size(); i++) {
+            vk::CopyAccelerationStructureInfoKHR copyInfo = {
+                    .src = uncompactedAccelerationStructures.accelerationStructures[i],
+                    .dst = accelerationStructures.accelerationStructures[i],
+                    .mode = vk::CopyAccelerationStructureModeKHR::eCompact
+            };
+
+            singleTimeCommandBuffer.copyAccelerationStructureKHR(copyInfo, dynamicDispatchLoader);
+        }
+    });
+
+    destroyAccelerationStructures(uncompactedAccelerationStructures);
+
+    for (size_t i = 0; i < compactedSizes.size(); i++) {
+        accelerationStructureMemory += compactedSizes[i];
+    }
+
+    return accelerationStructures;
+}
+
+std::vector<vk::DeviceSize> Vulkan::queryAccelerationStructureProperties(
+        const std::vector<vk::AccelerationStructureKHR> &accelerationStructures, vk::QueryType queryType) {
+
+    const auto queryCount = static_cast<uint32_t>(accelerationStructures.size());
+
+    vk::QueryPool queryPool = device.createQueryPool(
+            {
+                    .queryType = queryType,
+                    .queryCount = queryCount
+            });
+
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        // THE STRUCTURES WERE BUILT OR COPIED BY AN EARLIER SUBMIT
+        vk::MemoryBarrier memoryBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eAccelerationStructureWriteKHR,
+                .dstAccessMask = vk::AccessFlagBits::eAccelerationStructureReadKHR
+        };
+
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR,
+                                                vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR,
+                                                {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        singleTimeCommandBuffer.resetQueryPool(queryPool, 0, queryCount);
+        singleTimeCommandBuffer.writeAccelerationStructuresPropertiesKHR(queryCount, accelerationStructures.data(),
+                                                                         queryType, queryPool, 0,
+                                                                         dynamicDispatchLoader);
+    });
+
+    std::vector<vk::DeviceSize> values(queryCount);
+    const vk::Result result = device.getQueryPoolResults(queryPool, 0, queryCount,
+                                                         values.size() * sizeof(vk::DeviceSize), values.data(),
+                                                         sizeof(vk::DeviceSize),
+                                                         vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+
+    device.destroyQueryPool(queryPool);
+
+    if (result != vk::Result::eSuccess) {
+        throw std::runtime_error("[Error] Failed to query acceleration structure properties!");
+    }
+
+    return values;
+}
 
-    c(singleTimeCommandBuffer);
+// OFFSETS OF CONSECUTIVE ALIGNED ALLOCATIONS, FOLLOWED BY THE TOTAL SIZE
+std::vector<vk::DeviceSize> Vulkan::getAlignedOffsets(const std::vector<vk::DeviceSize> &sizes,
+                                                      vk::DeviceSize alignment) {
+    std::vector<vk::DeviceSize> offsets = {0};
 
-    singleTimeCommandBuffer.end();
+    for (const vk::DeviceSize size: sizes) {
+        offsets.push_back((offsets.back() + size + alignment - 1) / alignment * alignment);
+    }
 
+    return offsets;
+}
 
-    vk::SubmitInfo submitInfo = {
-            .commandBufferCount = 1,
-            .pCommandBuffers = &singleTimeCommandBuffer
+vk::PhysicalDeviceAccelerationStructurePropertiesKHR Vulkan::getAccelerationStructureProperties() const {
+    vk::PhysicalDeviceAccelerationStructurePropertiesKHR accelerationStructureProperties = {};
+
+    vk::PhysicalDeviceProperties2 physicalDeviceProperties2 = {
+            .pNext = &accelerationStructureProperties
     };
 
-    vk::Fence f = device.createFence({});
-    computeQueue.submit(1, &submitInfo, f);
-    device.waitForFences(1, &f, true, UINT64_MAX);
+    physicalDevice.getProperties2(&physicalDeviceProperties2);
 
-    device.destroyFence(f);
-    device.freeCommandBuffers(commandPool, singleTimeCommandBuffer);
+    return accelerationStructureProperties;
 }
 
-void Vulkan::createAABBBuffer() {
-    const vk::DeviceSize bufferSize = sizeof(vk::AabbPositionsKHR) * aabbs.size();
+// THE BLASES ARE CACHED PER SCENE & DEVICE. THE TLAS REFERENCES THEM BY ADDRESS, SO IT IS CHEAPER TO REBUILD THAN TO
+// DESERIALIZE & PATCH
+std::string Vulkan::getAccelerationStructureCachePath(uint64_t sceneHash) const {
+    // CACHED STRUCTURES ARE COMPACTED & CANNOT BE REFIT
+    if (settings.accelerationStructureCacheDirectory.empty() || settings.dynamicScene) {
+        return "";
+    }
 
-    aabbBuffer = createBuffer(bufferSize,
-                              vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
-                              vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                              vk::MemoryPropertyFlagBits::eHostVisible |
-                              vk::MemoryPropertyFlagBits::eHostCoherent |
-                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+    char name[32];
+    snprintf(name, sizeof(name), "blas_%016llx.bin", static_cast<unsigned long long>(sceneHash));
 
-    void* data = device.mapMemory(aabbBuffer.memory, 0, bufferSize);
-    memcpy(data, aabbs.data(), bufferSize);
-    device.unmapMemory(aabbBuffer.memory);
+    return (std::filesystem::path(settings.accelerationStructureCacheDirectory) / name).string();
 }
 
-void Vulkan::createBottomAccelerationStructure() {
-    // ACCELERATION STRUCTURE META INFO
-    vk::AccelerationStructureGeometryKHR geometry = {
-            .geometryType = vk::GeometryTypeKHR::eAabbs,
-            .flags = vk::GeometryFlagBitsKHR::eOpaque
-    };
+// THE BLASES ONLY DEPEND ON THE SPHERE GEOMETRY & THE CLUSTERING, A DEVICE GENERATED SCENE ON ITS GENERATION SETTINGS
+uint64_t Vulkan::getSceneHash(const Scene &scene, bool splitMaterialVariants) {
+    const float clusterSize = SCENE_CLUSTER_SIZE;
+
+    if (scene.generation) {
+        const SceneGenerationSettings &generation = *scene.generation;
+        const uint32_t values[] = {
+                generation.sphereAmount, generation.seed, getSceneGridSize(generation),
+                std::bit_cast<uint32_t>(generation.diffuseProbability),
+                std::bit_cast<uint32_t>(generation.metalProbability), generation.patternSize,
+                std::bit_cast<uint32_t>(clusterSize)
+        };
 
-    geometry.geometry.aabbs.sType = vk::StructureType::eAccelerationStructureGeometryAabbsDataKHR;
-    geometry.geometry.aabbs.stride = sizeof(vk::AabbPositionsKHR);
-    geometry.geometry.aabbs.data.deviceAddress = device.getBufferAddress({.buffer = aabbBuffer.buffer});
+        return getChecksum(values, sizeof(values)) ^ 0x9e3779b97f4a7c15ull;
+    }
 
+    // SPLIT CLUSTERS ALSO DEPEND ON THE MATERIAL VARIANTS
+    uint64_t hash = getChecksum(&clusterSize, sizeof(float));
+    for (const Sphere &sphere: scene.spheres) {
+        hash = (hash ^ getChecksum(&sphere.geometry, sizeof(glm::vec4))) * 1099511628211ull;
 
-    vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = {
-            .type = vk::AccelerationStructureTypeKHR::eBottomLevel,
-            .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace,
-            .mode = vk::BuildAccelerationStructureModeKHR::eBuild,
-            .srcAccelerationStructure = nullptr,
-            .dstAccelerationStructure = nullptr,
-            .geometryCount = 1,
-            .pGeometries = &geometry,
-            .scratchData = {}
+        if (splitMaterialVariants) {
+            hash = (hash ^ getMaterialVariant(sphere)) * 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+// FILE LAYOUT: HEADER, THE SERIALIZED SIZE OF EVERY BLAS, THE SERIALIZED BLASES BACK TO BACK
+bool Vulkan::loadBottomAccelerationStructures(const std::string &path, uint64_t sceneHash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const AccelerationStructureCacheHeader expectedHeader = getAccelerationStructureCacheHeader();
+    AccelerationStructureCacheHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(AccelerationStructureCacheHeader));
+
+    const auto rejectCache = [&path](const std::string &reason) {
+        std::cerr << "Ignoring the acceleration structure cache '" << path << "', " << reason << std::endl;
+        return false;
     };
 
+    if (!file || memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) != 0 ||
+        header.version != expectedHeader.version || header.sphereAmount != sphereAmount ||
+        header.accelerationStructureCount != scenePartition.clusters.size() || header.sceneHash != sceneHash ||
+        memcmp(header.deviceUUID, expectedHeader.deviceUUID, VK_UUID_SIZE) != 0) {
+        return rejectCache("it was created for another scene or device");
+    }
 
-    // CALCULATE REQUIRED SIZE FOR THE ACCELERATION STRUCTURE
-    std::vector<uint32_t> maxPrimitiveCounts = {static_cast<uint32_t>(aabbs.size())};
+    std::vector<vk::DeviceSize> serializedSizes(header.accelerationStructureCount);
+    file.read(reinterpret_cast<char*>(serializedSizes.data()),
+              static_cast<std::streamsize>(serializedSizes.size() * sizeof(vk::DeviceSize)));
 
-    vk::AccelerationStructureBuildSizesInfoKHR buildSizesInfo = device.getAccelerationStructureBuildSizesKHR(
-            vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, maxPrimitiveCounts, dynamicDispatchLoader);
+    // THE DRIVER'S OWN HEADER: DRIVER UUID, COMPATIBILITY UUID, SERIALIZED SIZE, DESERIALIZED SIZE, HANDLE COUNT
+    const vk::DeviceSize driverHeaderSize = 2 * VK_UUID_SIZE + 3 * sizeof(uint64_t);
 
+    vk::DeviceSize serializedSize = 0;
+    for (const vk::DeviceSize size: serializedSizes) {
+        serializedSize += size;
+        if (size < driverHeaderSize) {
+            return rejectCache("it is corrupt");
+        }
+    }
 
-    // ALLOCATE BUFFERS FOR ACCELERATION STRUCTURE
-    bottomAccelerationStructure.structureBuffer = createBuffer(buildSizesInfo.accelerationStructureSize,
-                                                               vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR |
-        vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                                                               vk::MemoryPropertyFlagBits::eDeviceLocal);
+    if (!file || serializedSize != header.serializedSize ||
+        std::filesystem::file_size(path) != sizeof(AccelerationStructureCacheHeader) +
+                                            serializedSizes.size() * sizeof(vk::DeviceSize) + serializedSize) {
+        return rejectCache("it is corrupt");
+    }
 
-    bottomAccelerationStructure.scratchBuffer = createBuffer(buildSizesInfo.buildScratchSize,
-                                                             vk::BufferUsageFlagBits::eStorageBuffer |
-                                                             vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                                                             vk::MemoryPropertyFlagBits::eDeviceLocal);
+    // EVERY SERIALIZED BLAS HAS TO START AT AN ALIGNED DEVICE ADDRESS
+    const std::vector<vk::DeviceSize> offsets = getAlignedOffsets(serializedSizes, ACCELERATION_STRUCTURE_ALIGNMENT);
 
-    // CREATE THE ACCELERATION STRUCTURE
-    vk::AccelerationStructureCreateInfoKHR createInfo = {
-            .buffer = bottomAccelerationStructure.structureBuffer.buffer,
-            .offset = 0,
-            .size = buildSizesInfo.accelerationStructureSize,
-            .type = vk::AccelerationStructureTypeKHR::eBottomLevel
-    };
+    VulkanBuffer serializedBuffer = createBuffer(offsets.back() + ACCELERATION_STRUCTURE_ALIGNMENT,
+                                                 vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
+                                                 vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                                 vk::MemoryPropertyFlagBits::eHostVisible |
+                                                 vk::MemoryPropertyFlagBits::eHostCoherent);
 
-    bottomAccelerationStructure.accelerationStructure =
-            device.createAccelerationStructureKHR(createInfo, nullptr, dynamicDispatchLoader);
+    const vk::DeviceAddress bufferAddress = device.getBufferAddress({.buffer = serializedBuffer.buffer});
+    const vk::DeviceAddress serializedAddress = (bufferAddress + ACCELERATION_STRUCTURE_ALIGNMENT - 1) &
+                                                ~(ACCELERATION_STRUCTURE_ALIGNMENT - 1);
 
+    auto* serializedData = static_cast<uint8_t*>(serializedBuffer.allocation.mappedData) +
+                           (serializedAddress - bufferAddress);
 
-    // FILL IN THE REMAINING META INFO
-    buildInfo.dstAccelerationStructure = bottomAccelerationStructure.accelerationStructure;
-    buildInfo.scratchData.deviceAddress =
-            device.getBufferAddress({.buffer = bottomAccelerationStructure.scratchBuffer.buffer});
+    bool compatible = true;
+    std::vector<vk::DeviceSize> deserializedSizes(serializedSizes.size());
 
+    for (size_t i = 0; i < serializedSizes.size() && compatible; i++) {
+        uint8_t* data = serializedData + offsets[i];
+        file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(serializedSizes[i]));
 
-    // BUILD THE ACCELERATION STRUCTURE
-    vk::AccelerationStructureBuildRangeInfoKHR buildRangeInfo = {
-            .primitiveCount = static_cast<uint32_t>(aabbs.size()),
-            .primitiveOffset = 0,
-            .firstVertex = 0,
-            .transformOffset = 0
-    };
+        vk::AccelerationStructureVersionInfoKHR versionInfo = {
+                .pVersionData = data
+        };
+
+        compatible = file && device.getAccelerationStructureCompatibilityKHR(versionInfo, dynamicDispatchLoader) ==
+                             vk::AccelerationStructureCompatibilityKHR::eCompatible;
+
+        memcpy(&deserializedSizes[i], data + 2 * VK_UUID_SIZE + sizeof(uint64_t), sizeof(uint64_t));
+    }
+
+    if (!compatible) {
+        destroyBuffer(serializedBuffer);
+        return rejectCache("it is incompatible with the driver");
+    }
 
-    const vk::AccelerationStructureBuildRangeInfoKHR* pBuildRangeInfos[] = {&buildRangeInfo};
+    // DESERIALIZE
+    bottomAccelerationStructures = createAccelerationStructures(vk::AccelerationStructureTypeKHR::eBottomLevel,
+                                                                deserializedSizes);
 
     executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
-        singleTimeCommandBuffer.buildAccelerationStructuresKHR(1, &buildInfo, pBuildRangeInfos, dynamicDispatchLoader);
+        for (size_t i = 0; i < deserializedSizes.size(); i++) {
+            vk::CopyMemoryToAccelerationStructureInfoKHR copyInfo = {
+                    .dst = bottomAccelerationStructures.accelerationStructures[i],
+                    .mode = vk::CopyAccelerationStructureModeKHR::eDeserialize
+            };
+
+            copyInfo.src.deviceAddress = serializedAddress + offsets[i];
+
+            singleTimeCommandBuffer.copyMemoryToAccelerationStructureKHR(copyInfo, dynamicDispatchLoader);
+        }
     });
-}
 
-void Vulkan::createTopAccelerationStructure() {
-    // ACCELERATION STRUCTURE META INFO
-    vk::AccelerationStructureGeometryKHR geometry = {
-            .geometryType = vk::GeometryTypeKHR::eInstances,
-            .flags = vk::GeometryFlagBitsKHR::eOpaque
-    };
+    destroyBuffer(serializedBuffer);
 
-    geometry.geometry.instances.sType = vk::StructureType::eAccelerationStructureGeometryInstancesDataKHR;
-    geometry.geometry.instances.arrayOfPointers = false;
+    for (const vk::DeviceSize size: deserializedSizes) {
+        accelerationStructureMemory += size;
+    }
+    uncompactedAccelerationStructureMemory += header.uncompactedSize;
 
+    return true;
+}
 
-    vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = {
-            .type = vk::AccelerationStructureTypeKHR::eTopLevel,
-            .flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace,
-            .mode = vk::BuildAccelerationStructureModeKHR::eBuild,
-            .srcAccelerationStructure = nullptr,
-            .dstAccelerationStructure = nullptr,
-            .geometryCount = 1,
-            .pGeometries = &geometry,
-            .scratchData = {}
-    };
+void Vulkan::saveBottomAccelerationStructures(const std::string &path, uint64_t sceneHash) {
+    // A CACHE THAT CANNOT BE WRITTEN ONLY COSTS THE NEXT START ITS BUILD. THE HOST VISIBLE COPY IS FREED ON EVERY PATH
+    VulkanBuffer serializedBuffer = {};
 
+    try {
+        const std::vector<vk::DeviceSize> serializedSizes = queryAccelerationStructureProperties(
+                bottomAccelerationStructures.accelerationStructures,
+                vk::QueryType::eAccelerationStructureSerializationSizeKHR);
 
-    // CALCULATE REQUIRED SIZE FOR THE ACCELERATION STRUCTURE
-    vk::AccelerationStructureBuildSizesInfoKHR buildSizesInfo = device.getAccelerationStructureBuildSizesKHR(
-            vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, {1}, dynamicDispatchLoader);
+        const std::vector<vk::DeviceSize> offsets = getAlignedOffsets(serializedSizes,
+                                                                      ACCELERATION_STRUCTURE_ALIGNMENT);
 
+        serializedBuffer = createBuffer(offsets.back() + ACCELERATION_STRUCTURE_ALIGNMENT,
+                                        vk::BufferUsageFlagBits::eStorageBuffer |
+                                        vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                        vk::MemoryPropertyFlagBits::eHostVisible |
+                                        vk::MemoryPropertyFlagBits::eHostCoherent);
 
-    // ALLOCATE BUFFERS FOR ACCELERATION STRUCTURE
-    topAccelerationStructure.structureBuffer = createBuffer(buildSizesInfo.accelerationStructureSize,
-                                                            vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR,
-                                                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        const vk::DeviceAddress bufferAddress = device.getBufferAddress({.buffer = serializedBuffer.buffer});
+        const vk::DeviceAddress serializedAddress = (bufferAddress + ACCELERATION_STRUCTURE_ALIGNMENT - 1) &
+                                                    ~(ACCELERATION_STRUCTURE_ALIGNMENT - 1);
 
-    topAccelerationStructure.scratchBuffer = createBuffer(buildSizesInfo.buildScratchSize,
-                                                          vk::BufferUsageFlagBits::eStorageBuffer |
-                                                          vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                                                          vk::MemoryPropertyFlagBits::eDeviceLocal);
+        executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+            for (size_t i = 0; i < serializedSizes.size(); i++) {
+                vk::CopyAccelerationStructureToMemoryInfoKHR copyInfo = {
+                        .src = bottomAccelerationStructures.accelerationStructures[i],
+                        .mode = vk::CopyAccelerationStructureModeKHR::eSerialize
+                };
 
-    // CREATE THE ACCELERATION STRUCTURE
-    vk::AccelerationStructureCreateInfoKHR createInfo = {
-            .buffer = topAccelerationStructure.structureBuffer.buffer,
-            .offset = 0,
-            .size = buildSizesInfo.accelerationStructureSize,
-            .type = vk::AccelerationStructureTypeKHR::eTopLevel
-    };
+                copyInfo.dst.deviceAddress = serializedAddress + offsets[i];
 
-    topAccelerationStructure.accelerationStructure =
-            device.createAccelerationStructureKHR(createInfo, nullptr, dynamicDispatchLoader);
+                singleTimeCommandBuffer.copyAccelerationStructureToMemoryKHR(copyInfo, dynamicDispatchLoader);
+            }
+        });
 
+        AccelerationStructureCacheHeader header = getAccelerationStructureCacheHeader();
+        header.sphereAmount = sphereAmount;
+        header.accelerationStructureCount = static_cast<uint32_t>(serializedSizes.size());
+        header.sceneHash = sceneHash;
+        // THE BLASES ARE BUILT BEFORE THE TLAS, SO THIS IS THEIR SIZE ALONE
+        header.uncompactedSize = uncompactedAccelerationStructureMemory;
+        header.serializedSize = 0;
+        for (const vk::DeviceSize size: serializedSizes) {
+            header.serializedSize += size;
+        }
 
-    // CREATE INSTANCE INFO & WRITE IN NEW BUFFER
-    std::array<std::array<float, 4>, 3> matrix = {
-            {
-                    {1.0f, 0.0f, 0.0f, 0.0f},
-                    {0.0f, 1.0f, 0.0f, 0.0f},
-                    {0.0f, 0.0f, 1.0f, 0.0f}
-            }};
+        // WRITE A TEMPORARY FILE & RENAME IT, SO A CRASH WHILE WRITING NEVER LEAVES A TRUNCATED CACHE BEHIND
+        std::filesystem::create_directories(settings.accelerationStructureCacheDirectory);
+        const std::string temporaryPath = path + ".tmp";
+        {
+            const auto* serializedData = static_cast<const uint8_t*>(serializedBuffer.allocation.mappedData) +
+                                         (serializedAddress - bufferAddress);
+
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(AccelerationStructureCacheHeader));
+            file.write(reinterpret_cast<const char*>(serializedSizes.data()),
+                       static_cast<std::streamsize>(serializedSizes.size() * sizeof(vk::DeviceSize)));
+
+            for (size_t i = 0; i < serializedSizes.size(); i++) {
+                file.write(reinterpret_cast<const char*>(serializedData + offsets[i]),
+                           static_cast<std::streamsize>(serializedSizes[i]));
+            }
 
-    vk::AccelerationStructureInstanceKHR accelerationStructureInstance = {
-            .transform = {.matrix = matrix},
-            .instanceCustomIndex = 0,
-            .mask = 0xFF,
-            .instanceShaderBindingTableRecordOffset = 0,
-            .accelerationStructureReference = device.getAccelerationStructureAddressKHR(
-                    {.accelerationStructure = bottomAccelerationStructure.accelerationStructure},
-                    dynamicDispatchLoader),
-    };
+            destroyBuffer(serializedBuffer);
+            serializedBuffer = {};
 
-    topAccelerationStructure.instancesBuffer = createBuffer(
-            sizeof(vk::AccelerationStructureInstanceKHR),
-            vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
-            vk::BufferUsageFlagBits::eShaderDeviceAddress,
-            vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostCoherent |
-            vk::MemoryPropertyFlagBits::eHostVisible);
+            if (!file) {
+                throw std::runtime_error("[Error] Failed to write '" + temporaryPath + "'!");
+            }
+        }
 
-    void* pInstancesBuffer = device.mapMemory(topAccelerationStructure.instancesBuffer.memory, 0,
-                                              sizeof(vk::AccelerationStructureInstanceKHR));
-    memcpy(pInstancesBuffer, &accelerationStructureInstance, sizeof(vk::AccelerationStructureInstanceKHR));
-    device.unmapMemory(topAccelerationStructure.instancesBuffer.memory);
+        std::filesystem::rename(temporaryPath, path);
+    } catch (const std::exception &exception) {
+        if (serializedBuffer.buffer) {
+            destroyBuffer(serializedBuffer);
+        }
 
+        std::cerr << "Failed to save the acceleration structure cache: " << exception.what() << std::endl;
+    }
+}
 
-    // FILL IN THE REMAINING META INFO
-    buildInfo.dstAccelerationStructure = topAccelerationStructure.accelerationStructure;
-    buildInfo.scratchData.deviceAddress = device.getBufferAddress(
-            {.buffer = topAccelerationStructure.scratchBuffer.buffer});
+AccelerationStructureCacheHeader Vulkan::getAccelerationStructureCacheHeader() const {
+    vk::PhysicalDeviceIDProperties idProperties = {};
 
-    geometry.geometry.instances.data.deviceAddress = device.getBufferAddress(
-            {.buffer = topAccelerationStructure.instancesBuffer.buffer});
+    vk::PhysicalDeviceProperties2 physicalDeviceProperties2 = {
+            .pNext = &idProperties
+    };
 
+    physicalDevice.getProperties2(&physicalDeviceProperties2);
 
-    // BUILD THE ACCELERATION STRUCTURE
-    vk::AccelerationStructureBuildRangeInfoKHR buildRangeInfo = {
-            .primitiveCount = 1,
-            .primitiveOffset = 0,
-            .firstVertex = 0,
-            .transformOffset = 0
+    AccelerationStructureCacheHeader header = {
+            .magic = {'R', 'T', 'A', 'S', 'C', 'A', 'C', 'H'},
+            .version = 2
     };
 
-    const vk::AccelerationStructureBuildRangeInfoKHR* pBuildRangeInfos[] = {&buildRangeInfo};
+    memcpy(header.deviceUUID, idProperties.deviceUUID.data(), VK_UUID_SIZE);
 
-    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
-        singleTimeCommandBuffer.buildAccelerationStructuresKHR(1, &buildInfo, pBuildRangeInfos, dynamicDispatchLoader);
-    });
+    return header;
 }
 
-void Vulkan::destroyAccelerationStructure(const VulkanAccelerationStructure &accelerationStructure) {
-    device.destroyAccelerationStructureKHR(accelerationStructure.accelerationStructure, nullptr, dynamicDispatchLoader);
-    destroyBuffer(accelerationStructure.structureBuffer);
-    destroyBuffer(accelerationStructure.scratchBuffer);
-    destroyBuffer(accelerationStructure.instancesBuffer);
+void Vulkan::destroyAccelerationStructures(const VulkanAccelerationStructures &accelerationStructures) {
+    for (const vk::AccelerationStructureKHR &accelerationStructure: accelerationStructures.accelerationStructures) {
+        device.destroyAccelerationStructureKHR(accelerationStructure, nullptr, dynamicDispatchLoader);
+    }
+
+    destroyBuffer(accelerationStructures.structureBuffer);
 }
 
 vk::ShaderModule Vulkan::createShaderModule(const std::string &path) const {
@@ -1108,14 +3325,18 @@ void Vulkan::createShaderBindingTable() {
     uint32_t handleSize = rayTracingProperties.shaderGroupHandleSize;
 
 
-    const uint32_t shaderGroupCount = 3;
-    vk::DeviceSize sbtBufferSize = baseAlignment * shaderGroupCount;
+    // RAYGEN & MISS GET A BASE ALIGNED RECORD EACH, THE HIT GROUPS FOLLOW AS AN ARRAY THE INSTANCES INDEX INTO
+    const auto hitGroupCount = static_cast<uint32_t>(hitGroupMaterialVariants.size());
+    const uint32_t shaderGroupCount = 2 + hitGroupCount;
+    const uint32_t hitGroupStride = (handleSize + rayTracingProperties.shaderGroupHandleAlignment - 1) /
+                                    rayTracingProperties.shaderGroupHandleAlignment *
+                                    rayTracingProperties.shaderGroupHandleAlignment;
+    vk::DeviceSize sbtBufferSize = baseAlignment * 2 + hitGroupStride * hitGroupCount;
 
     shaderBindingTableBuffer = createBuffer(sbtBufferSize,
                                             vk::BufferUsageFlagBits::eShaderBindingTableKHR |
-                                            vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                                            vk::MemoryPropertyFlagBits::eHostVisible |
-                                            vk::MemoryPropertyFlagBits::eHostCoherent |
+                                            vk::BufferUsageFlagBits::eShaderDeviceAddress |
+                                            vk::BufferUsageFlagBits::eTransferDst,
                                             vk::MemoryPropertyFlagBits::eDeviceLocal);
 
 
@@ -1136,16 +3357,28 @@ void Vulkan::createShaderBindingTable() {
     sbtMissAddressRegion = addressRegion;
     sbtMissAddressRegion.deviceAddress = sbtAddress + baseAlignment;
 
-    sbtHitAddressRegion = addressRegion;
-    sbtHitAddressRegion.deviceAddress = sbtAddress + baseAlignment * 2;
+    sbtHitAddressRegion = {
+            .deviceAddress = sbtAddress + baseAlignment * 2,
+            .stride = hitGroupStride,
+            .size = hitGroupStride * hitGroupCount
+    };
 
-    uint8_t* sbtBufferData = static_cast<uint8_t*>(device.mapMemory(shaderBindingTableBuffer.memory, 0, sbtBufferSize));
+    auto* sbtBufferData = static_cast<uint8_t*>(stagingRing->stage(shaderBindingTableBuffer.buffer, 0,
+                                                                   sbtBufferSize));
 
     memcpy(sbtBufferData, handles.data(), handleSize);
     memcpy(sbtBufferData + baseAlignment, handles.data() + handleSize, handleSize);
-    memcpy(sbtBufferData + baseAlignment * 2, handles.data() + handleSize * 2, handleSize);
+    for (uint32_t hitGroup = 0; hitGroup < hitGroupCount; hitGroup++) {
+        memcpy(sbtBufferData + baseAlignment * 2 + hitGroupStride * hitGroup,
+               handles.data() + handleSize * (2 + hitGroup), handleSize);
+    }
+
+    stagingRing->submit();
+}
 
-    device.unmapMemory(shaderBindingTableBuffer.memory);
+uint32_t Vulkan::getHitGroupIndex(uint32_t materialVariant) const {
+    const auto hitGroup = std::find(hitGroupMaterialVariants.begin(), hitGroupMaterialVariants.end(), materialVariant);
+    return static_cast<uint32_t>(hitGroup - hitGroupMaterialVariants.begin());
 }
 
 vk::PhysicalDeviceRayTracingPipelinePropertiesKHR Vulkan::getRayTracingProperties() const {
@@ -1160,18 +3393,288 @@ vk::PhysicalDeviceRayTracingPipelinePropertiesKHR Vulkan::getRayTracingPropertie
     return rayTracingPipelinePropertiesKhr;
 }
 
-void Vulkan::createSphereBuffer() {
-    const vk::DeviceSize bufferSize = sizeof(Sphere) * MAX_SPHERE_AMOUNT;
+vk::DeviceSize Vulkan::getSphereBufferSize() const {
+    const vk::DeviceSize bufferSize = sizeof(Sphere) * sphereAmount;
+
+    // THE SHADERS INDEX THE SPHERES WITH gl_PrimitiveID, SO THE WHOLE SCENE HAS TO FIT INTO ONE BINDING
+    const uint32_t maxStorageBufferRange = physicalDevice.getProperties().limits.maxStorageBufferRange;
+    if (bufferSize > maxStorageBufferRange) {
+        throw std::runtime_error("[Error] The scene (" + std::to_string(bufferSize) +
+                                 " bytes) exceeds the maximum storage buffer range of " +
+                                 std::to_string(maxStorageBufferRange) + " bytes!");
+    }
+
+    return bufferSize;
+}
+
+void Vulkan::createSphereBuffer(const Scene &scene) {
+    const vk::DeviceSize bufferSize = getSphereBufferSize();
 
     sphereBuffer = createBuffer(bufferSize,
-                                vk::BufferUsageFlagBits::eUniformBuffer,
-                                vk::MemoryPropertyFlagBits::eHostVisible |
-                                vk::MemoryPropertyFlagBits::eHostCoherent |
+                                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    // ONLY THE SPHERES OF UNIQUE CLUSTERS, IN CLUSTER ORDER
+    stagingRing->upload(sphereBuffer.buffer, sizeof(Sphere), sphereAmount,
+                        [&](void* data, size_t firstSphere, size_t count) {
+                            auto* spheres = static_cast<Sphere*>(data);
+                            for (size_t i = 0; i < count; i++) {
+                                spheres[i] = scene.spheres[scenePartition.sphereIndices[firstSphere + i]];
+                            }
+                        });
+
+    if (settings.dynamicScene) {
+        sphereGeometries.resize(sphereAmount);
+        for (uint32_t i = 0; i < sphereAmount; i++) {
+            sphereGeometries[i] = scene.spheres[scenePartition.sphereIndices[i]].geometry;
+        }
+    }
+}
+
+void Vulkan::generateSceneOnDevice(const SceneGenerationSettings &generationSettings) {
+    struct SceneGenerationPushConstants {
+        uint32_t seed;
+        uint32_t sphereAmount;
+        uint32_t gridSize;
+        float diffuseProbability;
+        float metalProbability;
+        uint32_t patternSize;
+    };
+
+    const SceneGenerationPushConstants pushConstants = {
+            .seed = generationSettings.seed,
+            .sphereAmount = sphereAmount,
+            .gridSize = getSceneGridSize(generationSettings),
+            .diffuseProbability = generationSettings.diffuseProbability,
+            .metalProbability = generationSettings.metalProbability,
+            .patternSize = generationSettings.patternSize
+    };
+
+    // BOTH BUFFERS ONLY EVER LIVE ON THE DEVICE. UPDATES OF A DYNAMIC SCENE ARE COPIED IN FROM THE STAGING RING
+    sphereBuffer = createBuffer(getSphereBufferSize(),
+                                vk::BufferUsageFlagBits::eStorageBuffer |
+                                vk::BufferUsageFlagBits::eTransferSrc |
+                                vk::BufferUsageFlagBits::eTransferDst,
                                 vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    void* data = device.mapMemory(sphereBuffer.memory, 0, bufferSize);
-    memcpy(data, scene.spheres, sizeof(Sphere) * scene.sphereAmount);
-    device.unmapMemory(sphereBuffer.memory);
+    aabbBuffer = createBuffer(sizeof(vk::AabbPositionsKHR) * sphereAmount,
+                              vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR |
+                              vk::BufferUsageFlagBits::eShaderDeviceAddress |
+                              vk::BufferUsageFlagBits::eStorageBuffer |
+                              vk::BufferUsageFlagBits::eTransferDst,
+                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    // COMPUTE PIPELINE, ONLY NEEDED FOR THIS ONE DISPATCH
+    std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+            {
+                    .binding = 0,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            {
+                    .binding = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = 1,
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+    };
+
+    vk::DescriptorSetLayout descriptorSetLayout = device.createDescriptorSetLayout(
+            {
+                    .bindingCount = static_cast<uint32_t>(bindings.size()),
+                    .pBindings = bindings.data()
+            });
+
+    vk::DescriptorPoolSize poolSize = {
+            .type = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 2
+    };
+
+    vk::DescriptorPool descriptorPool = device.createDescriptorPool(
+            {
+                    .maxSets = 1,
+                    .poolSizeCount = 1,
+                    .pPoolSizes = &poolSize
+            });
+
+    vk::DescriptorSet descriptorSet = device.allocateDescriptorSets(
+            {
+                    .descriptorPool = descriptorPool,
+                    .descriptorSetCount = 1,
+                    .pSetLayouts = &descriptorSetLayout
+            }).front();
+
+    vk::DescriptorBufferInfo sphereBufferInfo = {
+            .buffer = sphereBuffer.buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE
+    };
+
+    vk::DescriptorBufferInfo aabbBufferInfo = {
+            .buffer = aabbBuffer.buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE
+    };
+
+    std::vector<vk::WriteDescriptorSet> descriptorWrites = {
+            {
+                    .dstSet = descriptorSet,
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &sphereBufferInfo
+            },
+            {
+                    .dstSet = descriptorSet,
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .pBufferInfo = &aabbBufferInfo
+            }
+    };
+
+    device.updateDescriptorSets(static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(),
+                                0, nullptr);
+
+    vk::PushConstantRange pushConstantRange = {
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .offset = 0,
+            .size = sizeof(SceneGenerationPushConstants)
+    };
+
+    vk::PipelineLayout pipelineLayout = device.createPipelineLayout(
+            {
+                    .setLayoutCount = 1,
+                    .pSetLayouts = &descriptorSetLayout,
+                    .pushConstantRangeCount = 1,
+                    .pPushConstantRanges = &pushConstantRange
+            });
+
+    vk::ShaderModule computeModule = createShaderModule(generate_scene_shader_path);
+
+    vk::ComputePipelineCreateInfo pipelineCreateInfo = {
+            .stage = {
+                    .stage = vk::ShaderStageFlagBits::eCompute,
+                    .module = computeModule,
+                    .pName = "main"
+            },
+            .layout = pipelineLayout
+    };
+
+    vk::Pipeline pipeline = device.createComputePipeline(pipelineCache, pipelineCreateInfo).value;
+
+    // GENERATE: 256 SPHERES PER WORK GROUP, SPREAD OVER Y BEYOND THE WORK GROUP COUNT LIMIT OF X
+    const uint32_t maxWorkGroupCount = physicalDevice.getProperties().limits.maxComputeWorkGroupCount[0];
+    const uint32_t workGroupCount = (sphereAmount + 255) / 256;
+    const uint32_t workGroupCountX = std::min(workGroupCount, maxWorkGroupCount);
+    const uint32_t workGroupCountY = (workGroupCount + workGroupCountX - 1) / workGroupCountX;
+
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        singleTimeCommandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        singleTimeCommandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipelineLayout, 0, 1,
+                                                   &descriptorSet, 0, nullptr);
+        singleTimeCommandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0,
+                                              sizeof(SceneGenerationPushConstants), &pushConstants);
+        singleTimeCommandBuffer.dispatch(workGroupCountX, workGroupCountY, 1);
+
+        // THE AABBS ARE READ BY THE ACCELERATION STRUCTURE BUILD, THE SPHERES BY THE RAY TRACING SHADERS & BY THE
+        // READBACK OF A DYNAMIC SCENE
+        vk::MemoryBarrier memoryBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead
+        };
+
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                                vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR |
+                                                vk::PipelineStageFlagBits::eRayTracingShaderKHR |
+                                                vk::PipelineStageFlagBits::eTransfer,
+                                                {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    });
+
+    device.destroyPipeline(pipeline);
+    device.destroyShaderModule(computeModule);
+    device.destroyPipelineLayout(pipelineLayout);
+    device.destroyDescriptorPool(descriptorPool);
+    device.destroyDescriptorSetLayout(descriptorSetLayout);
+
+    // UPDATES COMPARE AGAINST THE GEOMETRY, SO ONLY MOVED SPHERES TOUCH THE ACCELERATION STRUCTURES
+    if (settings.dynamicScene) {
+        VulkanBuffer readbackBuffer = createBuffer(getSphereBufferSize(), vk::BufferUsageFlagBits::eTransferDst,
+                                                   vk::MemoryPropertyFlagBits::eHostVisible |
+                                                   vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+            const vk::BufferCopy region = {.srcOffset = 0, .dstOffset = 0, .size = getSphereBufferSize()};
+            singleTimeCommandBuffer.copyBuffer(sphereBuffer.buffer, readbackBuffer.buffer, 1, &region);
+
+            vk::MemoryBarrier memoryBarrier = {
+                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .dstAccessMask = vk::AccessFlagBits::eHostRead
+            };
+
+            singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                                    vk::PipelineStageFlagBits::eHost,
+                                                    {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+        });
+
+        const auto* spheres = static_cast<const Sphere*>(readbackBuffer.allocation.mappedData);
+        sphereGeometries.resize(sphereAmount);
+        for (uint32_t i = 0; i < sphereAmount; i++) {
+            sphereGeometries[i] = spheres[i].geometry;
+        }
+
+        destroyBuffer(readbackBuffer);
+    }
+}
+
+void Vulkan::createRayCounterBuffer() {
+    // ALWAYS BOUND TO BINDING 4, ONLY WRITTEN WHEN RAYS ARE COUNTED
+    rayCounterBuffer = createBuffer(sizeof(uint64_t),
+                                    vk::BufferUsageFlagBits::eStorageBuffer |
+                                    vk::BufferUsageFlagBits::eTransferSrc |
+                                    vk::BufferUsageFlagBits::eTransferDst,
+                                    vk::MemoryPropertyFlagBits::eDeviceLocal);
+}
+
+void Vulkan::createActivePixelBuffer() {
+    const vk::DeviceSize pixelCount = isAdaptiveSampling()
+                                      ? static_cast<vk::DeviceSize>(settings.windowWidth) * settings.windowHeight
+                                      : 0;
+
+    activePixelBuffer = createBuffer(sizeof(uint32_t) * (1 + pixelCount),
+                                     vk::BufferUsageFlagBits::eStorageBuffer |
+                                     vk::BufferUsageFlagBits::eTransferSrc |
+                                     vk::BufferUsageFlagBits::eTransferDst,
+                                     vk::MemoryPropertyFlagBits::eDeviceLocal);
+}
+
+void Vulkan::createSummedPixelColorFp64Buffer() {
+    const vk::DeviceSize pixelCount = settings.accumulationPrecision == ACCUMULATION_FP64
+                                      ? static_cast<vk::DeviceSize>(settings.windowWidth) * settings.windowHeight
+                                      : 1;
+
+    summedPixelColorFp64Buffer = createBuffer(3 * sizeof(double) * pixelCount,
+                                              vk::BufferUsageFlagBits::eStorageBuffer |
+                                              vk::BufferUsageFlagBits::eTransferSrc |
+                                              vk::BufferUsageFlagBits::eTransferDst,
+                                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    // THE TOTALS START AT ZERO LIKE THE SUMMED PIXEL COLOR IMAGES
+    executeSingleTimeCommand([&](const vk::CommandBuffer &singleTimeCommandBuffer) {
+        singleTimeCommandBuffer.fillBuffer(summedPixelColorFp64Buffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+        vk::MemoryBarrier fillBarrier = {
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        };
+
+        singleTimeCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                                vk::PipelineStageFlagBits::eRayTracingShaderKHR,
+                                                {}, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+    });
 }
 
 vk::AabbPositionsKHR Vulkan::getAABBFromSphere(const glm::vec4 &geometry) {
@@ -1185,15 +3688,128 @@ vk::AabbPositionsKHR Vulkan::getAABBFromSphere(const glm::vec4 &geometry) {
     };
 }
 
-void Vulkan::createRenderCallInfoBuffer() {
-    renderCallInfoBuffer = createBuffer(sizeof(RenderCallInfo), vk::BufferUsageFlagBits::eUniformBuffer,
-                                        vk::MemoryPropertyFlagBits::eHostVisible |
-                                        vk::MemoryPropertyFlagBits::eHostCoherent |
-                                        vk::MemoryPropertyFlagBits::eDeviceLocal);
+void Vulkan::createReadbackBuffers() {
+    const vk::DeviceSize pixelCount = static_cast<vk::DeviceSize>(settings.windowWidth) * settings.windowHeight;
+
+    // THE PREVIEW IS RESOLVED ON THE HOST, ONLY THE SUMS ARE READ BACK. THE RGB32F FORMAT AS ONE PLANE PER CHANNEL
+    const vk::DeviceSize channelCount = isCompactAccumulation() ? 3 : 4;
+
+    summedPixelColorReadbackBuffer = createBuffer(pixelCount * channelCount * sizeof(float),
+                                                  vk::BufferUsageFlagBits::eTransferDst,
+                                                  vk::MemoryPropertyFlagBits::eHostVisible |
+                                                  vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    // FP64 ACCUMULATION ALSO READS BACK THE DOUBLE TOTAL, THE REFERENCE OF THE ACCUMULATION PRECISION BENCHMARK
+    if (settings.accumulationPrecision == ACCUMULATION_FP64) {
+        summedPixelColorFp64ReadbackBuffer = createBuffer(pixelCount * 3 * sizeof(double),
+                                                          vk::BufferUsageFlagBits::eTransferDst,
+                                                          vk::MemoryPropertyFlagBits::eHostVisible |
+                                                          vk::MemoryPropertyFlagBits::eHostCoherent);
+    }
+}
+
+void Vulkan::createReadbackCommandBuffer() {
+    readbackCommandBuffer = device.allocateCommandBuffers(
+            {
+                    .commandPool = commandPool,
+                    .level = vk::CommandBufferLevel::ePrimary,
+                    .commandBufferCount = 1
+            }).front();
+
+    vk::CommandBufferBeginInfo beginInfo = {};
+    readbackCommandBuffer.begin(&beginInfo);
+
+    // WAIT FOR THE SHADER WRITES OF THE PREVIOUS RENDER CALLS (BOTH IMAGES STAY IN GENERAL)
+    vk::MemoryBarrier barrierToTransfer = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead
+    };
+
+    readbackCommandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eRayTracingShaderKHR | vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer, {}, 1, &barrierToTransfer, 0, nullptr, 0, nullptr);
+
+
+    // COPY THE SUMS TO THE HOST VISIBLE READBACK BUFFER
+    vk::BufferImageCopy bufferImageCopy = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .mipLevel = 0,
+                    .baseArrayLayer = 0,
+                    .layerCount = isCompactAccumulation() ? 3u : 1u
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {.width = settings.windowWidth, .height = settings.windowHeight, .depth = 1}
+    };
+
+    readbackCommandBuffer.copyImageToBuffer(
+            isCompactAccumulation() ? summedPixelColorPlanes.image : summedPixelColorImage.image,
+            vk::ImageLayout::eGeneral, summedPixelColorReadbackBuffer.buffer, 1, &bufferImageCopy);
+
+    if (summedPixelColorFp64ReadbackBuffer.buffer) {
+        vk::BufferCopy fp64Copy = {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = static_cast<vk::DeviceSize>(settings.windowWidth) * settings.windowHeight * 3 * sizeof(double)
+        };
+
+        readbackCommandBuffer.copyBuffer(summedPixelColorFp64Buffer.buffer, summedPixelColorFp64ReadbackBuffer.buffer,
+                                         1, &fp64Copy);
+    }
+
+
+    // MAKE THE COPY VISIBLE TO THE HOST & KEEP LATER RENDER CALLS FROM OVERWRITING THE SUMS TOO EARLY
+    vk::MemoryBarrier barrierToHost = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead
+    };
+
+    readbackCommandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eRayTracingShaderKHR | vk::PipelineStageFlagBits::eHost,
+            {}, 1, &barrierToHost, 0, nullptr, 0, nullptr);
+
+    readbackCommandBuffer.end();
 }
 
-void Vulkan::updateRenderCallInfoBuffer(const RenderCallInfo &renderCallInfo) {
-    void* data = device.mapMemory(renderCallInfoBuffer.memory, 0, sizeof(RenderCallInfo));
-    memcpy(data, &renderCallInfo, sizeof(RenderCallInfo));
-    device.unmapMemory(renderCallInfoBuffer.memory);
+RenderOutput Vulkan::collectReadback() {
+    const size_t pixelCount = static_cast<size_t>(settings.windowWidth) * settings.windowHeight;
+
+    RenderOutput output = {
+            .width = settings.windowWidth,
+            .height = settings.windowHeight,
+            .sampleCount = readbackRenderCallInfo.number * readbackRenderCallInfo.samplesPerRenderCall,
+            .summedPixelColor = std::vector<float>(pixelCount * 4)
+    };
+
+    const void* summedPixelColorData = summedPixelColorReadbackBuffer.allocation.mappedData;
+
+    if (isCompactAccumulation()) {
+        // PLANES -> RGBA, ALL PIXELS HAVE THE SAMPLES OF THE RENDER CALLS BEFORE THE READBACK
+        const auto* planes = static_cast<const float*>(summedPixelColorData);
+
+        for (size_t pixel = 0; pixel < pixelCount; pixel++) {
+            for (size_t channel = 0; channel < 3; channel++) {
+                output.summedPixelColor[pixel * 4 + channel] = planes[channel * pixelCount + pixel];
+            }
+
+            output.summedPixelColor[pixel * 4 + 3] = float(readbackAccumulatedSamples);
+        }
+    } else {
+        memcpy(output.summedPixelColor.data(), summedPixelColorData, output.summedPixelColor.size() * sizeof(float));
+    }
+
+    if (summedPixelColorFp64ReadbackBuffer.buffer) {
+        output.summedPixelColorFp64.resize(pixelCount * 3);
+        memcpy(output.summedPixelColorFp64.data(), summedPixelColorFp64ReadbackBuffer.allocation.mappedData,
+               output.summedPixelColorFp64.size() * sizeof(double));
+    }
+
+    output.renderTarget = resolveRenderTarget(output.summedPixelColor, settings.toneMapOperator);
+
+    readbackPending = false;
+    return output;
 }
@@ -6,50 +6,157 @@
 
 #include <vulkan/vulkan.hpp>
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include "vulkan_settings.h"
+#include "vulkan_memory_allocator.h"
+#include "vulkan_staging_ring.h"
 #include "scene.h"
+#include "scene_partition.h"
 #include "render_call_info.h"
+#include "render_output.h"
+#include "tile_scheduler.h"
+#include "renderer.h"
 
 struct VulkanImage {
     vk::Image image;
-    vk::DeviceMemory memory;
+    VulkanAllocation allocation;
     vk::ImageView imageView;
 };
 
 struct VulkanBuffer {
     vk::Buffer buffer;
-    vk::DeviceMemory memory;
+    VulkanAllocation allocation;
 };
 
-struct VulkanAccelerationStructure {
-    vk::AccelerationStructureKHR accelerationStructure;
+// QUERIES OF THE TIMESTAMP QUERY POOL OF EVERY FRAME, TIMESTAMP_COPY_END (AFTER THE RESOLVE & THE COPY TO THE SWAP
+// CHAIN) IS ONLY WRITTEN WHEN PRESENTING
+enum TimestampQuery {
+    TIMESTAMP_BEGIN = 0,
+    TIMESTAMP_BARRIERS_END = 1,
+    TIMESTAMP_TRACE_RAYS_END = 2,
+    TIMESTAMP_COPY_END = 3,
+    TIMESTAMP_QUERY_COUNT = 4
+};
+
+struct FrameInFlight {
+    vk::CommandBuffer commandBuffer;
+    vk::Semaphore imageAvailableSemaphore;
+    uint64_t timelineValue = 0;
+    bool completed = true;
+
+    vk::QueryPool timestampQueryPool;
+    uint32_t timestampCount = 0;
+    VulkanBuffer counterReadbackBuffer; // 64 BIT RAY COUNT, THEN THE ACTIVE PIXEL COUNT OF A RENDER CALL'S FIRST TILE
+
+    TileProgress tileProgress;
+    uint32_t samplesPerRenderCall;
+    uint32_t activePixelOffset = 0;
+    std::chrono::steady_clock::time_point submitTime;
+};
+
+// PUSH CONSTANTS OF select_active_pixels.comp
+struct ActivePixelSelectionPushConstants {
+    float threshold;
+    uint32_t minSamples;
+};
+
+// PUSH CONSTANTS OF resolve.comp
+struct ResolvePushConstants {
+    uint32_t sampleCount;
+};
+
+// WRITTEN IN FRONT OF THE DRIVER'S PIPELINE CACHE DATA. A CACHE OF ANOTHER DEVICE OR DRIVER VERSION, OR A CORRUPT ONE,
+// IS DISCARDED INSTEAD OF BEING HANDED TO THE DRIVER
+struct PipelineCacheFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t dataSize;
+    uint64_t dataChecksum;
+};
+
+// WRITTEN IN FRONT OF THE DRIVER'S SERIALIZED BLASES. THE DRIVER CHECKS ITS OWN COMPATIBILITY, THIS HEADER REJECTS A
+// CACHE OF ANOTHER SCENE OR DEVICE BEFORE ANYTHING IS UPLOADED
+struct AccelerationStructureCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sphereAmount;
+    uint32_t accelerationStructureCount;
+    uint64_t sceneHash;
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    uint64_t uncompactedSize;
+    uint64_t serializedSize;
+};
+
+// REQUIRED ALIGNMENT OF ACCELERATION STRUCTURE OFFSETS & OF SERIALIZED ACCELERATION STRUCTURE ADDRESSES
+const vk::DeviceSize ACCELERATION_STRUCTURE_ALIGNMENT = 256;
+
+// HOST VISIBLE MEMORY THROUGH WHICH EVERY UPLOAD INTO DEVICE LOCAL BUFFERS GOES
+const vk::DeviceSize STAGING_RING_SIZE = 32ull * 1024 * 1024;
+
+// ACCELERATION STRUCTURES OF ONE LEVEL, SUBALLOCATED FROM ONE BUFFER
+struct VulkanAccelerationStructures {
+    std::vector<vk::AccelerationStructureKHR> accelerationStructures;
     VulkanBuffer structureBuffer;
-    VulkanBuffer scratchBuffer;
-    VulkanBuffer instancesBuffer;
+    std::vector<vk::DeviceSize> updateScratchSizes; // ONLY SET FOR STRUCTURES THAT ALLOW UPDATES
 };
 
 
-class Vulkan {
+class Vulkan : public Renderer {
 public:
-    Vulkan(VulkanSettings settings, Scene scene);
+    Vulkan(VulkanSettings settings, const Scene &scene);
 
     ~Vulkan();
 
-    void update();
+    void update() override;
+
+    void render(const RenderCallInfo &renderCallInfo) override;
+
+    void finish() override;
+
+    void updateScene(std::span<const SceneUpdate> updates) override;
+
+    void setTileCompletedCallback(std::function<void(const TileProgress &)> callback) override;
+
+    [[nodiscard]] uint32_t getTileSize() const override;
 
-    void render(const RenderCallInfo &renderCallInfo);
+    [[nodiscard]] bool shouldExit() const override;
 
-    [[nodiscard]] bool shouldExit() const;
+    void requestReadback() override;
+
+    [[nodiscard]] bool isReadbackPending() const override;
+
+    [[nodiscard]] std::optional<RenderOutput> pollReadback() override;
+
+    [[nodiscard]] RenderOutput waitForReadback() override;
+
+    void setRenderCallProfiledCallback(std::function<void(const RenderCallProfile &)> callback) override;
+
+    [[nodiscard]] RendererInfo getRendererInfo() const override;
 
 
 private:
     VulkanSettings settings;
-    Scene scene;
-    std::vector<vk::AabbPositionsKHR> aabbs;
+    TileScheduler tileScheduler;
+    uint32_t sphereAmount = 0;
+    ScenePartition scenePartition;
+    std::vector<uint32_t> hitGroupMaterialVariants; // MATERIAL VARIANT OF EVERY HIT GROUP, IN SBT ORDER
+    std::vector<uint32_t> sphereLocations; // UPLOADED INDEX OF EVERY SCENE SPHERE, EMPTY IF UPLOADED IN SCENE ORDER
+    std::vector<glm::vec4> sphereGeometries; // HOST COPY OF THE UPLOADED GEOMETRY, ONLY KEPT FOR DYNAMIC SCENES
 
     const vk::Format swapChainImageFormat = vk::Format::eR8G8B8A8Unorm;
     const vk::Format summedPixelColorImageFormat = vk::Format::eR32G32B32A32Sfloat;
+    const vk::Format summedSquaredLuminanceImageFormat = vk::Format::eR32Sfloat;
+    const vk::Format summedPixelColorErrorImageFormat = vk::Format::eR32G32B32A32Sfloat;
+    const vk::Format summedPixelColorPlaneFormat = vk::Format::eR32Sfloat;
     const vk::ColorSpaceKHR colorSpace = vk::ColorSpaceKHR::eSrgbNonlinear;
     const vk::PresentModeKHR presentMode = vk::PresentModeKHR::eImmediate;
 
@@ -59,7 +166,6 @@ private:
     };
 
     const std::vector<const char*> requiredDeviceExtensions = {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
             VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
             VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
             VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,
@@ -70,6 +176,10 @@ private:
             VK_KHR_MAINTENANCE3_EXTENSION_NAME
     };
 
+    const std::vector<const char*> presentationDeviceExtensions = {
+            VK_KHR_SWAPCHAIN_EXTENSION_NAME
+    };
+
 
     GLFWwindow* window;
     vk::Instance instance;
@@ -95,24 +205,110 @@ private:
     vk::PipelineLayout rtPipelineLayout;
     vk::Pipeline rtPipeline;
 
-    std::vector<vk::CommandBuffer> commandBuffers;
-
-    vk::Fence fence;
-    std::list<vk::Semaphore> semaphores;
-
+    // ADAPTIVE SAMPLING: SELECTS THE PIXELS THE RENDER CALL SAMPLES, ONLY CREATED IF IT IS ENABLED
+    vk::DescriptorSetLayout activePixelDescriptorSetLayout;
+    vk::DescriptorPool activePixelDescriptorPool;
+    vk::DescriptorSet activePixelDescriptorSet;
+    vk::PipelineLayout activePixelPipelineLayout;
+    vk::Pipeline activePixelPipeline;
+
+    // RESOLVES THE SUMS TO THE RENDER TARGET WHEN A PRESENT IS DUE, ONLY CREATED WITH A WINDOW
+    vk::DescriptorSetLayout resolveDescriptorSetLayout;
+    vk::DescriptorPool resolveDescriptorPool;
+    vk::DescriptorSet resolveDescriptorSet;
+    vk::PipelineLayout resolvePipelineLayout;
+    vk::Pipeline resolvePipeline;
+    uint32_t renderCallsSincePresent = 0;
+    std::chrono::steady_clock::time_point lastPresentTime;
+
+    vk::PipelineCache pipelineCache;
+    std::vector<uint8_t> loadedPipelineCacheData;
+
+    std::vector<FrameInFlight> framesInFlight;
+    uint32_t currentFrameIndex = 0;
+    std::vector<vk::Semaphore> renderFinishedSemaphores;
+
+    vk::Semaphore timelineSemaphore;
+    uint64_t timelineValue = 0;
+
+    std::function<void(const TileProgress &)> tileCompletedCallback;
+    std::chrono::steady_clock::time_point lastTileCompletionTime;
+
+    bool timestampsSupported = false;
+    double timestampPeriod = 1.0;
+    uint64_t timestampMask = UINT64_MAX;
+    VulkanBuffer rayCounterBuffer;
+
+    RenderCallProfile renderCallProfile = {};
+    std::function<void(const RenderCallProfile &)> renderCallProfiledCallback;
+
+    // STAGES ON THE PIPELINE THREAD ARE RECORDED CONCURRENTLY, SO THE TIMINGS ARE IN ORDER OF COMPLETION
+    std::vector<StartupStageTiming> startupTimings;
+    std::mutex startupTimingsMutex;
+    std::unique_ptr<VulkanMemoryAllocator> memoryAllocator; // BUILD-ONLY BUFFERS ARE FREED RIGHT AFTER THEIR BUILD
+    bool memoryBudgetSupported = false;
+
+    // HOST SCENES, INSTANCES, THE SBT & SCENE UPDATES ARE UPLOADED THROUGH IT INTO DEVICE LOCAL BUFFERS
+    std::unique_ptr<VulkanStagingRing> stagingRing;
+    uint64_t sceneUploadBytes = 0;
+    double sceneUploadMilliseconds = 0.0;
+    uint64_t accelerationStructureMemory = 0;
+    uint64_t uncompactedAccelerationStructureMemory = 0;
+    bool bottomAccelerationStructuresFromCache = false;
+
+    // THE IMAGES A FORMAT, PRECISION OR SAMPLING MODE DOES NOT USE STAY BOUND AS A SINGLE PIXEL. THE RENDER TARGET IS
+    // ONLY WRITTEN BY THE RESOLVE WITH A WINDOW
     VulkanImage renderTargetImage;
     VulkanImage summedPixelColorImage;
+    VulkanImage summedSquaredLuminanceImage;
+
+    // RGB32F ACCUMULATION FORMAT: AN R32F LAYER PER CHANNEL OF THE SUMMED PIXEL COLORS, BOUND TO BINDING 9
+    VulkanImage summedPixelColorPlanes;
+
+    // SAMPLES OF EVERY PIXEL SO FAR, THE SAMPLE COUNT OF THE RGB32F ACCUMULATION FORMAT
+    uint32_t accumulatedSamples = 0;
+
+    // KAHAN COMPENSATION OR LO PART OF THE SPLIT SUM OF THE SUMMED PIXEL COLORS. ALWAYS BOUND TO BINDING 7, A SINGLE
+    // PIXEL FOR THE OTHER ACCUMULATION PRECISIONS
+    VulkanImage summedPixelColorErrorImage;
+
+    // FP64 ACCUMULATION: THE DOUBLE TOTAL OF THE SUMMED PIXEL COLORS, RGB PER PIXEL. ALWAYS BOUND TO BINDING 8, A SINGLE
+    // PIXEL FOR THE OTHER ACCUMULATION PRECISIONS
+    VulkanBuffer summedPixelColorFp64Buffer;
+
+    // THE COUNT, THEN THE PIXELS THE CURRENT RENDER CALL SAMPLES. ALWAYS BOUND TO BINDING 6, ONLY HOLDS THE COUNT
+    // WITHOUT ADAPTIVE SAMPLING
+    VulkanBuffer activePixelBuffer;
 
     VulkanBuffer aabbBuffer;
 
-    VulkanAccelerationStructure bottomAccelerationStructure;
-    VulkanAccelerationStructure topAccelerationStructure;
+    VulkanAccelerationStructures bottomAccelerationStructures;
+    VulkanAccelerationStructures topAccelerationStructure;
+    VulkanBuffer instancesBuffer;
+    VulkanBuffer updateScratchBuffer;
+    std::vector<vk::DeviceSize> updateScratchOffsets; // THE BLASES, THEN THE TLAS
 
     VulkanBuffer shaderBindingTableBuffer;
     vk::StridedDeviceAddressRegionKHR sbtRayGenAddressRegion, sbtHitAddressRegion, sbtMissAddressRegion;
 
     VulkanBuffer sphereBuffer;
-    VulkanBuffer renderCallInfoBuffer;
+
+    RenderCallInfo lastRenderCallInfo = {};
+    RenderCallInfo readbackRenderCallInfo = {};
+    uint32_t readbackAccumulatedSamples = 0;
+    bool readbackPending = false;
+    uint64_t readbackTimelineValue = 0;
+
+    vk::CommandBuffer readbackCommandBuffer;
+    VulkanBuffer summedPixelColorReadbackBuffer;
+    VulkanBuffer summedPixelColorFp64ReadbackBuffer; // FP64 ACCUMULATION ONLY
+
+    // RETURNS THE DURATION OF THE STAGE
+    double measureStartupStage(const std::string &stage, const std::function<void()> &function);
+
+    void recordStartupStage(const std::string &stage, double milliseconds);
+
+    [[nodiscard]] std::vector<const char*> getDeviceExtensions() const;
 
     void createWindow();
 
@@ -130,7 +326,8 @@ private:
 
     void createSwapChain();
 
-    [[nodiscard]] vk::ImageView createImageView(const vk::Image &image, const vk::Format &format) const;
+    [[nodiscard]] vk::ImageView createImageView(const vk::Image &image, const vk::Format &format,
+                                                uint32_t layerCount = 1) const;
 
     void createDescriptorSetLayout();
 
@@ -142,55 +339,157 @@ private:
 
     void createRTPipeline();
 
+    void createActivePixelPipeline();
+
+    void createActivePixelDescriptorSet();
+
+    void createResolvePipeline();
+
+    void createResolveDescriptorSet();
+
+    [[nodiscard]] bool isAdaptiveSampling() const;
+
+    [[nodiscard]] bool hasAccumulationErrorImage() const;
+
+    [[nodiscard]] bool isCompactAccumulation() const;
+
+    [[nodiscard]] uint32_t getAccumulationBytesPerPixel() const;
+
+    // HOST THREADS OF A POOL JOIN THE OPERATION UNTIL IT IS COMPLETE
+    void joinDeferredOperation(vk::DeferredOperationKHR deferredOperation) const;
+
+    void loadPipelineCache();
+
+    void savePipelineCache() const;
+
+    [[nodiscard]] PipelineCacheFileHeader getPipelineCacheFileHeader() const;
+
+    [[nodiscard]] static uint64_t getChecksum(const void* data, size_t size);
+
     [[nodiscard]] static std::vector<char> readBinaryFile(const std::string &path);
 
-    void createCommandBuffer();
+    void createCommandBuffers();
 
-    void createFence();
+    void submitTile(const RenderCallInfo &renderCallInfo, const Tile &tile, uint32_t tileIndex, uint32_t tileCount,
+                    uint32_t activePixelOffset, bool present);
 
-    void createSemaphore();
+    void completeFrame(FrameInFlight &frame);
 
-    void createImages();
+    [[nodiscard]] bool isPresentDue() const;
+
+    void presentAccumulation();
+
+    void recordCommandBuffer(const FrameInFlight &frame, const RenderCallInfo &renderCallInfo,
+                             const Tile &tile, std::optional<uint32_t> swapChainImageIndex);
+
+    // FILLS THE ACTIVE PIXEL LIST FROM THE VARIANCE ESTIMATES & COPIES ITS COUNT TO THE FRAME'S READBACK BUFFER
+    void recordActivePixelSelection(const FrameInFlight &frame) const;
+
+    // RESOLVES THE SUMS OF sampleCount SAMPLES PER PIXEL WITH THE TONE MAPPING OPERATOR & COPIES THEM TO THE IMAGE
+    void recordPresent(const vk::CommandBuffer &commandBuffer, const vk::Image &swapChainImage,
+                       uint32_t sampleCount) const;
+
+    void createRayCounterBuffer();
+
+    void createActivePixelBuffer();
+
+    void createSummedPixelColorFp64Buffer();
+
+    void createQueryPools();
+
+    [[nodiscard]] RenderCallProfile getTileProfile(const FrameInFlight &frame) const;
+
+    void createSyncObjects();
 
-    [[nodiscard]] uint32_t findMemoryTypeIndex(const uint32_t &memoryTypeBits,
-                                               const vk::MemoryPropertyFlags &properties);
+    void waitForTimelineValue(uint64_t value) const;
+
+    void createImages();
 
     [[nodiscard]] vk::ImageMemoryBarrier getImagePipelineBarrier(
             const vk::AccessFlagBits &srcAccessFlags, const vk::AccessFlagBits &dstAccessFlags,
             const vk::ImageLayout &oldLayout, const vk::ImageLayout &newLayout, const vk::Image &image) const;
 
+    // WITHOUT AN EXTENT, THE IMAGE HAS THE SIZE OF THE WINDOW. MORE THAN ONE LAYER GET AN ARRAY VIEW
     [[nodiscard]] VulkanImage createImage(const vk::Format &format,
-                                          const vk::Flags<vk::ImageUsageFlagBits> &usageFlagBits);
+                                          const vk::Flags<vk::ImageUsageFlagBits> &usageFlagBits,
+                                          std::optional<vk::Extent2D> extent = std::nullopt,
+                                          uint32_t arrayLayers = 1);
 
-    void destroyImage(const VulkanImage &image) const;
+    void destroyImage(const VulkanImage &image);
 
     [[nodiscard]] VulkanBuffer createBuffer(const vk::DeviceSize &size, const vk::Flags<vk::BufferUsageFlagBits> &usage,
                                             const vk::Flags<vk::MemoryPropertyFlagBits> &memoryProperty);
 
-    void destroyBuffer(const VulkanBuffer &buffer) const;
+    void destroyBuffer(const VulkanBuffer &buffer);
 
     void executeSingleTimeCommand(const std::function<void(const vk::CommandBuffer &singleTimeCommandBuffer)> &c);
 
-    void createAABBBuffer();
+    void createAABBBuffer(const Scene &scene);
+
+    void createScenePartition(const Scene &scene);
 
-    void createBottomAccelerationStructure();
+    void createBottomAccelerationStructures(const Scene &scene);
 
     void createTopAccelerationStructure();
 
-    void destroyAccelerationStructure(const VulkanAccelerationStructure &accelerationStructure);
+    void createUpdateScratchBuffer();
+
+    [[nodiscard]] vk::AccelerationStructureGeometryKHR getSphereGeometry() const;
+
+    [[nodiscard]] vk::AccelerationStructureBuildRangeInfoKHR getClusterBuildRangeInfo(uint32_t cluster) const;
+
+    [[nodiscard]] vk::AccelerationStructureGeometryKHR getInstancesGeometry() const;
+
+    void refitAccelerationStructures(const std::vector<uint32_t> &clusters);
+
+    [[nodiscard]] VulkanAccelerationStructures createAccelerationStructures(vk::AccelerationStructureTypeKHR type,
+                                                                            const std::vector<vk::DeviceSize> &sizes);
+
+    [[nodiscard]] VulkanAccelerationStructures buildAccelerationStructures(
+            std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos,
+            const std::vector<vk::AccelerationStructureBuildRangeInfoKHR> &buildRangeInfos);
+
+    [[nodiscard]] std::vector<vk::DeviceSize> queryAccelerationStructureProperties(
+            const std::vector<vk::AccelerationStructureKHR> &accelerationStructures, vk::QueryType queryType);
+
+    [[nodiscard]] static std::vector<vk::DeviceSize> getAlignedOffsets(const std::vector<vk::DeviceSize> &sizes,
+                                                                       vk::DeviceSize alignment);
+
+    [[nodiscard]] vk::PhysicalDeviceAccelerationStructurePropertiesKHR getAccelerationStructureProperties() const;
+
+    [[nodiscard]] std::string getAccelerationStructureCachePath(uint64_t sceneHash) const;
+
+    [[nodiscard]] static uint64_t getSceneHash(const Scene &scene, bool splitMaterialVariants);
+
+    bool loadBottomAccelerationStructures(const std::string &path, uint64_t sceneHash);
+
+    void saveBottomAccelerationStructures(const std::string &path, uint64_t sceneHash);
+
+    [[nodiscard]] AccelerationStructureCacheHeader getAccelerationStructureCacheHeader() const;
+
+    void destroyAccelerationStructures(const VulkanAccelerationStructures &accelerationStructures);
 
     [[nodiscard]] vk::ShaderModule createShaderModule(const std::string &path) const;
 
     void createShaderBindingTable();
 
+    // SBT RECORD OF THE HIT GROUP FOR THE VARIANT, WHICH THE INSTANCES OF ITS CLUSTERS OFFSET INTO
+    [[nodiscard]] uint32_t getHitGroupIndex(uint32_t materialVariant) const;
+
     [[nodiscard]] vk::PhysicalDeviceRayTracingPipelinePropertiesKHR getRayTracingProperties() const;
 
-    void createSphereBuffer();
+    [[nodiscard]] vk::DeviceSize getSphereBufferSize() const;
+
+    void createSphereBuffer(const Scene &scene);
+
+    void generateSceneOnDevice(const SceneGenerationSettings &generationSettings);
 
     [[nodiscard]] static vk::AabbPositionsKHR getAABBFromSphere(const glm::vec4 &geometry);
 
-    void createRenderCallInfoBuffer();
+    void createReadbackBuffers();
+
+    void createReadbackCommandBuffer();
 
-    void updateRenderCallInfoBuffer(const RenderCallInfo &renderCallInfo);
+    [[nodiscard]] RenderOutput collectReadback();
 
 };
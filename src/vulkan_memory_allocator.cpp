@@ -0,0 +1,304 @@
+#include "vulkan_memory_allocator.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+// FIRST FIT: THE LOWEST FREE RANGE THAT HOLDS THE ALIGNED ALLOCATION. THE ALIGNMENT PADDING STAYS A FREE RANGE
+std::optional<vk::DeviceSize> VulkanMemoryBlock::allocate(vk::DeviceSize allocationSize, vk::DeviceSize alignment) {
+    for (auto range = freeRanges.begin(); range != freeRanges.end(); ++range) {
+        const vk::DeviceSize rangeOffset = range->first;
+        const vk::DeviceSize rangeEnd = range->first + range->second;
+        const vk::DeviceSize offset = (rangeOffset + alignment - 1) / alignment * alignment;
+
+        if (offset + allocationSize > rangeEnd) {
+            continue;
+        }
+
+        freeRanges.erase(range);
+
+        if (offset > rangeOffset) {
+            freeRanges[rangeOffset] = offset - rangeOffset;
+        }
+
+        if (offset + allocationSize < rangeEnd) {
+            freeRanges[offset + allocationSize] = rangeEnd - (offset + allocationSize);
+        }
+
+        allocatedBytes += allocationSize;
+        return offset;
+    }
+
+    return std::nullopt;
+}
+
+void VulkanMemoryBlock::free(vk::DeviceSize offset, vk::DeviceSize allocationSize) {
+    allocatedBytes -= allocationSize;
+
+    vk::DeviceSize end = offset + allocationSize;
+    auto next = freeRanges.lower_bound(offset);
+
+    if (next != freeRanges.end() && next->first == end) {
+        end += next->second;
+        next = freeRanges.erase(next);
+    }
+
+    if (next != freeRanges.begin()) {
+        const auto previous = std::prev(next);
+
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            freeRanges.erase(previous);
+        }
+    }
+
+    freeRanges[offset] = end - offset;
+}
+
+vk::DeviceSize VulkanMemoryBlock::getLargestFreeRange() const {
+    vk::DeviceSize largestFreeRange = 0;
+
+    for (const auto &[offset, rangeSize]: freeRanges) {
+        largestFreeRange = std::max(largestFreeRange, rangeSize);
+    }
+
+    return largestFreeRange;
+}
+
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(vk::PhysicalDevice physicalDevice, vk::Device device,
+                                             bool memoryBudgetSupported) :
+        physicalDevice(physicalDevice), device(device), memoryBudgetSupported(memoryBudgetSupported),
+        memoryProperties(physicalDevice.getMemoryProperties()) {
+
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; memoryTypeIndex++) {
+        const vk::DeviceSize heapSize =
+                memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+        const vk::DeviceSize blockSize = heapSize <= smallHeapSize ? heapSize / smallHeapBlockDivisor
+                                                                   : defaultBlockSize;
+
+        for (uint32_t kind = 0; kind < POOL_KIND_COUNT; kind++) {
+            pools.push_back({.memoryTypeIndex = memoryTypeIndex, .blockSize = blockSize, .blocks = {}});
+        }
+    }
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+    for (const Pool &pool: pools) {
+        for (const VulkanMemoryBlock &block: pool.blocks) {
+            if (block.memory) {
+                device.freeMemory(block.memory);
+            }
+        }
+    }
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocateBufferMemory(vk::Buffer buffer, vk::MemoryPropertyFlags properties) {
+    const auto memoryRequirements = device.getBufferMemoryRequirements2<vk::MemoryRequirements2,
+            vk::MemoryDedicatedRequirements>({.buffer = buffer});
+    const auto &dedicatedRequirements = memoryRequirements.get<vk::MemoryDedicatedRequirements>();
+
+    const VulkanAllocation allocation = allocate(
+            memoryRequirements.get<vk::MemoryRequirements2>().memoryRequirements,
+            dedicatedRequirements.requiresDedicatedAllocation || dedicatedRequirements.prefersDedicatedAllocation,
+            {.buffer = buffer}, properties, POOL_BUFFERS);
+
+    device.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+
+    return allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocateImageMemory(vk::Image image, vk::MemoryPropertyFlags properties) {
+    const auto memoryRequirements = device.getImageMemoryRequirements2<vk::MemoryRequirements2,
+            vk::MemoryDedicatedRequirements>({.image = image});
+    const auto &dedicatedRequirements = memoryRequirements.get<vk::MemoryDedicatedRequirements>();
+
+    const VulkanAllocation allocation = allocate(
+            memoryRequirements.get<vk::MemoryRequirements2>().memoryRequirements,
+            dedicatedRequirements.requiresDedicatedAllocation || dedicatedRequirements.prefersDedicatedAllocation,
+            {.image = image}, properties, POOL_IMAGES);
+
+    device.bindImageMemory(image, allocation.memory, allocation.offset);
+
+    return allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocate(const vk::MemoryRequirements &memoryRequirements, bool dedicated,
+                                                 const vk::MemoryDedicatedAllocateInfo &dedicatedAllocateInfo,
+                                                 vk::MemoryPropertyFlags properties, PoolKind kind) {
+
+    const uint32_t memoryTypeIndex = findMemoryTypeIndex(memoryRequirements.memoryTypeBits, properties);
+    const uint32_t poolIndex = memoryTypeIndex * POOL_KIND_COUNT + kind;
+    Pool &pool = pools[poolIndex];
+
+    // DEDICATED
+    if (dedicated || memoryRequirements.size > pool.blockSize / 2) {
+        const vk::DeviceMemory memory = allocateDeviceMemory(memoryRequirements.size, memoryTypeIndex,
+                                                             dedicated ? &dedicatedAllocateInfo : nullptr);
+
+        // ONLY COUNTED ONCE THE ALLOCATION SUCCEEDED, allocateDeviceMemory CAN THROW
+        allocatedBytes += memoryRequirements.size;
+        dedicatedBytes += memoryRequirements.size;
+        dedicatedAllocationCount++;
+
+        return {
+                .memory = memory,
+                .offset = 0,
+                .size = memoryRequirements.size,
+                .mappedData = mapIfHostVisible(memory, memoryTypeIndex),
+                .pool = poolIndex,
+                .block = DEDICATED_ALLOCATION
+        };
+    }
+
+    // FIRST BLOCK WITH A FITTING FREE RANGE, OTHERWISE A NEW BLOCK IN THE FIRST EMPTY SLOT
+    std::optional<vk::DeviceSize> offset;
+    uint32_t blockIndex = 0;
+
+    for (; blockIndex < pool.blocks.size(); blockIndex++) {
+        if (pool.blocks[blockIndex].memory &&
+            (offset = pool.blocks[blockIndex].allocate(memoryRequirements.size, memoryRequirements.alignment))) {
+            break;
+        }
+    }
+
+    if (!offset) {
+        blockIndex = static_cast<uint32_t>(std::find_if(pool.blocks.begin(), pool.blocks.end(),
+                                                        [](const VulkanMemoryBlock &block) {
+                                                            return !block.memory;
+                                                        }) - pool.blocks.begin());
+
+        if (blockIndex == pool.blocks.size()) {
+            pool.blocks.emplace_back();
+        }
+
+        VulkanMemoryBlock &block = pool.blocks[blockIndex];
+        block.memory = allocateDeviceMemory(pool.blockSize, memoryTypeIndex, nullptr);
+        block.size = pool.blockSize;
+        block.mappedData = mapIfHostVisible(block.memory, memoryTypeIndex);
+        block.allocatedBytes = 0;
+        block.freeRanges = {{0, pool.blockSize}};
+
+        offset = block.allocate(memoryRequirements.size, memoryRequirements.alignment);
+    }
+
+    const VulkanMemoryBlock &block = pool.blocks[blockIndex];
+    allocatedBytes += memoryRequirements.size;
+
+    return {
+            .memory = block.memory,
+            .offset = *offset,
+            .size = memoryRequirements.size,
+            .mappedData = block.mappedData ? static_cast<uint8_t*>(block.mappedData) + *offset : nullptr,
+            .pool = poolIndex,
+            .block = blockIndex
+    };
+}
+
+// AN EMPTY BLOCK IS RELEASED, UNLESS IT IS THE LAST ONE OF ITS POOL: BUILD-ONLY BUFFERS COME & GO REPEATEDLY
+void VulkanMemoryAllocator::free(const VulkanAllocation &allocation) {
+    allocatedBytes -= allocation.size;
+
+    if (allocation.block == DEDICATED_ALLOCATION) {
+        device.freeMemory(allocation.memory);
+
+        dedicatedBytes -= allocation.size;
+        dedicatedAllocationCount--;
+        return;
+    }
+
+    Pool &pool = pools[allocation.pool];
+    VulkanMemoryBlock &block = pool.blocks[allocation.block];
+    block.free(allocation.offset, allocation.size);
+
+    const auto liveBlockCount = std::count_if(pool.blocks.begin(), pool.blocks.end(),
+                                              [](const VulkanMemoryBlock &b) { return b.memory; });
+
+    if (block.allocatedBytes == 0 && liveBlockCount > 1) {
+        device.freeMemory(block.memory);
+        block = {};
+    }
+}
+
+VulkanMemoryStatistics VulkanMemoryAllocator::getStatistics() const {
+    VulkanMemoryStatistics statistics = {
+            .allocatedBytes = allocatedBytes,
+            .reservedBytes = dedicatedBytes,
+            .blockCount = 0,
+            .dedicatedAllocationCount = dedicatedAllocationCount
+    };
+
+    vk::DeviceSize freeBytes = 0, largestFreeRanges = 0;
+
+    for (const Pool &pool: pools) {
+        for (const VulkanMemoryBlock &block: pool.blocks) {
+            if (!block.memory) {
+                continue;
+            }
+
+            statistics.reservedBytes += block.size;
+            statistics.blockCount++;
+
+            freeBytes += block.size - block.allocatedBytes;
+            largestFreeRanges += block.getLargestFreeRange();
+        }
+    }
+
+    statistics.fragmentation = freeBytes > 0 ? 1.0 - double(largestFreeRanges) / double(freeBytes) : 0.0;
+
+    if (memoryBudgetSupported) {
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {};
+
+        vk::PhysicalDeviceMemoryProperties2 memoryProperties2 = {
+                .pNext = &memoryBudgetProperties
+        };
+
+        physicalDevice.getMemoryProperties2(&memoryProperties2);
+
+        for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++) {
+            if (memoryProperties.memoryHeaps[heap].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+                statistics.deviceLocalUsage += memoryBudgetProperties.heapUsage[heap];
+                statistics.deviceLocalBudget += memoryBudgetProperties.heapBudget[heap];
+            }
+        }
+    }
+
+    return statistics;
+}
+
+// EVERY ALLOCATION MAY BACK A BUFFER WHOSE DEVICE ADDRESS IS TAKEN
+vk::DeviceMemory VulkanMemoryAllocator::allocateDeviceMemory(
+        vk::DeviceSize size, uint32_t memoryTypeIndex, const vk::MemoryDedicatedAllocateInfo* dedicatedAllocateInfo) {
+
+    vk::MemoryAllocateFlagsInfo allocateFlagsInfo = {
+            .pNext = dedicatedAllocateInfo,
+            .flags = vk::MemoryAllocateFlagBits::eDeviceAddress
+    };
+
+    vk::MemoryAllocateInfo allocateInfo = {
+            .pNext = &allocateFlagsInfo,
+            .allocationSize = size,
+            .memoryTypeIndex = memoryTypeIndex
+    };
+
+    return device.allocateMemory(allocateInfo);
+}
+
+// HOST VISIBLE MEMORY IS MAPPED ONCE, A DEVICE MEMORY OBJECT CANNOT BE MAPPED TWICE BY THE RESOURCES THAT SHARE IT
+void* VulkanMemoryAllocator::mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryTypeIndex) const {
+    if (!(memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)) {
+        return nullptr;
+    }
+
+    return device.mapMemory(memory, 0, VK_WHOLE_SIZE);
+}
+
+uint32_t VulkanMemoryAllocator::findMemoryTypeIndex(uint32_t memoryTypeBits,
+                                                    vk::MemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((memoryTypeBits & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Unable to find suitable memory type!");
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+// MARKS AN ALLOCATION THAT OWNS ITS DEVICE MEMORY INSTEAD OF BEING A RANGE OF A BLOCK
+const uint32_t DEDICATED_ALLOCATION = UINT32_MAX;
+
+// A RANGE OF A DEVICE MEMORY BLOCK, OR A DEDICATED DEVICE MEMORY OBJECT. mappedData POINTS TO THE RANGE IF THE MEMORY IS
+// HOST VISIBLE, WHICH STAYS MAPPED FOR THE LIFETIME OF ITS BLOCK
+struct VulkanAllocation {
+    vk::DeviceMemory memory;
+    vk::DeviceSize offset = 0;
+    vk::DeviceSize size = 0;
+    void* mappedData = nullptr;
+
+    uint32_t pool = 0;
+    uint32_t block = DEDICATED_ALLOCATION;
+};
+
+struct VulkanMemoryStatistics {
+    uint64_t allocatedBytes = 0; // LIVE ALLOCATIONS
+    uint64_t reservedBytes = 0; // DEVICE MEMORY OF ALL BLOCKS & DEDICATED ALLOCATIONS
+    uint32_t blockCount = 0;
+    uint32_t dedicatedAllocationCount = 0;
+
+    // SHARE OF THE FREE BLOCK MEMORY OUTSIDE THE LARGEST FREE RANGE OF EACH BLOCK, 0 IF IT IS ALL CONTIGUOUS
+    double fragmentation = 0.0;
+
+    // USAGE OF THE DEVICE LOCAL HEAPS BY THE WHOLE PROCESS & THE BUDGET THE DRIVER GRANTS IT, 0 WITHOUT
+    // VK_EXT_memory_budget
+    uint64_t deviceLocalUsage = 0;
+    uint64_t deviceLocalBudget = 0;
+};
+
+// ONE DEVICE MEMORY OBJECT, HANDED OUT IN ALIGNED RANGES. FREE RANGES ARE KEPT BY OFFSET & MERGED WITH THEIR NEIGHBORS
+struct VulkanMemoryBlock {
+    vk::DeviceMemory memory;
+    vk::DeviceSize size = 0;
+    void* mappedData = nullptr;
+
+    vk::DeviceSize allocatedBytes = 0;
+    std::map<vk::DeviceSize, vk::DeviceSize> freeRanges;
+
+    [[nodiscard]] std::optional<vk::DeviceSize> allocate(vk::DeviceSize allocationSize, vk::DeviceSize alignment);
+
+    void free(vk::DeviceSize offset, vk::DeviceSize allocationSize);
+
+    [[nodiscard]] vk::DeviceSize getLargestFreeRange() const;
+};
+
+// SUBALLOCATES BUFFERS & IMAGES FROM LARGE BLOCKS PER MEMORY TYPE, SO THE NUMBER OF DEVICE MEMORY OBJECTS STAYS FAR
+// BELOW maxMemoryAllocationCount. BUFFERS & OPTIMALLY TILED IMAGES USE SEPARATE POOLS, SO bufferImageGranularity NEVER
+// APPLIES WITHIN A BLOCK. RESOURCES THE DRIVER WANTS IN MEMORY OF THEIR OWN, OR THAT TAKE MORE THAN HALF A BLOCK, GET A
+// DEDICATED ALLOCATION
+class VulkanMemoryAllocator {
+public:
+    VulkanMemoryAllocator(vk::PhysicalDevice physicalDevice, vk::Device device, bool memoryBudgetSupported);
+
+    ~VulkanMemoryAllocator();
+
+    VulkanMemoryAllocator(const VulkanMemoryAllocator &) = delete;
+
+    VulkanMemoryAllocator &operator=(const VulkanMemoryAllocator &) = delete;
+
+    // ALLOCATES & BINDS THE MEMORY OF THE RESOURCE
+    [[nodiscard]] VulkanAllocation allocateBufferMemory(vk::Buffer buffer, vk::MemoryPropertyFlags properties);
+
+    [[nodiscard]] VulkanAllocation allocateImageMemory(vk::Image image, vk::MemoryPropertyFlags properties);
+
+    void free(const VulkanAllocation &allocation);
+
+    [[nodiscard]] VulkanMemoryStatistics getStatistics() const;
+
+private:
+    const vk::DeviceSize defaultBlockSize = 64ull * 1024 * 1024;
+
+    // SMALL HEAPS (E.G. THE HOST VISIBLE PART OF DEVICE LOCAL MEMORY WITHOUT RESIZABLE BAR) GET SMALLER BLOCKS
+    const vk::DeviceSize smallHeapSize = 1024ull * 1024 * 1024;
+    const uint32_t smallHeapBlockDivisor = 8;
+
+    enum PoolKind {
+        POOL_BUFFERS = 0,
+        POOL_IMAGES = 1,
+        POOL_KIND_COUNT = 2
+    };
+
+    // ONE POOL PER MEMORY TYPE & KIND. FREED BLOCKS LEAVE AN EMPTY SLOT, SO BLOCK INDICES OF LIVE ALLOCATIONS STAY VALID
+    struct Pool {
+        uint32_t memoryTypeIndex;
+        vk::DeviceSize blockSize;
+        std::vector<VulkanMemoryBlock> blocks;
+    };
+
+    vk::PhysicalDevice physicalDevice;
+    vk::Device device;
+    bool memoryBudgetSupported;
+    vk::PhysicalDeviceMemoryProperties memoryProperties;
+
+    std::vector<Pool> pools;
+    uint64_t allocatedBytes = 0;
+    uint64_t dedicatedBytes = 0;
+    uint32_t dedicatedAllocationCount = 0;
+
+    [[nodiscard]] VulkanAllocation allocate(const vk::MemoryRequirements &memoryRequirements, bool dedicated,
+                                            const vk::MemoryDedicatedAllocateInfo &dedicatedAllocateInfo,
+                                            vk::MemoryPropertyFlags properties, PoolKind kind);
+
+    [[nodiscard]] vk::DeviceMemory allocateDeviceMemory(vk::DeviceSize size, uint32_t memoryTypeIndex,
+                                                        const vk::MemoryDedicatedAllocateInfo* dedicatedAllocateInfo);
+
+    [[nodiscard]] void* mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryTypeIndex) const;
+
+    [[nodiscard]] uint32_t findMemoryTypeIndex(uint32_t memoryTypeBits, vk::MemoryPropertyFlags properties) const;
+};
@@ -1,7 +1,58 @@
 #pragma once
 
 #include <string>
+#include "accumulation_format.h"
+#include "accumulation_precision.h"
+#include "sampler_type.h"
+#include "tone_map_operator.h"
 
 struct VulkanSettings {
     uint32_t windowWidth, windowHeight;
+    bool headless = false;
+    uint32_t framesInFlight = 2;
+    uint32_t tileSize = 512;
+    float targetSubmitMilliseconds = 100.0f;
+    bool countRays = false;
+    uint32_t maxDepth = 50;
+
+    // BOUNCES AFTER WHICH PATHS ARE TERMINATED BY RUSSIAN ROULETTE ON THEIR THROUGHPUT, 0 TO ONLY STOP AT maxDepth
+    uint32_t rouletteDepth = 0;
+
+    // ADAPTIVE SAMPLING: A RENDER CALL ONLY SAMPLES PIXELS WITH FEWER THAN adaptiveMinSamples SAMPLES OR WHOSE STANDARD
+    // ERROR OF THE MEAN LUMINANCE IS ABOVE adaptiveThreshold TIMES THE MEAN. 0 SAMPLES EVERY PIXEL IN EVERY RENDER CALL
+    float adaptiveThreshold = 0.0f;
+    uint32_t adaptiveMinSamples = 16;
+
+    // SOURCE OF THE RANDOM NUMBERS OF THE PATHS. EXCEPT FOR SAMPLER_RANDOM, A SAMPLE ONLY DEPENDS ON ITS INDEX IN THE PIXEL,
+    // NOT ON HOW THE SAMPLES ARE SPLIT INTO RENDER CALLS
+    SamplerType sampler = SAMPLER_RANDOM;
+
+    // PRECISION OF ADDING A RENDER CALL TO THE SUMMED PIXEL COLORS, FIXED WHEN THE PIPELINE IS BUILT. KAHAN & SPLIT KEEP
+    // A SECOND FULL RESOLUTION IMAGE, FP64 NEEDS A DEVICE WITH shaderFloat64
+    AccumulationPrecision accumulationPrecision = ACCUMULATION_FP32;
+
+    // RGB32F DROPS THE SAMPLE COUNT OF EVERY PIXEL, SO IT CANNOT BE COMBINED WITH ADAPTIVE SAMPLING
+    AccumulationFormat accumulationFormat = ACCUMULATION_FORMAT_RGBA32F;
+
+    // THE WINDOW SHOWS THE SUMS RESOLVED WITH THE TONE MAPPING OPERATOR EVERY presentInterval RENDER CALLS, BUT AT MOST
+    // presentRate TIMES PER SECOND (0 FOR NO LIMIT), AND ONCE RENDERING IS FINISHED. THE OTHER SUBMITS ONLY TRACE.
+    // READBACKS RESOLVE THEIR RENDER TARGET WITH THE SAME OPERATOR
+    ToneMapOperator toneMapOperator = TONE_MAP_CLAMP;
+    uint32_t presentInterval = 1;
+    float presentRate = 0.0f;
+
+    // LOADED AT STARTUP & SAVED ON EXIT, EMPTY TO COMPILE THE PIPELINES FROM SCRATCH ON EVERY START
+    std::string pipelineCachePath;
+
+    // DIRECTORY OF SERIALIZED BLAS PER SCENE & DEVICE, EMPTY TO BUILD THE BLAS ON EVERY START
+    std::string accelerationStructureCacheDirectory;
+
+    // KEEPS THE SCENE UPDATABLE: EVERY SPHERE IS UPLOADED (NO INSTANCING), THE ACCELERATION STRUCTURES ARE BUILT FOR
+    // REFITS INSTEAD OF BEING COMPACTED & NOT CACHED, AND A HOST COPY OF THE GEOMETRY IS KEPT TO FIND MOVED SPHERES
+    bool dynamicScene = false;
+
+    // ONE HIT GROUP PER MATERIAL VARIANT IN THE SCENE, SPECIALIZED SO IT DOES NOT BRANCH ON THE MATERIAL. THE CLUSTERS
+    // ARE SPLIT BY MATERIAL VARIANT & SELECT THEIR HIT GROUP THROUGH THEIR INSTANCES. WITHOUT IT (AND FOR DYNAMIC OR
+    // DEVICE GENERATED SCENES) A SINGLE HIT GROUP BRANCHES ON THE MATERIAL OF EVERY HIT
+    bool materialHitGroups = true;
 };
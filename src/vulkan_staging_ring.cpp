@@ -0,0 +1,165 @@
+#include "vulkan_staging_ring.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// STAGED WRITES START AT THE LARGEST POWER OF TWO UP TO THIS THAT DIVIDES THEIR SIZE, SO STRUCTS ARE ALIGNED IN THE RING
+// & WRITES OF ONE ELEMENT SIZE STAY CONTIGUOUS
+const vk::DeviceSize MAX_STAGING_ALIGNMENT = 16;
+
+VulkanStagingRing::VulkanStagingRing(vk::Device device, vk::Queue queue, vk::CommandPool commandPool,
+                                     VulkanMemoryAllocator &memoryAllocator, vk::DeviceSize capacity) :
+        device(device), queue(queue), commandPool(commandPool), memoryAllocator(memoryAllocator),
+        capacity(capacity) {
+
+    buffer = device.createBuffer(
+            {
+                    .size = capacity,
+                    .usage = vk::BufferUsageFlagBits::eTransferSrc,
+                    .sharingMode = vk::SharingMode::eExclusive
+            });
+
+    allocation = memoryAllocator.allocateBufferMemory(buffer, vk::MemoryPropertyFlagBits::eHostVisible |
+                                                              vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+VulkanStagingRing::~VulkanStagingRing() {
+    flush();
+
+    device.destroyBuffer(buffer);
+    memoryAllocator.free(allocation);
+}
+
+void* VulkanStagingRing::stage(vk::Buffer dstBuffer, vk::DeviceSize dstOffset, vk::DeviceSize size) {
+    if (size > capacity) {
+        throw std::runtime_error("[Error] Staged write of " + std::to_string(size) + " bytes exceeds the " +
+                                 std::to_string(capacity) + " byte staging ring!");
+    }
+
+    const vk::DeviceSize alignment = std::min(size & (~size + 1), MAX_STAGING_ALIGNMENT);
+    vk::DeviceSize offset = (head + alignment - 1) / alignment * alignment;
+
+    // WRAP AROUND: THE STAGED COPIES ARE SUBMITTED BEFORE THE HEAD RETURNS TO THE START
+    if (offset + size > capacity) {
+        submit();
+        head = 0;
+        batchBegin = 0;
+        offset = 0;
+    }
+
+    waitForRange(offset, offset + size);
+    head = offset + size;
+
+    StagedCopy* last = stagedCopies.empty() ? nullptr : &stagedCopies.back();
+    if (last && last->dstBuffer == dstBuffer && last->region.srcOffset + last->region.size == offset &&
+        last->region.dstOffset + last->region.size == dstOffset) {
+        last->region.size += size;
+    } else {
+        stagedCopies.push_back(
+                {
+                        .dstBuffer = dstBuffer,
+                        .region = {.srcOffset = offset, .dstOffset = dstOffset, .size = size}
+                });
+    }
+
+    uploadedBytes += size;
+
+    return static_cast<uint8_t*>(allocation.mappedData) + offset;
+}
+
+void VulkanStagingRing::upload(
+        vk::Buffer dstBuffer, vk::DeviceSize elementSize, size_t elementCount,
+        const std::function<void(void* data, size_t firstElement, size_t chunkElementCount)> &write) {
+
+    const size_t chunkElementCount = std::max<size_t>(capacity / 4 / elementSize, 1);
+
+    for (size_t firstElement = 0; firstElement < elementCount; firstElement += chunkElementCount) {
+        const size_t count = std::min(chunkElementCount, elementCount - firstElement);
+
+        write(stage(dstBuffer, firstElement * elementSize, count * elementSize), firstElement, count);
+        submit();
+    }
+}
+
+void VulkanStagingRing::submit() {
+    // RETIRE FINISHED BATCHES, SO THEIR COMMAND BUFFERS & FENCES DO NOT PILE UP
+    while (!inFlightBatches.empty() && device.getFenceStatus(inFlightBatches.front().fence) == vk::Result::eSuccess) {
+        retire(inFlightBatches.front());
+        inFlightBatches.pop_front();
+    }
+
+    if (stagedCopies.empty()) {
+        return;
+    }
+
+    vk::CommandBuffer commandBuffer = device.allocateCommandBuffers(
+            {
+                    .commandPool = commandPool,
+                    .level = vk::CommandBufferLevel::ePrimary,
+                    .commandBufferCount = 1
+            }).front();
+
+    commandBuffer.begin({.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+    for (const StagedCopy &stagedCopy: stagedCopies) {
+        commandBuffer.copyBuffer(buffer, stagedCopy.dstBuffer, 1, &stagedCopy.region);
+    }
+
+    // LATER SUBMITS ON THE QUEUE BUILD FROM, SHADE WITH OR OVERWRITE THE UPLOADED DATA
+    vk::MemoryBarrier memoryBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eAccelerationStructureReadKHR |
+                             vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR |
+                                  vk::PipelineStageFlagBits::eRayTracingShaderKHR |
+                                  vk::PipelineStageFlagBits::eComputeShader |
+                                  vk::PipelineStageFlagBits::eTransfer,
+                                  {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    commandBuffer.end();
+
+    vk::Fence fence = device.createFence({});
+
+    vk::SubmitInfo submitInfo = {
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer
+    };
+
+    queue.submit(1, &submitInfo, fence);
+
+    inFlightBatches.push_back({.fence = fence, .commandBuffer = commandBuffer, .begin = batchBegin, .end = head});
+    stagedCopies.clear();
+    batchBegin = head;
+}
+
+void VulkanStagingRing::flush() {
+    submit();
+
+    for (const InFlightBatch &batch: inFlightBatches) {
+        device.waitForFences(1, &batch.fence, true, UINT64_MAX);
+        retire(batch);
+    }
+
+    inFlightBatches.clear();
+}
+
+uint64_t VulkanStagingRing::getUploadedBytes() const {
+    return uploadedBytes;
+}
+
+// BATCHES ARE SUBMITTED IN RING ORDER, SO THE OLDEST ONE IS THE FIRST THE HEAD CAN RUN INTO
+void VulkanStagingRing::waitForRange(vk::DeviceSize begin, vk::DeviceSize end) {
+    while (!inFlightBatches.empty() && inFlightBatches.front().begin < end && begin < inFlightBatches.front().end) {
+        device.waitForFences(1, &inFlightBatches.front().fence, true, UINT64_MAX);
+        retire(inFlightBatches.front());
+        inFlightBatches.pop_front();
+    }
+}
+
+void VulkanStagingRing::retire(const InFlightBatch &batch) {
+    device.destroyFence(batch.fence);
+    device.freeCommandBuffers(commandPool, batch.commandBuffer);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "vulkan_memory_allocator.h"
+
+// HOST VISIBLE RING BUFFER THAT UPLOADS INTO DEVICE LOCAL BUFFERS. WRITES ARE STAGED AT THE HEAD OF THE RING & COPIED
+// BY ONE SUBMIT PER BATCH, WHICH ENDS WITH A BARRIER FOR EVERY LATER READER ON THE QUEUE (ACCELERATION STRUCTURE
+// BUILDS, SHADERS & COPIES). THE HOST ONLY WAITS WHEN THE HEAD REACHES A RANGE WHOSE COPY HAS NOT FINISHED YET
+class VulkanStagingRing {
+public:
+    VulkanStagingRing(vk::Device device, vk::Queue queue, vk::CommandPool commandPool,
+                      VulkanMemoryAllocator &memoryAllocator, vk::DeviceSize capacity);
+
+    ~VulkanStagingRing();
+
+    VulkanStagingRing(const VulkanStagingRing &) = delete;
+
+    VulkanStagingRing &operator=(const VulkanStagingRing &) = delete;
+
+    // RESERVES size BYTES, COPIED TO dstOffset OF dstBuffer BY THE NEXT SUBMIT. RETURNS WHERE THE HOST WRITES THEM.
+    // CONSECUTIVE WRITES TO CONSECUTIVE DESTINATIONS SHARE ONE COPY REGION
+    [[nodiscard]] void* stage(vk::Buffer dstBuffer, vk::DeviceSize dstOffset, vk::DeviceSize size);
+
+    // UPLOADS elementCount ELEMENTS IN CHUNKS OF A QUARTER RING, SO THE HOST WRITES ONE CHUNK WHILE THE DEVICE COPIES
+    // THE PREVIOUS ONE. write(data, firstElement, chunkElementCount) FILLS A CHUNK
+    void upload(vk::Buffer dstBuffer, vk::DeviceSize elementSize, size_t elementCount,
+                const std::function<void(void* data, size_t firstElement, size_t chunkElementCount)> &write);
+
+    // SUBMITS THE STAGED COPIES WITHOUT WAITING
+    void submit();
+
+    // SUBMITS THE STAGED COPIES & WAITS FOR ALL OF THEM
+    void flush();
+
+    [[nodiscard]] uint64_t getUploadedBytes() const;
+
+private:
+    struct StagedCopy {
+        vk::Buffer dstBuffer;
+        vk::BufferCopy region;
+    };
+
+    // A SUBMITTED BATCH & THE RING RANGE IT STILL READS
+    struct InFlightBatch {
+        vk::Fence fence;
+        vk::CommandBuffer commandBuffer;
+        vk::DeviceSize begin, end;
+    };
+
+    vk::Device device;
+    vk::Queue queue;
+    vk::CommandPool commandPool;
+    VulkanMemoryAllocator &memoryAllocator;
+
+    vk::Buffer buffer;
+    VulkanAllocation allocation;
+    vk::DeviceSize capacity;
+
+    vk::DeviceSize head = 0;
+    vk::DeviceSize batchBegin = 0;
+    std::vector<StagedCopy> stagedCopies;
+    std::deque<InFlightBatch> inFlightBatches;
+    uint64_t uploadedBytes = 0;
+
+    void waitForRange(vk::DeviceSize begin, vk::DeviceSize end);
+
+    void retire(const InFlightBatch &batch);
+};
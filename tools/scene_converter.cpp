@@ -0,0 +1,47 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "scene_file.h"
+
+// CONVERTS BETWEEN TEXT & BINARY (.rtscene) SCENES, THE FORMAT OF EACH PATH IS CHOSEN BY ITS EXTENSION
+int main(int argc, const char** argv) {
+    if (argc != 3 && !(argc == 4 && strcmp(argv[1], "--random") == 0)) {
+        std::cerr << "Usage: SceneConverter <input> <output>" << std::endl
+            << "       SceneConverter --random <sphere amount> <output>" << std::endl;
+        return 1;
+    }
+
+    try {
+        const auto beginTime = std::chrono::steady_clock::now();
+        Scene scene;
+
+        if (argc == 4) {
+            uint32_t sphereAmount = DEFAULT_SPHERE_AMOUNT;
+            std::from_chars(argv[2], argv[2] + strlen(argv[2]), sphereAmount);
+            scene = generateRandomScene({.sphereAmount = sphereAmount});
+        } else {
+            scene = loadScene(argv[1]);
+        }
+
+        const auto loadTime = std::chrono::steady_clock::now();
+
+        const std::string outputPath = argv[argc - 1];
+        if (isBinaryScenePath(outputPath)) {
+            writeBinaryScene(outputPath, scene);
+        } else {
+            writeTextScene(outputPath, scene);
+        }
+
+        const auto writeTime = std::chrono::steady_clock::now();
+
+        std::cout << "Converted " << scene.spheres.size() << " spheres to " << outputPath << " (load "
+            << std::chrono::duration<double, std::milli>(loadTime - beginTime).count() << " ms, write "
+            << std::chrono::duration<double, std::milli>(writeTime - loadTime).count() << " ms)" << std::endl;
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+}